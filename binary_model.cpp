@@ -0,0 +1,388 @@
+// binary_model.cpp
+#include "binary_model.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(RC_CSP_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace
+{
+	const char MAGIC[4] = { 'R', 'C', 'B', 'M' };
+	const char VERSION = 1;
+	const char FLAG_ZSTD = 1;
+
+	// Payloads are flushed once they grow past this size.
+	const std::size_t BLOCK_SIZE = 1 << 20;
+	const int ZSTD_LEVEL = 3;
+
+	void append_varint(std::string& out, index_t x)
+	{
+		assert(x >= 0);
+
+		std::uint64_t y = x;
+		while (y >= 0x80)
+		{
+			out.push_back(static_cast<char>((y & 0x7f) | 0x80));
+			y >>= 7;
+		}
+
+		out.push_back(static_cast<char>(y));
+	}
+
+	index_t read_stream_varint(std::istream& is)
+	{
+		std::uint64_t x = 0;
+		int shift = 0;
+
+		for (;;)
+		{
+			const int ch = is.get();
+
+			if (ch == std::char_traits<char>::eof() || shift > 63)
+				throw std::runtime_error("Truncated binary model");
+
+			x |= static_cast<std::uint64_t>(ch & 0x7f) << shift;
+			shift += 7;
+
+			if ((ch & 0x80) == 0)
+				break;
+		}
+
+		return static_cast<index_t>(x);
+	}
+}
+
+void binary_model_writer::put_varint(index_t x)
+{
+	append_varint(block_, x);
+}
+
+void binary_model_writer::flush_block()
+{
+	if (block_.empty())
+		return;
+
+	auto& os = get_output_stream();
+	std::string header;
+	append_varint(header, block_.size());
+
+#if defined(RC_CSP_WITH_ZSTD)
+	if (compress_)
+	{
+		std::string packed(ZSTD_compressBound(block_.size()), '\0');
+		const std::size_t size = ZSTD_compress(&packed[0], packed.size(), block_.data(), block_.size(), ZSTD_LEVEL);
+
+		if (ZSTD_isError(size))
+			throw std::runtime_error(ZSTD_getErrorName(size));
+
+		append_varint(header, size);
+		os.write(header.data(), header.size());
+		os.write(packed.data(), size);
+		block_.clear();
+		return;
+	}
+#endif
+
+	append_varint(header, block_.size());
+	os.write(header.data(), header.size());
+	os.write(block_.data(), block_.size());
+	block_.clear();
+}
+
+void binary_model_writer::write_vertex_pair(index_t u, index_t v, const std::vector<edge_path>& paths)
+{
+	put_varint(u);
+	put_varint(v);
+	put_varint(paths.size());
+
+	for (const auto& p : paths)
+	{
+		auto ids = edges_.to_ids(p);
+		std::sort(ids.begin(), ids.end());
+
+		put_varint(ids.size());
+
+		index_t prev = 0;
+		for (auto e : ids)
+		{
+			put_varint(e - prev);
+			prev = e;
+		}
+	}
+
+	if (block_.size() >= BLOCK_SIZE)
+		flush_block();
+}
+
+void binary_model_writer::impl_preprocess()
+{
+	auto& os = get_output_stream();
+	const graph& g = get_graph();
+
+	// Pairs left out would be missing from the file, and replaying it would
+	// turn them into pairs without paths.
+	if (has_forced_distinct() || has_kernel())
+		throw std::runtime_error("Binary models store every vertex pair; forced distinctness and the kernel are not supported");
+
+#if defined(RC_CSP_WITH_ZSTD)
+	const char flags = compress_ ? FLAG_ZSTD : 0;
+#else
+	const char flags = 0;
+#endif
+
+	os.write(MAGIC, sizeof(MAGIC));
+	os.put(VERSION);
+	os.put(flags);
+
+	put_varint(g.num_vertices());
+	put_varint(get_solution_size());
+	put_varint(shortest_ ? 1 : 0);
+
+	put_varint(edges_.size());
+	for (index_t e = 0; e < edges_.size(); ++e)
+	{
+		auto ends = edges_.endpoints(e);
+		put_varint(ends.first);
+		put_varint(ends.second);
+	}
+
+	const auto bridges = get_bridge_ids();
+	put_varint(bridges.size());
+	for (auto e : bridges)
+	{
+		put_varint(e);
+	}
+}
+
+void binary_model_writer::impl_postprocess()
+{
+	flush_block();
+
+	// End of file: an empty block.
+	get_output_stream().put(0);
+}
+
+void binary_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_paths(u, v, paths, get_solution_size());
+
+	write_vertex_pair(u, v, paths);
+}
+
+void binary_model_writer::impl_add_comment(const std::string&)
+{
+
+}
+
+void strong_binary_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_shortest_paths(u, v, paths);
+
+	write_vertex_pair(u, v, paths);
+}
+
+binary_model_reader::binary_model_reader(std::istream& is)
+	: is_(is), compressed_(false), done_(false), block_(), pos_(0), header_()
+{
+	char magic[sizeof(MAGIC)];
+	is_.read(magic, sizeof(magic));
+
+	if (!is_ || !std::equal(magic, magic + sizeof(magic), MAGIC))
+		throw std::runtime_error("Not a binary model");
+
+	const int version = is_.get();
+	const int flags = is_.get();
+
+	if (version != VERSION || flags == std::char_traits<char>::eof())
+		throw std::runtime_error("Unsupported binary model version");
+
+	compressed_ = (flags & FLAG_ZSTD) != 0;
+
+#if !defined(RC_CSP_WITH_ZSTD)
+	if (compressed_)
+		throw std::runtime_error("Binary model is compressed, but zstd support is not compiled in");
+#endif
+
+	header_.n = get_varint();
+	header_.k = get_varint();
+	header_.shortest = (get_varint() != 0);
+
+	const index_t m = get_varint();
+	header_.edges.reserve(2 * m);
+	for (index_t e = 0; e < 2 * m; ++e)
+	{
+		header_.edges.emplace_back(get_varint());
+	}
+
+	const index_t bridges = get_varint();
+	for (index_t i = 0; i < bridges; ++i)
+	{
+		header_.bridges.emplace_back(get_varint());
+	}
+}
+
+bool binary_model_reader::refill()
+{
+	if (done_)
+		return false;
+
+	const index_t raw_size = read_stream_varint(is_);
+
+	if (raw_size == 0)
+	{
+		done_ = true;
+		return false;
+	}
+
+	const index_t stored_size = read_stream_varint(is_);
+	std::string stored(stored_size, '\0');
+	is_.read(&stored[0], stored_size);
+
+	if (is_.gcount() != stored_size)
+		throw std::runtime_error("Truncated binary model");
+
+#if defined(RC_CSP_WITH_ZSTD)
+	if (compressed_)
+	{
+		block_.assign(raw_size, '\0');
+		const std::size_t size = ZSTD_decompress(&block_[0], block_.size(), stored.data(), stored.size());
+
+		if (ZSTD_isError(size) || size != raw_size)
+			throw std::runtime_error("Corrupt compressed block in binary model");
+
+		pos_ = 0;
+		return true;
+	}
+#endif
+
+	block_.swap(stored);
+	pos_ = 0;
+	return true;
+}
+
+index_t binary_model_reader::get_varint()
+{
+	std::uint64_t x = 0;
+	int shift = 0;
+
+	for (;;)
+	{
+		if (pos_ == block_.size() && !refill())
+			throw std::runtime_error("Truncated binary model");
+
+		const unsigned char ch = block_[pos_++];
+		x |= static_cast<std::uint64_t>(ch & 0x7f) << shift;
+		shift += 7;
+
+		if ((ch & 0x80) == 0)
+			break;
+	}
+
+	return static_cast<index_t>(x);
+}
+
+bool binary_model_reader::next_pair(binary_pair_record& record)
+{
+	if (pos_ == block_.size() && !refill())
+		return false;
+
+	record.u = get_varint();
+	record.v = get_varint();
+
+	const index_t count = get_varint();
+	record.paths.resize(count);
+
+	for (auto& p : record.paths)
+	{
+		const index_t len = get_varint();
+		p.resize(len);
+
+		index_t prev = 0;
+		for (auto& e : p)
+		{
+			e = prev + get_varint();
+			prev = e;
+		}
+	}
+
+	return true;
+}
+
+graph build_graph(const binary_model_header& header)
+{
+	graph g(header.n);
+
+	for (std::size_t i = 0; i < header.edges.size(); i += 2)
+	{
+		g.add_edge(header.edges[i], header.edges[i + 1]);
+	}
+
+	return g;
+}
+
+bool binary_path_source::seek_pair(index_t s, index_t t)
+{
+	for (;;)
+	{
+		if (!pending_)
+		{
+			if (!reader_.next_pair(record_))
+				return false;
+
+			pending_ = true;
+		}
+
+		// Stored in increasing pair order, so a later pair means s-t was never written.
+		if (std::make_pair(record_.u, record_.v) > std::make_pair(s, t))
+			return false;
+
+		pending_ = false;
+
+		if (record_.u == s && record_.v == t)
+			return true;
+	}
+}
+
+void binary_path_source::get_paths(const graph&, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	const binary_model_header& header = reader_.header();
+
+	// Paths longer than the stored bound are missing unless the bound already
+	// admits every simple path.
+	if (header.shortest)
+		throw std::runtime_error("Binary model holds geodesics only, not paths of bounded length");
+
+	if (length > header.k && header.k < header.n - 1)
+		throw std::runtime_error("Binary model holds paths of at most " + std::to_string(header.k) + " edges, not " + std::to_string(length));
+
+	if (!seek_pair(s, t))
+		return;
+
+	for (const auto& ids : record_.paths)
+	{
+		if (static_cast<index_t>(ids.size()) <= length)
+			paths.emplace_back(to_edge_path(edges_, s, ids));
+	}
+}
+
+void binary_path_source::get_shortest_paths(const graph&, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	if (!reader_.header().shortest)
+		throw std::runtime_error("Binary model holds paths of bounded length, not geodesics");
+
+	if (!seek_pair(s, t))
+		return;
+
+	for (const auto& ids : record_.paths)
+	{
+		paths.emplace_back(to_edge_path(edges_, s, ids));
+	}
+}
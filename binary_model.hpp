@@ -0,0 +1,154 @@
+// binary_model.hpp
+#ifndef BINARY_MODEL_HPP
+#define BINARY_MODEL_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include "model_writer.hpp"
+#include "edge_index.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+// A compact binary model: the path sets of all vertex pairs, stored once and
+// replayed into any text dialect (or read directly) as often as needed.
+//
+// Layout: "RCBM", a version byte and a flags byte, followed by a sequence of
+// blocks. A block is its raw size and stored size (both varints) and the
+// payload, zstd-compressed if the flag is set. A raw size of 0 ends the file.
+// The concatenated payloads hold, as unsigned LEB128 varints:
+//
+//   n k shortest m (u v)*m #bridges bridge-ids
+//   then per vertex pair: u v #paths (length id0 id1-id0 id2-id1 ...)*#paths
+//
+// Edge ids follow graph::edges_; the ids of a path are sorted and delta-coded.
+//
+// Streams must be opened in binary mode. Compression needs RC_CSP_WITH_ZSTD;
+// without it the writer silently stores blocks uncompressed.
+
+struct binary_model_header
+{
+	index_t n;
+	index_t k;
+	bool shortest;
+
+	// Endpoint list: edge e is (edges[2e], edges[2e+1]).
+	std::vector<index_t> edges;
+
+	// Edge ids of the bridges.
+	std::vector<index_t> bridges;
+};
+
+struct binary_pair_record
+{
+	index_t u;
+	index_t v;
+
+	// Sorted edge ids of every path.
+	std::vector<std::vector<index_t>> paths;
+};
+
+// Stores the paths of every vertex pair, so set_forced_distinct and set_kernel,
+// which leave pairs out, make write() throw std::runtime_error.
+class binary_model_writer : public model_writer
+{
+public:
+	binary_model_writer(const graph& g, index_t k, std::ostream& os, bool compress = false)
+		: model_writer(g, k, os, ""), edges_(g), compress_(compress), shortest_(false)
+	{
+
+	}
+
+	virtual ~binary_model_writer() { }
+
+protected:
+	void write_vertex_pair(index_t u, index_t v, const std::vector<edge_path>& paths);
+
+	void set_shortest(bool shortest) { shortest_ = shortest; }
+
+private:
+	virtual void impl_preprocess();
+	virtual void impl_postprocess();
+
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual void impl_add_comment(const std::string& text);
+
+	void put_varint(index_t x);
+	void flush_block();
+
+	edge_index edges_;
+	bool compress_;
+	bool shortest_;
+	std::string block_;
+};
+
+class strong_binary_model_writer : public binary_model_writer
+{
+public:
+	strong_binary_model_writer(const graph& g, index_t k, std::ostream& os, bool compress = false)
+		: binary_model_writer(g, k, os, compress)
+	{
+		set_shortest(true);
+	}
+
+private:
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+};
+
+// Reads a binary model one vertex pair at a time.
+class binary_model_reader
+{
+public:
+	explicit binary_model_reader(std::istream& is);
+
+	const binary_model_header& header() const { return header_; }
+
+	// Returns false once all vertex pairs have been read.
+	bool next_pair(binary_pair_record& record);
+
+private:
+	index_t get_varint();
+	bool refill();
+
+	std::istream& is_;
+	bool compressed_;
+	bool done_;
+	std::string block_;
+	std::size_t pos_;
+	binary_model_header header_;
+};
+
+graph build_graph(const binary_model_header& header);
+
+// Feeds the stored paths to a model_writer (see model_writer::set_path_source),
+// which converts a binary model to any of the text dialects. The writer must
+// visit vertex pairs in increasing order, as model_writer::impl_process does,
+// and ask for what was stored: geodesics from a strong model, and paths of at
+// most k edges otherwise (any length once k is n - 1 or more, which the
+// Minion writers need). Other queries throw std::runtime_error.
+class binary_path_source : public path_source
+{
+public:
+	binary_path_source(binary_model_reader& reader, const graph& g)
+		: reader_(reader), edges_(g), pending_(false)
+	{
+
+	}
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+
+private:
+	bool seek_pair(index_t s, index_t t);
+
+	binary_model_reader& reader_;
+	edge_index edges_;
+	binary_pair_record record_;
+	bool pending_;
+};
+
+#endif
@@ -0,0 +1,301 @@
+// block_cut_tree.cpp
+#include "block_cut_tree.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <queue>
+
+namespace
+{
+	struct tarjan_state
+	{
+		tarjan_state(const graph& g)
+			: g(g), disc(g.num_vertices(), -1), low(g.num_vertices(), 0), time(0)
+		{
+
+		}
+
+		const graph& g;
+		std::vector<index_t> disc;
+		std::vector<index_t> low;
+		std::vector<index_t> stack;
+		index_t time;
+	};
+
+	void visit(tarjan_state& s, block_cut_tree& t, index_t u, index_t parent)
+	{
+		s.disc[u] = s.low[u] = s.time++;
+		s.stack.emplace_back(u);
+		index_t children = 0;
+
+		for (std::uint64_t adj = s.g.adj_[u]; adj != 0; adj &= adj - 1)
+		{
+			const index_t v = ctz64(adj);
+
+			if (s.disc[v] == -1)
+			{
+				++children;
+				visit(s, t, v, u);
+				s.low[u] = std::min(s.low[u], s.low[v]);
+
+				// u separates the subtree of v: pop it off as a block with u.
+				if (s.low[v] >= s.disc[u])
+				{
+					if (parent != -1 || children > 1)
+						t.cut_vertices |= (1ULL << u);
+
+					std::uint64_t block = (1ULL << u);
+					index_t w;
+					do
+					{
+						w = s.stack.back();
+						s.stack.pop_back();
+						block |= (1ULL << w);
+					} while (w != v);
+
+					t.blocks.emplace_back(block);
+				}
+			}
+			else if (v != parent)
+			{
+				s.low[u] = std::min(s.low[u], s.disc[v]);
+			}
+		}
+	}
+
+	graph induced_subgraph(const graph& g, std::uint64_t mask)
+	{
+		graph h(g.num_vertices());
+
+		for (index_t i = 0; i < g.edges_.size(); i += 2)
+		{
+			const index_t u = g.edges_[i];
+			const index_t v = g.edges_[i + 1];
+
+			if (bittest64(mask, u) && bittest64(mask, v))
+				h.add_edge(u, v);
+		}
+
+		return h;
+	}
+}
+
+block_cut_tree get_block_cut_tree(const graph& g)
+{
+	const index_t n = g.num_vertices();
+
+	block_cut_tree t;
+	t.cut_vertices = 0;
+
+	tarjan_state s(g);
+
+	for (index_t v = 0; v < n; ++v)
+	{
+		if (s.disc[v] == -1)
+		{
+			visit(s, t, v, -1);
+
+			// An isolated vertex is a block of its own.
+			if (g.adj_[v] == 0)
+				t.blocks.emplace_back(1ULL << v);
+
+			s.stack.clear();
+		}
+	}
+
+	t.vertex_blocks.assign(n, 0);
+	for (index_t b = 0; b < t.blocks.size(); ++b)
+	{
+		for (std::uint64_t mask = t.blocks[b]; mask != 0; mask &= mask - 1)
+		{
+			t.vertex_blocks[ctz64(mask)] |= (1ULL << b);
+		}
+	}
+
+	return t;
+}
+
+std::vector<block_segment> get_block_chain(const block_cut_tree& tree, index_t s, index_t t)
+{
+	const index_t blocks = tree.blocks.size();
+	const index_t NONE = -1;
+
+	// Breadth-first search over blocks, moving between blocks at cut vertices.
+	std::vector<index_t> pred(blocks, NONE);
+	std::vector<index_t> via(blocks, NONE);
+	std::vector<bool> seen(blocks, false);
+	std::queue<index_t> q;
+
+	for (std::uint64_t mask = tree.vertex_blocks[s]; mask != 0; mask &= mask - 1)
+	{
+		seen[ctz64(mask)] = true;
+		q.push(ctz64(mask));
+	}
+
+	index_t last = NONE;
+	while (!q.empty())
+	{
+		const index_t b = q.front();
+		q.pop();
+
+		if (bittest64(tree.blocks[b], t))
+		{
+			last = b;
+			break;
+		}
+
+		for (std::uint64_t cuts = tree.blocks[b] & tree.cut_vertices; cuts != 0; cuts &= cuts - 1)
+		{
+			const index_t c = ctz64(cuts);
+
+			for (std::uint64_t mask = tree.vertex_blocks[c]; mask != 0; mask &= mask - 1)
+			{
+				const index_t next = ctz64(mask);
+
+				if (!seen[next])
+				{
+					seen[next] = true;
+					pred[next] = b;
+					via[next] = c;
+					q.push(next);
+				}
+			}
+		}
+	}
+
+	std::vector<block_segment> chain;
+	if (last == NONE)
+		return chain;
+
+	index_t to = t;
+	for (index_t b = last; b != NONE; b = pred[b])
+	{
+		const index_t from = (pred[b] == NONE) ? s : via[b];
+		chain.emplace_back(block_segment{ b, from, to });
+		to = from;
+	}
+
+	std::reverse(chain.begin(), chain.end());
+	return chain;
+}
+
+block_path_source::block_path_source(const graph& g)
+	: tree_(get_block_cut_tree(g)), subgraphs_(), segments_()
+{
+	for (auto mask : tree_.blocks)
+	{
+		subgraphs_.emplace_back(new graph(induced_subgraph(g, mask)));
+	}
+}
+
+const block_path_source::segment_list& block_path_source::get_segments(const block_segment& seg, bool shortest, index_t length)
+{
+	const key_type key(seg.block, seg.from, seg.to, shortest, shortest ? 0 : length);
+	auto it = segments_.find(key);
+
+	if (it != segments_.end())
+		return it->second;
+
+	std::vector<edge_path> paths;
+	const graph& h = *subgraphs_[seg.block];
+
+	if (shortest)
+		list_shortest_paths(h, seg.from, seg.to, paths);
+	else
+		list_paths(h, seg.from, seg.to, paths, length);
+
+	segment_list list;
+	list.reserve(paths.size());
+
+	for (const auto& p : paths)
+		list.emplace_back(p.cbegin(), p.cend());
+
+	return segments_.emplace(key, std::move(list)).first->second;
+}
+
+void block_path_source::compose(const std::vector<block_segment>& chain, bool shortest, index_t length, std::vector<edge_path>& paths)
+{
+	const index_t r = chain.size();
+	std::vector<const segment_list*> lists(r);
+
+	if (r == 0)
+		return;
+
+	// Shortest possible length of the remaining segments, for pruning.
+	std::vector<index_t> remaining(r + 1, 0);
+
+	for (index_t i = r - 1; i >= 0; --i)
+	{
+		lists[i] = &get_segments(chain[i], shortest, length);
+
+		if (lists[i]->empty())
+			return;
+
+		index_t shortest_segment = std::numeric_limits<index_t>::max();
+		for (const auto& seg : *lists[i])
+			shortest_segment = std::min<index_t>(shortest_segment, seg.size() - 1);
+
+		remaining[i] = remaining[i + 1] + shortest_segment;
+	}
+
+	if (remaining[0] > length)
+		return;
+
+	// Odometer over one segment per block.
+	std::vector<index_t> choice(r, 0);
+	std::vector<index_t> prefix(r + 1, 0);
+	index_t i = 0;
+
+	while (i >= 0)
+	{
+		if (choice[i] == lists[i]->size())
+		{
+			choice[i] = 0;
+			--i;
+
+			if (i >= 0)
+				++choice[i];
+
+			continue;
+		}
+
+		prefix[i + 1] = prefix[i] + (*lists[i])[choice[i]].size() - 1;
+
+		if (prefix[i + 1] + remaining[i + 1] > length)
+		{
+			++choice[i];
+			continue;
+		}
+
+		if (i + 1 < r)
+		{
+			++i;
+			continue;
+		}
+
+		edge_path p;
+		p.discover_vertex(chain[0].from);
+
+		for (index_t j = 0; j < r; ++j)
+		{
+			const auto& seg = (*lists[j])[choice[j]];
+
+			for (auto w = seg.cbegin() + 1; w != seg.cend(); ++w)
+				p.discover_vertex(*w);
+		}
+
+		paths.emplace_back(p);
+		++choice[i];
+	}
+}
+
+void block_path_source::get_paths(const graph&, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	compose(get_block_chain(tree_, s, t), false, length, paths);
+}
+
+void block_path_source::get_shortest_paths(const graph&, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	compose(get_block_chain(tree_, s, t), true, std::numeric_limits<index_t>::max(), paths);
+}
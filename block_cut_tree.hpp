@@ -0,0 +1,71 @@
+// block_cut_tree.hpp
+#ifndef BLOCK_CUT_TREE_HPP
+#define BLOCK_CUT_TREE_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// The biconnected components (blocks) and cut vertices of a graph.
+struct block_cut_tree
+{
+	// Vertex mask of every block.
+	std::vector<std::uint64_t> blocks;
+
+	// Mask of the cut vertices.
+	std::uint64_t cut_vertices;
+
+	// For every vertex, the mask of blocks containing it.
+	std::vector<std::uint64_t> vertex_blocks;
+};
+
+block_cut_tree get_block_cut_tree(const graph& g);
+
+// A step of an s-t walk through the block-cut tree: enter the block at
+// 'from' and leave it at 'to'.
+struct block_segment
+{
+	index_t block;
+	index_t from;
+	index_t to;
+};
+
+// Blocks an s-t path passes through, in order. Every s-t path is a
+// concatenation of one from-to path inside each of them.
+std::vector<block_segment> get_block_chain(const block_cut_tree& tree, index_t s, index_t t);
+
+// Enumerates paths inside single blocks only, between cut vertices and
+// block-local endpoints, and composes the s-t paths from these segments.
+// Segments are memoised, so a block shared by many vertex pairs is
+// enumerated once per pair of endpoints in it.
+class block_path_source : public path_source
+{
+public:
+	explicit block_path_source(const graph& g);
+
+	const block_cut_tree& get_tree() const { return tree_; }
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+
+private:
+	typedef std::vector<std::vector<index_t>> segment_list;
+	typedef std::tuple<index_t, index_t, index_t, bool, index_t> key_type;
+
+	const segment_list& get_segments(const block_segment& seg, bool shortest, index_t length);
+
+	void compose(const std::vector<block_segment>& chain, bool shortest, index_t length, std::vector<edge_path>& paths);
+
+	block_cut_tree tree_;
+	std::vector<std::unique_ptr<graph>> subgraphs_;
+	std::map<key_type, segment_list> segments_;
+};
+
+#endif
@@ -0,0 +1,305 @@
+// canonical.cpp
+#include "canonical.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <numeric>
+
+namespace
+{
+	// An ordered partition of the vertices; each cell is a vertex mask.
+	typedef std::vector<std::uint64_t> partition;
+
+	const index_t NO_JUMP = 65;
+
+	struct search_state
+	{
+		search_state(const graph& g) : g(g), n(g.num_vertices()), have_first(false) { }
+
+		const graph& g;
+		const index_t n;
+
+		bool have_first;
+		std::vector<index_t> first_path;
+		std::vector<index_t> first_labels;
+		std::vector<index_t> first_form;
+
+		std::vector<index_t> best_path;
+		std::vector<index_t> best_labels;
+		std::vector<index_t> best_form;
+
+		std::vector<std::vector<index_t>> generators;
+	};
+
+	// Splits cells by the number of neighbours in each other cell until the
+	// partition is equitable. New cells are ordered by that count, so the
+	// result does not depend on the vertex labels.
+	void refine(const graph& g, partition& p)
+	{
+		bool changed = true;
+
+		while (changed)
+		{
+			changed = false;
+
+			for (std::size_t s = 0; s < p.size() && !changed; ++s)
+			{
+				const std::uint64_t splitter = p[s];
+
+				for (std::size_t c = 0; c < p.size(); ++c)
+				{
+					if (popcount64(p[c]) == 1)
+						continue;
+
+					std::map<int, std::uint64_t> groups;
+					for (std::uint64_t cell = p[c]; cell != 0; cell &= cell - 1)
+					{
+						const int v = ctz64(cell);
+						groups[popcount64(g.adj_[v] & splitter)] |= (1ULL << v);
+					}
+
+					if (groups.size() > 1)
+					{
+						partition split;
+						for (const auto& group : groups)
+							split.emplace_back(group.second);
+
+						p.erase(p.begin() + c);
+						p.insert(p.begin() + c, split.begin(), split.end());
+						changed = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<index_t> to_labels(const partition& p)
+	{
+		std::vector<index_t> labels(p.size());
+
+		for (std::size_t i = 0; i < p.size(); ++i)
+		{
+			labels[ctz64(p[i])] = i;
+		}
+
+		return labels;
+	}
+
+	std::vector<index_t> to_form(const graph& g, const std::vector<index_t>& labels)
+	{
+		const index_t n = g.num_vertices();
+		std::vector<index_t> form(n, 0);
+
+		for (index_t v = 0; v < n; ++v)
+		{
+			std::uint64_t relabelled = 0;
+			for (std::uint64_t adj = g.adj_[v]; adj != 0; adj &= adj - 1)
+			{
+				relabelled |= (1ULL << labels[ctz64(adj)]);
+			}
+
+			form[labels[v]] = relabelled;
+		}
+
+		return form;
+	}
+
+	bool form_less(const std::vector<index_t>& a, const std::vector<index_t>& b)
+	{
+		// Compare as unsigned words, so bit 63 is not a sign bit.
+		return std::lexicographical_compare(a.cbegin(), a.cend(), b.cbegin(), b.cend(),
+			[](index_t x, index_t y) { return static_cast<std::uint64_t>(x) < static_cast<std::uint64_t>(y); });
+	}
+
+	index_t common_prefix(const std::vector<index_t>& a, const std::vector<index_t>& b)
+	{
+		return std::mismatch(a.cbegin(), a.cend(), b.cbegin(), b.cend()).first - a.cbegin();
+	}
+
+	// The automorphism mapping the leaf with labels a to the leaf with labels b.
+	std::vector<index_t> to_automorphism(const std::vector<index_t>& a, const std::vector<index_t>& b)
+	{
+		std::vector<index_t> inverse_b(b.size());
+		for (std::size_t v = 0; v < b.size(); ++v)
+			inverse_b[b[v]] = v;
+
+		std::vector<index_t> perm(a.size());
+		for (std::size_t v = 0; v < a.size(); ++v)
+			perm[v] = inverse_b[a[v]];
+
+		return perm;
+	}
+
+	index_t find_root(std::vector<index_t>& parent, index_t v)
+	{
+		while (parent[v] != v)
+		{
+			parent[v] = parent[parent[v]];
+			v = parent[v];
+		}
+
+		return v;
+	}
+
+	// Is v in the orbit of an explored vertex under the known automorphisms
+	// that fix the current path pointwise?
+	bool in_explored_orbit(const search_state& s, const std::vector<index_t>& path, std::uint64_t explored, index_t v)
+	{
+		std::vector<index_t> parent(s.n);
+		std::iota(parent.begin(), parent.end(), 0);
+
+		for (const auto& perm : s.generators)
+		{
+			bool fixes_path = true;
+			for (auto w : path)
+			{
+				if (perm[w] != w)
+				{
+					fixes_path = false;
+					break;
+				}
+			}
+
+			if (!fixes_path)
+				continue;
+
+			for (index_t w = 0; w < s.n; ++w)
+			{
+				parent[find_root(parent, w)] = find_root(parent, perm[w]);
+			}
+		}
+
+		const index_t root = find_root(parent, v);
+		for (std::uint64_t e = explored; e != 0; e &= e - 1)
+		{
+			if (find_root(parent, ctz64(e)) == root)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Returns the level to backtrack to, or NO_JUMP.
+	index_t process_leaf(search_state& s, const partition& p, const std::vector<index_t>& path)
+	{
+		auto labels = to_labels(p);
+		auto form = to_form(s.g, labels);
+
+		if (!s.have_first)
+		{
+			s.have_first = true;
+			s.first_path = s.best_path = path;
+			s.first_labels = s.best_labels = labels;
+			s.first_form = s.best_form = form;
+			return NO_JUMP;
+		}
+
+		// Equal to an earlier leaf: the whole subtree where the paths diverged
+		// is an image of the one already explored.
+		if (form == s.first_form)
+		{
+			s.generators.emplace_back(to_automorphism(s.first_labels, labels));
+			assert(is_automorphism(s.g, s.generators.back()));
+			return common_prefix(path, s.first_path);
+		}
+
+		if (form == s.best_form)
+		{
+			s.generators.emplace_back(to_automorphism(s.best_labels, labels));
+			assert(is_automorphism(s.g, s.generators.back()));
+			return common_prefix(path, s.best_path);
+		}
+
+		if (form_less(s.best_form, form))
+		{
+			s.best_path = path;
+			s.best_labels = labels;
+			s.best_form = form;
+		}
+
+		return NO_JUMP;
+	}
+
+	index_t search(search_state& s, partition p, std::vector<index_t>& path)
+	{
+		refine(s.g, p);
+
+		if (p.size() == s.n)
+			return process_leaf(s, p, path);
+
+		const index_t level = path.size();
+		const std::size_t target = std::find_if(p.cbegin(), p.cend(),
+			[](std::uint64_t cell) { return popcount64(cell) > 1; }) - p.cbegin();
+
+		std::uint64_t explored = 0;
+
+		for (std::uint64_t cell = p[target]; cell != 0; cell &= cell - 1)
+		{
+			const index_t v = ctz64(cell);
+
+			if (explored != 0 && in_explored_orbit(s, path, explored, v))
+				continue;
+
+			// Individualise v: it gets a cell of its own, in front of the rest.
+			partition child = p;
+			child[target] &= ~(1ULL << v);
+			child.insert(child.begin() + target, 1ULL << v);
+
+			path.emplace_back(v);
+			const index_t jump = search(s, child, path);
+			path.pop_back();
+
+			explored |= (1ULL << v);
+
+			if (jump < level)
+				return jump;
+		}
+
+		return NO_JUMP;
+	}
+}
+
+canonical_labelling canonical_label(const graph& g)
+{
+	const index_t n = g.num_vertices();
+	search_state s(g);
+
+	partition p;
+	if (n > 0)
+		p.emplace_back(n == 64 ? ~0ULL : ((1ULL << n) - 1));
+
+	std::vector<index_t> path;
+	search(s, p, path);
+
+	canonical_labelling result;
+	result.labels = s.best_labels;
+	result.form = s.best_form;
+	result.generators = s.generators;
+	return result;
+}
+
+graph relabel(const graph& g, const std::vector<index_t>& labels)
+{
+	graph h(g.num_vertices());
+
+	for (index_t i = 0; i < g.edges_.size(); i += 2)
+	{
+		h.add_edge(labels[g.edges_[i]], labels[g.edges_[i + 1]]);
+	}
+
+	return h;
+}
+
+bool is_automorphism(const graph& g, const std::vector<index_t>& perm)
+{
+	for (index_t i = 0; i < g.edges_.size(); i += 2)
+	{
+		if (!is_adjacent(g, perm[g.edges_[i]], perm[g.edges_[i + 1]]))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,30 @@
+// canonical.hpp
+#ifndef CANONICAL_HPP
+#define CANONICAL_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include <vector>
+
+struct canonical_labelling
+{
+	// labels[v] is the canonical label of vertex v.
+	std::vector<index_t> labels;
+
+	// Adjacency words of the relabelled graph; equal iff the graphs are isomorphic.
+	std::vector<index_t> form;
+
+	// Generators of Aut(G), found along the way; perm[v] is the image of v.
+	std::vector<std::vector<index_t>> generators;
+};
+
+// Canonical labelling by partition refinement and individualisation, with
+// orbit pruning on the automorphisms found at the leaves (in the style of
+// nauty, without node invariants).
+canonical_labelling canonical_label(const graph& g);
+
+graph relabel(const graph& g, const std::vector<index_t>& labels);
+
+bool is_automorphism(const graph& g, const std::vector<index_t>& perm);
+
+#endif
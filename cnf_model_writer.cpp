@@ -0,0 +1,187 @@
+// cnf_model_writer.cpp
+#include "cnf_model_writer.hpp"
+
+#include "graph.hpp"
+#include "path.hpp"
+#include <string>
+#include <vector>
+
+void cnf_model_writer::add_clause(const std::vector<index_t>& lits)
+{
+	auto& os = body_.stream();
+
+	for (auto lit : lits)
+		os << lit << " ";
+
+	os << "0\n";
+	++clauses_;
+}
+
+// Edges e and f get distinct colors (if the selector is true).
+void cnf_model_writer::add_distinct(index_t e, index_t f, index_t selector)
+{
+	const index_t k = get_solution_size();
+
+	for (index_t c = 1; c <= k; ++c)
+	{
+		if (selector != 0)
+			add_clause({ -selector, -color_variable(e, c), -color_variable(f, c) });
+		else
+			add_clause({ -color_variable(e, c), -color_variable(f, c) });
+	}
+}
+
+void cnf_model_writer::write_vertex_pair(const std::vector<edge_path>& paths)
+{
+	std::vector<index_t> selectors;
+	selectors.reserve(paths.size());
+
+	for (const auto& p : paths)
+	{
+		const auto ids = edges_.to_ids(p);
+		const index_t s = ++variables_;
+
+		for (index_t i = 0; i < ids.size(); ++i)
+		{
+			for (index_t j = i + 1; j < ids.size(); ++j)
+			{
+				add_distinct(ids[i], ids[j], s);
+			}
+		}
+
+		selectors.emplace_back(s);
+	}
+
+	// Empty if no path fits, which makes the formula UNSAT as it should.
+	add_clause(selectors);
+}
+
+void cnf_model_writer::impl_preprocess()
+{
+	const index_t k = get_solution_size();
+	body_.set_budget(get_memory_budget());
+
+	for (index_t e = 0; e < edges_.size(); ++e)
+	{
+		// At least one color ...
+		std::vector<index_t> lits;
+		for (index_t c = 1; c <= k; ++c)
+			lits.emplace_back(color_variable(e, c));
+
+		add_clause(lits);
+
+		// ... and at most one.
+		for (index_t c = 1; c <= k; ++c)
+		{
+			for (index_t d = c + 1; d <= k; ++d)
+			{
+				add_clause({ -color_variable(e, c), -color_variable(e, d) });
+			}
+		}
+	}
+}
+
+// With s(i,c) true iff colour c is among the first i + 1 edges of the value
+// order, every edge of colour c > 1 needs c - 1 before it.
+void cnf_model_writer::add_value_precedence()
+{
+	const index_t k = get_solution_size();
+	index_t pinned = 0;
+	const auto order = get_value_order(pinned);
+
+	for (index_t i = 0; i < pinned; ++i)
+		add_clause({ color_variable(order[i], i + 1) });
+
+	for (index_t c = 2; c <= k; ++c)
+		add_clause({ -color_variable(order[0], c) });
+
+	// Colour k is never needed before another.
+	const index_t first = variables_ + 1;
+	auto seen = [&](index_t i, index_t c) { return first + i * (k - 1) + c - 1; };
+
+	for (std::size_t i = 0; i + 1 < order.size(); ++i)
+	{
+		for (index_t c = 1; c < k; ++c)
+		{
+			add_clause({ -color_variable(order[i], c), seen(i, c) });
+
+			if (i == 0)
+			{
+				add_clause({ -seen(i, c), color_variable(order[i], c) });
+				continue;
+			}
+
+			add_clause({ -seen(i - 1, c), seen(i, c) });
+			add_clause({ -seen(i, c), seen(i - 1, c), color_variable(order[i], c) });
+		}
+	}
+
+	for (std::size_t i = 1; i < order.size(); ++i)
+	{
+		for (index_t c = 2; c <= k; ++c)
+			add_clause({ -color_variable(order[i], c), seen(i - 1, c - 1) });
+	}
+
+	variables_ += (order.size() - 1) * (k - 1);
+}
+
+void cnf_model_writer::impl_postprocess()
+{
+	// Bridges must get distinct colors; with forced facts they are among the
+	// cliques, which also stand in for the pairs left out.
+	std::vector<std::vector<index_t>> distinct;
+
+	if (get_forced_distinct() != nullptr)
+		distinct = get_forced_distinct()->get_cliques();
+	else
+		distinct.emplace_back(get_bridge_ids());
+
+	for (const auto& ids : distinct)
+	{
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < ids.size(); ++j)
+				add_distinct(ids[i], ids[j]);
+		}
+	}
+
+	if (get_value_symmetry() != value_symmetry::none && edges_.size() != 0)
+		add_value_precedence();
+
+	auto& os = get_output_stream();
+	const index_t k = get_solution_size();
+
+	os << get_comment() << " rainbow connection, k = " << k << "\n";
+	os << get_comment() << " edge e = (u,v) has color c iff variable e*" << k << "+c is true\n";
+
+	for (index_t e = 0; e < edges_.size(); ++e)
+	{
+		auto ends = edges_.endpoints(e);
+		os << get_comment() << " edge " << e << " " << ends.first << " " << ends.second << "\n";
+	}
+
+	os << "p cnf " << variables_ << " " << clauses_ << "\n";
+	body_.copy_to(os);
+}
+
+void cnf_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_paths(u, v, paths, get_solution_size());
+
+	write_vertex_pair(paths);
+}
+
+// Comments are only allowed before the problem line, which is written last.
+void cnf_model_writer::impl_add_comment(const std::string&)
+{
+
+}
+
+void strong_cnf_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_shortest_paths(u, v, paths);
+
+	write_vertex_pair(paths);
+}
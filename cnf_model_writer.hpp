@@ -0,0 +1,78 @@
+// cnf_model_writer.hpp
+#ifndef CNF_MODEL_WRITER_HPP
+#define CNF_MODEL_WRITER_HPP
+
+#include "model_writer.hpp"
+#include "edge_index.hpp"
+#include "path_spool.hpp"
+#include <vector>
+#include <string>
+
+// Writes a SAT encoding of the model in DIMACS CNF.
+//
+// Colors are one-hot encoded: variable e*k + c is true iff edge e has
+// color c (1-based). Every path gets a selector variable that, when true, forbids
+// any two of its edges from sharing a color; every vertex pair needs one of
+// its selectors to be true.
+//
+// DIMACS allows comments only before the problem line, which needs the final
+// counts and is written last, so add_comment text is dropped; the header
+// comments list the edge variables instead.
+class cnf_model_writer : public model_writer
+{
+public:
+	cnf_model_writer(const graph& g, index_t k, std::ostream& os)
+		: model_writer(g, k, os, "c"), edges_(g), variables_(edges_.size() * k), clauses_(0)
+	{
+
+	}
+
+	virtual ~cnf_model_writer() { }
+
+	// The variable that is true iff edge e has color c (1-based).
+	index_t color_variable(index_t e, index_t c) const
+	{
+		return e * get_solution_size() + c;
+	}
+
+protected:
+	// The clauses of one vertex pair; nothing in them names the pair.
+	void write_vertex_pair(const std::vector<edge_path>& paths);
+
+private:
+	virtual void impl_preprocess();
+	virtual void impl_postprocess();
+
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual void impl_add_comment(const std::string& text);
+
+	void add_clause(const std::vector<index_t>& lits);
+	void add_distinct(index_t e, index_t f, index_t selector = 0);
+	void add_value_precedence();
+
+	edge_index edges_;
+	index_t variables_;
+	index_t clauses_;
+
+	// The problem line needs the final counts, so clauses are kept until the
+	// end, in a temporary file under a memory budget.
+	text_spool body_;
+};
+
+class strong_cnf_model_writer : public cnf_model_writer
+{
+public:
+	strong_cnf_model_writer(const graph& g, index_t k, std::ostream& os)
+		: cnf_model_writer(g, k, os)
+	{
+
+	}
+
+private:
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual bool impl_shortest_paths() const { return true; }
+};
+
+#endif
@@ -35,7 +35,7 @@ inline bool bittest64(index_t x, int idx)
 #if defined(_MSC_VER)
 	return _bittest64(&x, idx);
 #elif defined(__GNUC__)
-	return x & (1 << idx);
+	return x & (1ULL << idx);
 #endif
 }
 
@@ -0,0 +1,43 @@
+// disequality.cpp
+#include "disequality.hpp"
+
+index_t disequality_table::get(index_t e, index_t f, bool& is_new)
+{
+	if (e > f)
+		std::swap(e, f);
+
+	const index_t key = e * edges_.size() + f;
+	auto it = ids_.find(key);
+
+	is_new = (it == ids_.end());
+
+	if (!is_new)
+		return it->second;
+
+	const index_t d = size();
+	ids_.emplace(key, d);
+	pairs_.emplace_back(e);
+	pairs_.emplace_back(f);
+
+	return d;
+}
+
+std::vector<index_t> disequality_table::get_path_literals(const edge_path& p, std::vector<index_t>& created)
+{
+	const auto ids = edges_.to_ids(p);
+	std::vector<index_t> literals;
+
+	for (std::size_t i = 0; i < ids.size(); ++i)
+	{
+		for (std::size_t j = i + 1; j < ids.size(); ++j)
+		{
+			bool is_new = false;
+			literals.emplace_back(get(ids[i], ids[j], is_new));
+
+			if (is_new)
+				created.emplace_back(literals.back());
+		}
+	}
+
+	return literals;
+}
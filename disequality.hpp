@@ -0,0 +1,43 @@
+// disequality.hpp
+#ifndef DISEQUALITY_HPP
+#define DISEQUALITY_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "edge_index.hpp"
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// One literal per pair of edges that occur together on some path, meaning "e
+// and f get different colours", numbered in order of first use. A path is
+// rainbow iff all the literals of its edge pairs hold, so writers can share
+// them between all the paths and vertex pairs of a model.
+class disequality_table
+{
+public:
+	explicit disequality_table(const graph& g) : edges_(g) { }
+
+	const edge_index& get_edge_index() const { return edges_; }
+
+	// Number of literals so far.
+	index_t size() const { return pairs_.size() / 2; }
+
+	// Edge ids (smaller first) of literal d.
+	std::pair<index_t, index_t> get_edges(index_t d) const { return std::make_pair(pairs_[2 * d], pairs_[2 * d + 1]); }
+
+	// The literal of (e, f); is_new is set if this call made it.
+	index_t get(index_t e, index_t f, bool& is_new);
+
+	// The literals of every two edges of the path. Those made by this call are
+	// appended to created.
+	std::vector<index_t> get_path_literals(const edge_path& p, std::vector<index_t>& created);
+
+private:
+	edge_index edges_;
+	std::unordered_map<index_t, index_t> ids_;
+	std::vector<index_t> pairs_;
+};
+
+#endif
@@ -0,0 +1,94 @@
+// edge_index.cpp
+#include "edge_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+const index_t edge_index::NO_EDGE;
+
+edge_index::edge_index(const graph& g)
+	: n_(g.num_vertices()), ids_(n_ * n_, NO_EDGE), ends_()
+{
+	const index_t m = g.num_edges();
+	ends_.reserve(2 * m);
+
+	for (index_t e = 0; e < m; ++e)
+	{
+		auto edge = std::minmax(g.edges_[2 * e], g.edges_[2 * e + 1]);
+
+		ids_[edge.first * n_ + edge.second] = e;
+		ids_[edge.second * n_ + edge.first] = e;
+
+		// Endpoints are kept in the same (smaller, larger) order as the variable names.
+		ends_.emplace_back(edge.first);
+		ends_.emplace_back(edge.second);
+	}
+}
+
+std::vector<index_t> edge_index::to_ids(const edge_path& p) const
+{
+	std::vector<index_t> ids;
+
+	for (auto it = p.cbegin(), end = (p.cend() - 1); it != end; ++it)
+	{
+		assert(id(*it, *(it + 1)) != NO_EDGE);
+		ids.emplace_back(id(*it, *(it + 1)));
+	}
+
+	return ids;
+}
+
+std::vector<index_t> edge_index::to_edge_list(const std::vector<index_t>& ids) const
+{
+	std::vector<index_t> edge_list;
+	edge_list.reserve(2 * ids.size());
+
+	for (auto e : ids)
+	{
+		edge_list.emplace_back(ends_[2 * e]);
+		edge_list.emplace_back(ends_[2 * e + 1]);
+	}
+
+	return edge_list;
+}
+
+std::vector<index_t> get_bridge_ids(const graph& g)
+{
+	const edge_index index(g);
+	const auto bridges = get_bridges(g);
+
+	std::vector<index_t> ids;
+
+	for (std::size_t i = 0; i + 1 < bridges.size(); i += 2)
+		ids.emplace_back(index.id(bridges[i], bridges[i + 1]));
+
+	return ids;
+}
+
+edge_path to_edge_path(const edge_index& edges, index_t s, const std::vector<index_t>& ids)
+{
+	edge_path p;
+	p.discover_vertex(s);
+
+	std::vector<bool> used(ids.size(), false);
+	index_t current = s;
+
+	for (index_t step = 0; step < ids.size(); ++step)
+	{
+		for (index_t i = 0; i < ids.size(); ++i)
+		{
+			auto ends = edges.endpoints(ids[i]);
+
+			if (used[i] || (ends.first != current && ends.second != current))
+				continue;
+
+			current = (ends.first == current) ? ends.second : ends.first;
+			p.discover_vertex(current);
+			used[i] = true;
+			break;
+		}
+	}
+
+	assert(p.size() == ids.size());
+	return p;
+}
@@ -0,0 +1,52 @@
+// edge_index.hpp
+#ifndef EDGE_INDEX_HPP
+#define EDGE_INDEX_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include <vector>
+#include <utility>
+
+// Maps the edges of a graph to dense ids 0..m-1, in the order of graph::edges_.
+class edge_index
+{
+public:
+	explicit edge_index(const graph& g);
+
+	static const index_t NO_EDGE = -1;
+
+	index_t id(index_t u, index_t v) const
+	{
+		return ids_[u * n_ + v];
+	}
+
+	std::pair<index_t, index_t> endpoints(index_t e) const
+	{
+		return std::make_pair(ends_[2 * e], ends_[2 * e + 1]);
+	}
+
+	index_t size() const
+	{
+		return ends_.size() / 2;
+	}
+
+	// Edge ids along the path, in path order.
+	std::vector<index_t> to_ids(const edge_path& p) const;
+
+	// Endpoint list (as returned by to_edge_list) for a list of edge ids.
+	std::vector<index_t> to_edge_list(const std::vector<index_t>& ids) const;
+
+private:
+	index_t n_;
+	std::vector<index_t> ids_;
+	std::vector<index_t> ends_;
+};
+
+// Rebuilds the s-t path made up of the given edge ids, in any order.
+edge_path to_edge_path(const edge_index& edges, index_t s, const std::vector<index_t>& ids);
+
+// Edge ids of the bridges of g, in get_bridges order.
+std::vector<index_t> get_bridge_ids(const graph& g);
+
+#endif
@@ -0,0 +1,220 @@
+// flatzinc_model_writer.cpp
+#include "flatzinc_model_writer.hpp"
+
+#include "graph.hpp"
+#include "path.hpp"
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const std::string VAR_PREFIX = "x";
+	const std::string NEQ_PREFIX = "d";
+	const std::string PATH_PREFIX = "p";
+	const std::string MAX_PREFIX = "m";
+
+	void add_edge_name(const edge_index& edges, index_t e, std::ostream& os)
+	{
+		auto ends = edges.endpoints(e);
+		os << VAR_PREFIX << ends.first << "_" << ends.second;
+	}
+}
+
+index_t flatzinc_model_writer::get_disequality(index_t e, index_t f)
+{
+	bool is_new = false;
+	const index_t d = disequalities_.get(e, f, is_new);
+
+	if (!is_new)
+		return d;
+
+	const auto pair = disequalities_.get_edges(d);
+
+	get_output_stream() << "var bool: " << NEQ_PREFIX << d << ";\n";
+
+	auto& cs = constraints_.stream();
+	cs << "constraint int_ne_reif(";
+	add_edge_name(edges_, pair.first, cs);
+	cs << ", ";
+	add_edge_name(edges_, pair.second, cs);
+	cs << ", " << NEQ_PREFIX << d << ");\n";
+
+	return d;
+}
+
+void flatzinc_model_writer::write_vertex_pair(index_t u, index_t v, const std::vector<edge_path>& paths)
+{
+	constraints_.stream() << get_comment() << " Vertex pair " << u << " " << v << "\n";
+
+	std::vector<index_t> selectors;
+
+	for (const auto& p : paths)
+	{
+		const auto ids = edges_.to_ids(p);
+		const index_t s = selectors_++;
+
+		get_output_stream() << "var bool: " << PATH_PREFIX << s << ";\n";
+		selectors.emplace_back(s);
+
+		std::vector<index_t> lits;
+		for (index_t i = 0; i < ids.size(); ++i)
+		{
+			for (index_t j = i + 1; j < ids.size(); ++j)
+			{
+				lits.emplace_back(get_disequality(ids[i], ids[j]));
+			}
+		}
+
+		auto& cs = constraints_.stream();
+		cs << "constraint array_bool_and([";
+		for (index_t i = 0; i < lits.size(); ++i)
+		{
+			cs << NEQ_PREFIX << lits[i];
+
+			if (i != lits.size() - 1)
+				cs << ",";
+		}
+		cs << "], " << PATH_PREFIX << s << ");\n";
+	}
+
+	// An empty clause is false, which is the right answer when no path fits.
+	auto& cs = constraints_.stream();
+	cs << "constraint bool_clause([";
+	for (index_t i = 0; i < selectors.size(); ++i)
+	{
+		cs << PATH_PREFIX << selectors[i];
+
+		if (i != selectors.size() - 1)
+			cs << ",";
+	}
+	cs << "], []);\n";
+}
+
+void flatzinc_model_writer::impl_preprocess()
+{
+	auto& os = get_output_stream();
+	constraints_.set_budget(get_memory_budget());
+
+	for (index_t e = 0; e < edges_.size(); ++e)
+	{
+		os << "var 1.." << get_solution_size() << ": ";
+		add_edge_name(edges_, e, os);
+		os << " :: output_var;\n";
+	}
+}
+
+void flatzinc_model_writer::add_value_precedence()
+{
+	auto& os = get_output_stream();
+	index_t pinned = 0;
+	const auto order = get_value_order(pinned);
+
+	// m<i> is the largest colour among the first i + 1 edges of the order;
+	// the first edge stands in for m0 and the last needs none.
+	for (std::size_t i = 1; i + 1 < order.size(); ++i)
+		os << "var 1.." << get_solution_size() << ": " << MAX_PREFIX << i << ";\n";
+
+	auto& cs = constraints_.stream();
+	cs << get_comment() << " Value symmetry\n";
+
+	for (index_t i = 0; i < pinned; ++i)
+	{
+		cs << "constraint int_eq(";
+		add_edge_name(edges_, order[i], cs);
+		cs << ", " << i + 1 << ");\n";
+	}
+
+	if (pinned == 0)
+	{
+		cs << "constraint int_eq(";
+		add_edge_name(edges_, order[0], cs);
+		cs << ", 1);\n";
+	}
+
+	for (std::size_t i = 1; i < order.size(); ++i)
+	{
+		std::ostringstream previous;
+
+		if (i == 1)
+			add_edge_name(edges_, order[0], previous);
+		else
+			previous << MAX_PREFIX << i - 1;
+
+		// At most one above the maximum before it.
+		cs << "constraint int_lin_le([1,-1], [";
+		add_edge_name(edges_, order[i], cs);
+		cs << ", " << previous.str() << "], 1);\n";
+
+		if (i + 1 < order.size())
+		{
+			cs << "constraint int_max(" << previous.str() << ", ";
+			add_edge_name(edges_, order[i], cs);
+			cs << ", " << MAX_PREFIX << i << ");\n";
+		}
+	}
+}
+
+void flatzinc_model_writer::impl_postprocess()
+{
+	auto& os = get_output_stream();
+
+	if (get_value_symmetry() != value_symmetry::none && edges_.size() != 0)
+		add_value_precedence();
+
+	constraints_.copy_to(os);
+
+	// Bridges must get distinct colors; with forced facts they are among the
+	// cliques, which also stand in for the pairs left out.
+	std::vector<std::vector<index_t>> distinct;
+
+	if (get_forced_distinct() != nullptr)
+	{
+		os << get_comment() << " Forced distinct edges\n";
+		distinct = get_forced_distinct()->get_cliques();
+	}
+	else if (get_bridge_ids().size() >= 2)
+	{
+		os << get_comment() << " Bridges\n";
+		distinct.emplace_back(get_bridge_ids());
+	}
+
+	for (const auto& ids : distinct)
+	{
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			for (std::size_t j = i + 1; j < ids.size(); ++j)
+			{
+				os << "constraint int_ne(";
+				add_edge_name(edges_, ids[i], os);
+				os << ", ";
+				add_edge_name(edges_, ids[j], os);
+				os << ");\n";
+			}
+		}
+	}
+
+	os << "solve satisfy;\n";
+}
+
+void flatzinc_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_paths(u, v, paths, get_solution_size());
+
+	write_vertex_pair(u, v, paths);
+}
+
+void flatzinc_model_writer::impl_add_comment(const std::string& text)
+{
+	constraints_.stream() << get_comment() << " " << text << "\n";
+}
+
+void strong_flatzinc_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_shortest_paths(u, v, paths);
+
+	write_vertex_pair(u, v, paths);
+}
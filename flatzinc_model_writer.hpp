@@ -0,0 +1,67 @@
+// flatzinc_model_writer.hpp
+#ifndef FLATZINC_MODEL_WRITER_HPP
+#define FLATZINC_MODEL_WRITER_HPP
+
+#include "model_writer.hpp"
+#include "disequality.hpp"
+#include "edge_index.hpp"
+#include "path_spool.hpp"
+#include <vector>
+#include <string>
+
+// Writes the model directly in FlatZinc, so no mzn2fzn flattening is needed.
+// Every pair of edges (e,f) that occurs together on some path gets one reified
+// literal for "e and f get different colors"; a path is rainbow iff all of its
+// literals hold, and every vertex pair needs at least one rainbow path.
+class flatzinc_model_writer : public model_writer
+{
+public:
+	flatzinc_model_writer(const graph& g, index_t k, std::ostream& os)
+		: model_writer(g, k, os, "%"), edges_(g), disequalities_(g), selectors_(0)
+	{
+
+	}
+
+	virtual ~flatzinc_model_writer() { }
+
+protected:
+	void write_vertex_pair(index_t u, index_t v, const std::vector<edge_path>& paths);
+
+private:
+	virtual void impl_preprocess();
+	virtual void impl_postprocess();
+
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual void impl_add_comment(const std::string& text);
+
+	index_t get_disequality(index_t e, index_t f);
+
+	// Declares the running maxima and buffers the value symmetry constraints.
+	void add_value_precedence();
+
+	edge_index edges_;
+	disequality_table disequalities_;
+	index_t selectors_;
+
+	// FlatZinc wants all declarations before the first constraint, so the
+	// constraints wait here, in a temporary file under a memory budget.
+	text_spool constraints_;
+};
+
+class strong_flatzinc_model_writer : public flatzinc_model_writer
+{
+public:
+	strong_flatzinc_model_writer(const graph& g, index_t k, std::ostream& os)
+		: flatzinc_model_writer(g, k, os)
+	{
+
+	}
+
+private:
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual bool impl_shortest_paths() const { return true; }
+};
+
+#endif
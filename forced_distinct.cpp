@@ -0,0 +1,198 @@
+// forced_distinct.cpp
+#include "forced_distinct.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace
+{
+	index_t count_row(const std::uint64_t* row, index_t words)
+	{
+		index_t count = 0;
+
+		for (index_t w = 0; w < words; ++w)
+			count += popcount64(row[w]);
+
+		return count;
+	}
+
+	bool test(const std::uint64_t* row, index_t e)
+	{
+		return (row[e / 64] >> (e % 64)) & 1;
+	}
+}
+
+forced_distinct::forced_distinct(const rainbow_checker& checker, const std::vector<index_t>& distinct)
+	: elements_(checker.num_elements()), words_((elements_ + 63) / 64), facts_(0),
+	rows_(elements_ * words_, 0), satisfied_(checker.num_pairs(), 0), num_satisfied_(0)
+{
+	for (std::size_t i = 0; i < distinct.size(); ++i)
+	{
+		for (std::size_t j = i + 1; j < distinct.size(); ++j)
+			force(distinct[i], distinct[j]);
+	}
+
+	// hits[x] counts the paths so far through an element x of the first path.
+	std::vector<index_t> hits(elements_, 0);
+	std::vector<index_t> common;
+
+	for (index_t i = 0; i < checker.num_pairs(); ++i)
+	{
+		const path_matrix& paths = checker.get_paths(i);
+
+		if (paths.num_paths() == 0)
+			continue;
+
+		for (index_t j = 0; j < paths.length(0); ++j)
+			hits[paths.edge(0, j)] = 1;
+
+		for (index_t p = 1; p < paths.num_paths(); ++p)
+		{
+			for (index_t j = 0; j < paths.length(p); ++j)
+			{
+				const index_t x = paths.edge(p, j);
+
+				if (hits[x] == p)
+					++hits[x];
+			}
+		}
+
+		common.clear();
+
+		for (index_t j = 0; j < paths.length(0); ++j)
+		{
+			const index_t x = paths.edge(0, j);
+
+			if (hits[x] == paths.num_paths())
+				common.emplace_back(x);
+
+			hits[x] = 0;
+		}
+
+		for (std::size_t a = 0; a < common.size(); ++a)
+		{
+			for (std::size_t b = a + 1; b < common.size(); ++b)
+				force(common[a], common[b]);
+		}
+	}
+
+	// Only now that all facts are in can a pair be found satisfied.
+	for (index_t i = 0; i < checker.num_pairs(); ++i)
+	{
+		const path_matrix& paths = checker.get_paths(i);
+
+		for (index_t p = 0; p < paths.num_paths() && !satisfied_[i]; ++p)
+		{
+			bool forced = true;
+
+			for (index_t a = 0; a < paths.length(p) && forced; ++a)
+			{
+				for (index_t b = a + 1; b < paths.length(p) && forced; ++b)
+					forced = differ(paths.edge(p, a), paths.edge(p, b));
+			}
+
+			satisfied_[i] = forced;
+		}
+
+		num_satisfied_ += satisfied_[i];
+	}
+
+	cover();
+}
+
+void forced_distinct::force(index_t e, index_t f)
+{
+	assert(e != f && e < elements_ && f < elements_);
+
+	if (differ(e, f))
+		return;
+
+	rows_[e * words_ + f / 64] |= (1ULL << (f % 64));
+	rows_[f * words_ + e / 64] |= (1ULL << (e % 64));
+	++facts_;
+}
+
+void forced_distinct::cover()
+{
+	std::vector<std::uint64_t> uncovered(rows_);
+	std::vector<index_t> degree(elements_);
+	std::vector<std::uint64_t> candidates(words_);
+
+	for (index_t e = 0; e < elements_; ++e)
+		degree[e] = count_row(&rows_[e * words_], words_);
+
+	for (;;)
+	{
+		// Start from the element with the most facts still to cover.
+		index_t first = -1;
+		index_t most = 0;
+
+		for (index_t e = 0; e < elements_; ++e)
+		{
+			const index_t open = count_row(&uncovered[e * words_], words_);
+
+			if (open > most)
+			{
+				first = e;
+				most = open;
+			}
+		}
+
+		if (first == -1)
+			break;
+
+		std::vector<index_t> clique(1, first);
+		std::copy(&rows_[first * words_], &rows_[first * words_] + words_, candidates.begin());
+
+		// Grow to a maximal clique, taking the candidate that covers the most
+		// open facts with the clique so far, then the one with the most facts
+		// overall. A larger alldiff propagates more even where it covers
+		// nothing new.
+		for (;;)
+		{
+			index_t best = -1;
+			index_t best_gain = -1;
+
+			for (index_t w = 0; w < words_; ++w)
+			{
+				for (std::uint64_t x = candidates[w]; x != 0; x &= x - 1)
+				{
+					const index_t c = 64 * w + ctz64(x);
+					index_t gain = 0;
+
+					for (auto member : clique)
+						gain += test(&uncovered[c * words_], member);
+
+					if (gain > best_gain || (gain == best_gain && degree[c] > degree[best]))
+					{
+						best = c;
+						best_gain = gain;
+					}
+				}
+			}
+
+			if (best == -1)
+				break;
+
+			clique.emplace_back(best);
+
+			for (index_t w = 0; w < words_; ++w)
+				candidates[w] &= rows_[best * words_ + w];
+		}
+
+		for (auto a : clique)
+		{
+			for (auto b : clique)
+				uncovered[a * words_ + b / 64] &= ~(1ULL << (b % 64));
+		}
+
+		std::sort(clique.begin(), clique.end());
+		cliques_.emplace_back(std::move(clique));
+	}
+
+	std::stable_sort(cliques_.begin(), cliques_.end(), [](const std::vector<index_t>& a, const std::vector<index_t>& b)
+	{
+		return a.size() > b.size();
+	});
+}
@@ -0,0 +1,50 @@
+// forced_distinct.hpp
+#ifndef FORCED_DISTINCT_HPP
+#define FORCED_DISTINCT_HPP
+
+#include "common.hpp"
+#include "rainbow_kernel.hpp"
+#include <cstdint>
+#include <vector>
+
+// Element pairs that get different colours in every solution. Two elements
+// on every path of some pair are forced apart, which covers pairs with a
+// single path (pendant edges, unique geodesics); so are any two of the
+// distinct elements given, such as the bridges. These facts make a conflict
+// graph on the elements, which is covered greedily by cliques, each to be
+// written as one alldiff. A pair with a path whose elements are pairwise
+// forced apart is satisfied by the cliques alone, so its disjunction can be
+// left out of the model.
+class forced_distinct
+{
+public:
+	forced_distinct(const rainbow_checker& checker, const std::vector<index_t>& distinct = std::vector<index_t>());
+
+	index_t num_elements() const { return elements_; }
+
+	bool differ(index_t e, index_t f) const { return (rows_[e * words_ + f / 64] >> (f % 64)) & 1; }
+
+	// Number of element pairs forced apart.
+	index_t num_facts() const { return facts_; }
+
+	// Cliques of the conflict graph, largest first, covering every fact.
+	const std::vector<std::vector<index_t>>& get_cliques() const { return cliques_; }
+
+	// Whether pair i of the checker is satisfied by the cliques.
+	bool is_satisfied(index_t i) const { return satisfied_[i] != 0; }
+	index_t num_satisfied() const { return num_satisfied_; }
+
+private:
+	void force(index_t e, index_t f);
+	void cover();
+
+	index_t elements_;
+	index_t words_;
+	index_t facts_;
+	std::vector<std::uint64_t> rows_;
+	std::vector<std::vector<index_t>> cliques_;
+	std::vector<char> satisfied_;
+	index_t num_satisfied_;
+};
+
+#endif
@@ -9,6 +9,8 @@
 #include <cassert>
 #include <random>
 #include <queue>
+#include <limits>
+#include <unordered_map>
 
 // DEBUG!
 #include <iostream>
@@ -51,6 +53,86 @@ namespace
 	}
 }
 
+namespace
+{
+	std::uint64_t saturating_add(std::uint64_t a, std::uint64_t b)
+	{
+		const std::uint64_t sum = a + b;
+		return (sum < a) ? std::numeric_limits<std::uint64_t>::max() : sum;
+	}
+
+	// The vertices of 'available' reachable from v without leaving it.
+	std::uint64_t reachable(const graph& g, index_t v, std::uint64_t available)
+	{
+		std::uint64_t seen = (1ULL << v);
+		std::uint64_t frontier = seen;
+
+		while (frontier != 0)
+		{
+			std::uint64_t next = 0;
+			for (std::uint64_t f = frontier; f != 0; f &= f - 1)
+				next |= g.adj_[ctz64(f)];
+
+			frontier = next & available & ~seen;
+			seen |= frontier;
+		}
+
+		return seen;
+	}
+
+	struct count_key_hash
+	{
+		std::size_t operator()(const std::pair<index_t, std::uint64_t>& key) const
+		{
+			return std::hash<std::uint64_t>()(key.second * 0x9E3779B97F4A7C15ULL + key.first);
+		}
+	};
+
+	struct count_state
+	{
+		const graph& g;
+		index_t t;
+		index_t length;
+		std::unordered_map<std::pair<index_t, std::uint64_t>, std::vector<std::uint64_t>, count_key_hash> memo;
+	};
+
+	// Paths from v to t by length, using only vertices in 'available' (which contains v).
+	std::vector<std::uint64_t> count_from(count_state& st, index_t v, std::uint64_t available)
+	{
+		std::vector<std::uint64_t> counts(st.length + 1, 0);
+
+		if (v == st.t)
+		{
+			counts[0] = 1;
+			return counts;
+		}
+
+		const std::uint64_t component = reachable(st.g, v, available);
+
+		if (!bittest64(component, st.t))
+			return counts;
+
+		const auto key = std::make_pair(v, component);
+		auto it = st.memo.find(key);
+
+		if (it != st.memo.end())
+			return it->second;
+
+		const std::uint64_t rest = component & ~(1ULL << v);
+
+		for (std::uint64_t adj = st.g.adj_[v] & rest; adj != 0; adj &= adj - 1)
+		{
+			const auto sub = count_from(st, ctz64(adj), rest);
+
+			for (index_t l = 0; l < st.length; ++l)
+				counts[l + 1] = saturating_add(counts[l + 1], sub[l]);
+		}
+
+		st.memo.emplace(key, counts);
+		return counts;
+	}
+}
+
 void graph::add_edge(index_t u, index_t v)
 {
 	assert(u >= 0 &&
@@ -403,6 +485,31 @@ index_t get_diameter(const graph& g)
 	return diam;
 }
 
+std::uint64_t hash_graph(const graph& g)
+{
+	const std::uint64_t FNV_OFFSET = 14695981039346656037ULL;
+	const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+	std::uint64_t h = FNV_OFFSET;
+	auto mix = [&](std::uint64_t word)
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			h ^= (word >> (8 * i)) & 0xff;
+			h *= FNV_PRIME;
+		}
+	};
+
+	mix(g.num_vertices());
+
+	for (auto adj : g.adj_)
+	{
+		mix(adj);
+	}
+
+	return h;
+}
+
 std::pair<index_t, index_t> get_diametral_pair(const graph& g)
 {
 	const index_t diam = get_diameter(g);
@@ -424,6 +531,47 @@ std::pair<index_t, index_t> get_diametral_pair(const graph& g)
 	return std::make_pair(0, 0);
 }
 
+std::vector<std::uint64_t> count_paths(const graph& g, index_t s, index_t t, index_t length)
+{
+	// No simple path has more than n - 1 edges.
+	length = std::min(length, g.num_vertices() - 1);
+
+	count_state st = { g, t, length };
+	const index_t n = g.num_vertices();
+	const std::uint64_t all = (n == 64) ? ~0ULL : ((1ULL << n) - 1);
+
+	return count_from(st, s, all);
+}
+
+std::uint64_t count_shortest_paths(const graph& g, index_t s, index_t t)
+{
+	const index_t n = g.num_vertices();
+	std::vector<index_t> dist(n, 0);
+	bfs(g, dist, s);
+
+	std::vector<index_t> order(n);
+	for (index_t i = 0; i < n; ++i)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [&dist](index_t a, index_t b) { return dist[a] < dist[b]; });
+
+	std::vector<std::uint64_t> counts(n, 0);
+	counts[s] = 1;
+
+	for (auto v : order)
+	{
+		for (std::uint64_t adj = g.adj_[v]; adj != 0; adj &= adj - 1)
+		{
+			const index_t w = ctz64(adj);
+
+			if (w != s && dist[w] == dist[v] + 1)
+				counts[w] = saturating_add(counts[w], counts[v]);
+		}
+	}
+
+	return counts[t];
+}
+
 // neato -Tpng foo.dot -o foo.png :-)
 void write_dot(const graph& g, const std::vector<index_t>& cols, std::ostream& os)
 {
@@ -4,8 +4,10 @@
 
 #include "common.hpp"
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstdint>
 
 struct graph
 {
@@ -62,8 +64,20 @@ std::vector<index_t> get_bridges(const graph& g);
 
 index_t get_diameter(const graph& g);
 
+// 64-bit FNV-1a hash of the adjacency matrix; independent of edge insertion order.
+std::uint64_t hash_graph(const graph& g);
+
 std::pair<index_t, index_t> get_diametral_pair(const graph& g);
 
+// Number of simple s-t paths by length: counts[l] is the number of paths with
+// exactly l edges, for l = 0..length. Nothing is enumerated; the count from a
+// vertex is memoised on the component of the graph still reachable from it.
+// Counts saturate at the largest std::uint64_t.
+std::vector<std::uint64_t> count_paths(const graph& g, index_t s, index_t t, index_t length);
+
+// Number of shortest s-t paths (saturating).
+std::uint64_t count_shortest_paths(const graph& g, index_t s, index_t t);
+
 void write_dot(const graph& g, const std::vector<index_t>& cols, std::ostream& os = std::cout);
 
 namespace detail
@@ -85,7 +99,7 @@ namespace detail
 		{
 			index_t adj = g.adj_[current];
 
-			for (int iter; adj != 0; adj &= ~(1 << iter))
+			for (int iter; adj != 0; adj &= ~(1ULL << iter))
 			{
 				if (current_path.size() >= length)
 					break;
@@ -114,6 +128,122 @@ void list_paths(const graph& g, index_t s, index_t t, std::vector<Path>& paths,
 	detail::recursive_list_paths(g, s, t, current_path, paths, length);
 }
 
+namespace detail
+{
+	template <typename Path, typename Visitor>
+	void recursive_visit_paths(const graph& g, index_t current, index_t t, Path& current_path, Visitor& visit, index_t length)
+	{
+		current_path.discover_vertex(current);
+
+		if (current == t)
+		{
+			visit(static_cast<const Path&>(current_path));
+		}
+		else if (current_path.size() < length)
+		{
+			for (index_t adj = g.adj_[current]; adj != 0; adj &= adj - 1)
+			{
+				const int iter = ctz64(adj);
+
+				if (!current_path.contains_vertex(iter))
+				{
+					recursive_visit_paths<Path>(g, iter, t, current_path, visit, length);
+				}
+			}
+		}
+
+		current_path.backtrack_vertex(current);
+	}
+}
+
+// Like list_paths, but hands every path to visit(const Path&) as it is found
+// instead of storing it.
+template <typename Path, typename Visitor>
+void visit_paths(const graph& g, index_t s, index_t t, Visitor& visit, index_t length)
+{
+	Path current_path;
+	detail::recursive_visit_paths(g, s, t, current_path, visit, length);
+}
+
+namespace detail
+{
+	template <typename Path, typename Visitor>
+	void recursive_visit_paths_from(const graph& g, index_t current, index_t targets, const std::vector<index_t>& lengths, Path& current_path, Visitor& visit, index_t length)
+	{
+		current_path.discover_vertex(current);
+
+		if (bittest64(targets, current) && current_path.size() <= lengths[current])
+		{
+			visit(current, static_cast<const Path&>(current_path));
+		}
+
+		// Paths go on past a target to the targets behind it.
+		if (current_path.size() < length)
+		{
+			for (index_t adj = g.adj_[current]; adj != 0; adj &= adj - 1)
+			{
+				const int iter = ctz64(adj);
+
+				if (!current_path.contains_vertex(iter))
+				{
+					recursive_visit_paths_from<Path>(g, iter, targets, lengths, current_path, visit, length);
+				}
+			}
+		}
+
+		current_path.backtrack_vertex(current);
+	}
+
+	template <typename Path, typename Visitor>
+	void recursive_visit_shortest_paths_from(const graph& g, index_t current, index_t targets, const std::vector<index_t>& dist, Path& current_path, Visitor& visit)
+	{
+		current_path.discover_vertex(current);
+
+		if (bittest64(targets, current))
+		{
+			visit(current, static_cast<const Path&>(current_path));
+		}
+
+		for (index_t adj = g.adj_[current]; adj != 0; adj &= adj - 1)
+		{
+			const int iter = ctz64(adj);
+
+			if (dist[iter] == dist[current] + 1)
+			{
+				recursive_visit_shortest_paths_from<Path>(g, iter, targets, dist, current_path, visit);
+			}
+		}
+
+		current_path.backtrack_vertex(current);
+	}
+}
+
+// One DFS from s for many targets: hands every simple path from s to a
+// vertex t of the targets mask with at most lengths[t] edges to
+// visit(t, const Path&). The search is cut at the largest of those bounds.
+template <typename Path, typename Visitor>
+void visit_paths_from(const graph& g, index_t s, index_t targets, const std::vector<index_t>& lengths, Visitor& visit)
+{
+	index_t length = 0;
+	for (index_t x = targets; x != 0; x &= x - 1)
+		length = std::max(length, lengths[ctz64(x)]);
+
+	Path current_path;
+	detail::recursive_visit_paths_from(g, s, targets, lengths, current_path, visit, length);
+}
+
+// The same for geodesics: a DFS from s that only steps one level further
+// from s visits every shortest path to every target once.
+template <typename Path, typename Visitor>
+void visit_shortest_paths_from(const graph& g, index_t s, index_t targets, Visitor& visit)
+{
+	std::vector<index_t> dist(g.num_vertices(), 0);
+	bfs(g, dist, s);
+
+	Path current_path;
+	detail::recursive_visit_shortest_paths_from(g, s, targets, dist, current_path, visit);
+}
+
 namespace detail
 {
 	template <typename Path>
@@ -132,7 +262,7 @@ namespace detail
 
 		index_t adj = g.adj_[current];
 
-		for (int iter; adj != 0; adj &= ~(1 << iter))
+		for (int iter; adj != 0; adj &= ~(1ULL << iter))
 		{
 			iter = ctz64(adj);
 
@@ -0,0 +1,428 @@
+// graph_kernel.cpp
+#include "graph_kernel.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+	// Vertices kept in the core path cache before it is emptied.
+	const std::size_t MAX_STORED = 1 << 22;
+}
+
+graph_kernel::graph_kernel(const graph& g)
+	: core_(0), kernel_(0), inner_(0),
+	parent_(g.num_vertices(), -1), root_(g.num_vertices()), depth_(g.num_vertices(), 0),
+	chain_of_(g.num_vertices(), -1), offset_(g.num_vertices(), -1), incident_(g.num_vertices()), adjacent_(g.adj_)
+{
+	const index_t n = g.num_vertices();
+	assert(n >= 1 && is_connected(g));
+
+	core_ = (n == 64) ? ~0ULL : ((1ULL << n) - 1);
+
+	// Peel degree-1 vertices until only the core (or one vertex of a tree)
+	// is left.
+	std::vector<index_t> degree(n);
+	std::vector<index_t> queue;
+	std::vector<index_t> order;
+
+	for (index_t v = 0; v < n; ++v)
+	{
+		degree[v] = popcount64(g.adj_[v]);
+
+		if (degree[v] == 1)
+			queue.emplace_back(v);
+	}
+
+	index_t remaining = n;
+
+	for (std::size_t i = 0; i < queue.size() && remaining > 1; ++i)
+	{
+		const index_t v = queue[i];
+		const index_t p = ctz64(g.adj_[v] & core_);
+
+		core_ &= ~(1ULL << v);
+		parent_[v] = p;
+		order.emplace_back(v);
+		--remaining;
+
+		if (--degree[p] == 1)
+			queue.emplace_back(p);
+	}
+
+	for (index_t v = 0; v < n; ++v)
+		root_[v] = v;
+
+	for (auto it = order.crbegin(); it != order.crend(); ++it)
+	{
+		const index_t p = parent_[*it];
+
+		root_[*it] = root_[p];
+		depth_[*it] = depth_[p] + 1;
+
+		if (parent_[p] != -1)
+			inner_ |= (1ULL << p);
+	}
+
+	for (std::uint64_t x = core_; x != 0; x &= x - 1)
+	{
+		const index_t v = ctz64(x);
+
+		if (popcount64(g.adj_[v] & core_) != 2)
+			kernel_ |= (1ULL << v);
+	}
+
+	// A cycle gets one kernel vertex to start and end at.
+	if (kernel_ == 0)
+		kernel_ = (1ULL << ctz64(core_));
+
+	std::vector<std::uint64_t> used(n, 0);
+
+	for (std::uint64_t x = kernel_; x != 0; x &= x - 1)
+	{
+		const index_t a = ctz64(x);
+
+		for (std::uint64_t y = g.adj_[a] & core_; y != 0; y &= y - 1)
+		{
+			index_t next = ctz64(y);
+
+			if (bittest64(used[a], next))
+				continue;
+
+			const index_t chain = chains_.size();
+			std::vector<index_t> vertices(1, a);
+			index_t prev = a;
+
+			for (;;)
+			{
+				used[prev] |= (1ULL << next);
+				used[next] |= (1ULL << prev);
+				vertices.emplace_back(next);
+
+				if (is_kernel_vertex(next))
+					break;
+
+				chain_of_[next] = chain;
+				offset_[next] = vertices.size() - 1;
+
+				const index_t after = ctz64(g.adj_[next] & core_ & ~(1ULL << prev));
+				prev = next;
+				next = after;
+			}
+
+			incident_[a].emplace_back(chain);
+
+			if (vertices.back() != a)
+				incident_[vertices.back()].emplace_back(chain);
+
+			chains_.emplace_back(std::move(vertices));
+		}
+	}
+}
+
+bool graph_kernel::is_implied(index_t u, index_t v) const
+{
+	// One path of bridges, or a pair through an inner tree vertex.
+	return root_[u] == root_[v] || bittest64(inner_, u) || bittest64(inner_, v);
+}
+
+index_t graph_kernel::num_kernel_pairs() const
+{
+	const index_t n = num_vertices();
+	index_t pairs = 0;
+
+	for (index_t u = 0; u < n; ++u)
+	{
+		for (index_t v = u + 1; v < n; ++v)
+		{
+			if (!bittest64(adjacent_[u], v) && !is_implied(u, v))
+				++pairs;
+		}
+	}
+
+	return pairs;
+}
+
+void graph_kernel::join(index_t s, index_t t, const std::vector<index_t>& core_path, std::vector<index_t>& out) const
+{
+	assert(core_path.front() == root_[s] && core_path.back() == root_[t]);
+
+	out.clear();
+
+	for (index_t v = s; v != root_[s]; v = parent_[v])
+		out.emplace_back(v);
+
+	out.insert(out.end(), core_path.begin(), core_path.end());
+
+	const std::size_t tail = out.size();
+
+	for (index_t v = t; v != root_[t]; v = parent_[v])
+		out.emplace_back(v);
+
+	std::reverse(out.begin() + tail, out.end());
+}
+
+void graph_kernel::list_paths(index_t s, index_t t, std::vector<std::vector<index_t>>& paths, index_t length) const
+{
+	assert(s != t);
+
+	if (root_[s] == root_[t])
+	{
+		// The tree path, up to the lowest common ancestor and down again.
+		std::vector<index_t> up(1, s);
+		std::vector<index_t> down(1, t);
+
+		while (up.back() != down.back())
+		{
+			if (depth_[up.back()] >= depth_[down.back()])
+				up.emplace_back(parent_[up.back()]);
+			else
+				down.emplace_back(parent_[down.back()]);
+		}
+
+		if (static_cast<index_t>(up.size() + down.size()) - 2 <= length)
+		{
+			up.insert(up.end(), down.rbegin() + 1, down.rend());
+			paths.emplace_back(std::move(up));
+		}
+
+		return;
+	}
+
+	const index_t budget = length - depth_[s] - depth_[t];
+
+	if (budget < 1)
+		return;
+
+	std::vector<std::vector<index_t>> core_paths;
+	list_core_paths(root_[s], root_[t], core_paths, budget);
+
+	for (const auto& p : core_paths)
+	{
+		paths.emplace_back();
+		join(s, t, p, paths.back());
+	}
+}
+
+std::vector<graph_kernel::attachment> graph_kernel::get_attachments(index_t v) const
+{
+	if (is_kernel_vertex(v))
+		return std::vector<attachment>(1, attachment{ -1, 0, 0 });
+
+	const index_t chain = chain_of_[v];
+	const index_t last = chains_[chain].size() - 1;
+
+	return std::vector<attachment>{ attachment{ chain, offset_[v], 0 }, attachment{ chain, offset_[v], last } };
+}
+
+void graph_kernel::append_chain(index_t chain, index_t first, index_t last, std::vector<index_t>& out) const
+{
+	const std::vector<index_t>& vertices = chains_[chain];
+
+	if (first < last)
+	{
+		for (index_t i = first + 1; i <= last; ++i)
+			out.emplace_back(vertices[i]);
+	}
+	else
+	{
+		for (index_t i = first - 1; i >= last; --i)
+			out.emplace_back(vertices[i]);
+	}
+}
+
+void graph_kernel::visit_kernel_paths(index_t current, index_t t, std::uint64_t visited, index_t length, index_t skip_a, index_t skip_b,
+	std::vector<index_t>& current_path, std::vector<std::vector<index_t>>& paths) const
+{
+	if (current == t)
+	{
+		paths.emplace_back(current_path);
+		return;
+	}
+
+	for (auto chain : incident_[current])
+	{
+		const std::vector<index_t>& vertices = chains_[chain];
+		const index_t weight = vertices.size() - 1;
+
+		// A cycle through current cannot be part of a simple path.
+		if (chain == skip_a || chain == skip_b || vertices.front() == vertices.back() || weight > length)
+			continue;
+
+		const bool forward = (vertices.front() == current);
+		const index_t other = forward ? vertices.back() : vertices.front();
+
+		if (bittest64(visited, other))
+			continue;
+
+		const std::size_t size = current_path.size();
+		append_chain(chain, forward ? 0 : weight, forward ? weight : 0, current_path);
+
+		visit_kernel_paths(other, t, visited | (1ULL << other), length - weight, skip_a, skip_b, current_path, paths);
+		current_path.resize(size);
+	}
+}
+
+void graph_kernel::list_core_paths(index_t s, index_t t, std::vector<std::vector<index_t>>& paths, index_t length) const
+{
+	assert(s != t && is_core(s) && is_core(t));
+
+	std::vector<index_t> current(1, s);
+	std::vector<std::vector<index_t>> middle;
+
+	// Both inside one chain: along it, or out at the end beyond s and back in
+	// at the end beyond t.
+	if (!is_kernel_vertex(s) && !is_kernel_vertex(t) && chain_of_[s] == chain_of_[t])
+	{
+		const index_t chain = chain_of_[s];
+		const std::vector<index_t>& vertices = chains_[chain];
+		const index_t i = offset_[s];
+		const index_t j = offset_[t];
+
+		if (std::abs(i - j) <= length)
+		{
+			append_chain(chain, i, j, current);
+			paths.emplace_back(current);
+		}
+
+		const index_t end_s = (i < j) ? 0 : vertices.size() - 1;
+		const index_t end_t = (i < j) ? vertices.size() - 1 : 0;
+		const index_t weight = std::abs(i - end_s) + std::abs(j - end_t);
+
+		if (weight > length)
+			return;
+
+		current.resize(1);
+		append_chain(chain, i, end_s, current);
+
+		const index_t a = vertices[end_s];
+		const index_t b = vertices[end_t];
+
+		if (a == b)
+			middle.emplace_back(current);
+		else
+			visit_kernel_paths(a, b, (1ULL << a), length - weight, chain, -1, current, middle);
+
+		for (auto& p : middle)
+		{
+			append_chain(chain, end_t, j, p);
+			paths.emplace_back(std::move(p));
+		}
+
+		return;
+	}
+
+	const auto from = get_attachments(s);
+	const auto to = get_attachments(t);
+
+	for (const auto& x : from)
+	{
+		for (const auto& y : to)
+		{
+			const index_t weight = std::abs(x.first - x.last) + std::abs(y.first - y.last);
+
+			if (weight > length)
+				continue;
+
+			const index_t a = (x.chain == -1) ? s : chains_[x.chain][x.last];
+			const index_t b = (y.chain == -1) ? t : chains_[y.chain][y.last];
+
+			current.resize(1);
+
+			if (x.chain != -1)
+				append_chain(x.chain, x.first, x.last, current);
+
+			middle.clear();
+
+			if (a == b)
+				middle.emplace_back(current);
+			else
+				visit_kernel_paths(a, b, (1ULL << a), length - weight, x.chain, y.chain, current, middle);
+
+			for (auto& p : middle)
+			{
+				if (y.chain != -1)
+					append_chain(y.chain, y.last, y.first, p);
+
+				paths.emplace_back(std::move(p));
+			}
+		}
+	}
+}
+
+const graph_kernel& kernel_path_source::get_kernel(const graph& g)
+{
+	const std::uint64_t hash = hash_graph(g);
+
+	if (kernel_ == nullptr || hash != hash_ || kernel_->num_vertices() != g.num_vertices())
+	{
+		kernel_.reset(new graph_kernel(g));
+		hash_ = hash;
+		core_paths_.clear();
+		stored_ = 0;
+	}
+
+	return *kernel_;
+}
+
+void kernel_path_source::get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	const graph_kernel& kernel = get_kernel(g);
+	std::vector<std::vector<index_t>> found;
+
+	if (kernel.get_root(s) == kernel.get_root(t))
+	{
+		kernel.list_paths(s, t, found, length);
+	}
+	else
+	{
+		// No core path is longer than the core has vertices.
+		const index_t budget = std::min(length - kernel.get_depth(s) - kernel.get_depth(t), kernel.num_core_vertices() - 1);
+
+		if (budget < 1)
+			return;
+
+		const key_type key(kernel.get_root(s), kernel.get_root(t), budget);
+		auto it = core_paths_.find(key);
+
+		if (it == core_paths_.end())
+		{
+			if (stored_ > MAX_STORED)
+			{
+				core_paths_.clear();
+				stored_ = 0;
+			}
+
+			it = core_paths_.emplace(key, std::vector<std::vector<index_t>>()).first;
+			kernel.list_core_paths(std::get<0>(key), std::get<1>(key), it->second, budget);
+
+			for (const auto& p : it->second)
+				stored_ += p.size();
+		}
+
+		found.resize(it->second.size());
+
+		for (std::size_t i = 0; i < found.size(); ++i)
+			kernel.join(s, t, it->second[i], found[i]);
+	}
+
+	for (const auto& vertices : found)
+	{
+		edge_path p;
+
+		for (auto v : vertices)
+			p.discover_vertex(v);
+
+		paths.emplace_back(std::move(p));
+	}
+}
+
+void kernel_path_source::get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	std::vector<index_t> dist(g.num_vertices(), 0);
+	bfs(g, dist, s);
+
+	get_paths(g, s, t, paths, dist[t]);
+}
@@ -0,0 +1,132 @@
+// graph_kernel.hpp
+#ifndef GRAPH_KERNEL_HPP
+#define GRAPH_KERNEL_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// A connected graph split into its pendant trees and its core, with the core
+// contracted to a kernel. Pendant trees are peeled off leaf by leaf; every
+// peeled vertex hangs off a core root at some depth, and all of its edges are
+// bridges. In the core, the kernel vertices are those not of degree 2 (one
+// vertex stands in if the core is a cycle), and every maximal chain of
+// degree-2 vertices between two of them becomes one super-edge whose weight
+// is its number of edges.
+//
+// Pairs of vertices in the same pendant tree have one path, made of bridges.
+// A pair with a peeled vertex u that is not a leaf is implied by the pair
+// with a leaf below u, whose paths (or geodesics) all run through u. Only the
+// remaining pairs need to be modelled, and their paths are a tree path to a
+// root, a path through the kernel and a tree path back.
+//
+// Chains only make path generation cheaper; none of their pairs is left out.
+// A chain vertex has a way out at either end, so no other pair has all of its
+// paths through it, and a rainbow path of another pair need not contain one
+// for the chain vertex. On a cycle every non-adjacent pair is modelled.
+class graph_kernel
+{
+public:
+	explicit graph_kernel(const graph& g);
+
+	index_t num_vertices() const { return parent_.size(); }
+
+	bool is_core(index_t v) const { return parent_[v] == -1; }
+	bool is_kernel_vertex(index_t v) const { return bittest64(kernel_, v); }
+
+	// Towards the core for a peeled vertex, or -1.
+	index_t get_parent(index_t v) const { return parent_[v]; }
+
+	// The core vertex a peeled vertex hangs off (v itself for a core vertex)
+	// and the distance to it.
+	index_t get_root(index_t v) const { return root_[v]; }
+	index_t get_depth(index_t v) const { return depth_[v]; }
+
+	bool is_leaf(index_t v) const { return !is_core(v) && !bittest64(inner_, v); }
+
+	index_t num_core_vertices() const { return popcount64(core_); }
+	index_t num_kernel_vertices() const { return popcount64(kernel_); }
+
+	// The super-edges as vertex sequences from one kernel vertex to another,
+	// both ends included; the ends are equal for a cycle.
+	const std::vector<std::vector<index_t>>& get_chains() const { return chains_; }
+
+	// Whether the pair (u, v) is satisfied by the bridges being distinct or
+	// implied by another pair, for rainbow and strong rainbow connection.
+	bool is_implied(index_t u, index_t v) const;
+
+	// Number of non-adjacent pairs left to model.
+	index_t num_kernel_pairs() const;
+
+	// Vertex sequences of the simple s-t paths with at most length edges.
+	void list_paths(index_t s, index_t t, std::vector<std::vector<index_t>>& paths, index_t length) const;
+
+	// The same paths when s and t are core vertices.
+	void list_core_paths(index_t s, index_t t, std::vector<std::vector<index_t>>& paths, index_t length) const;
+
+	// The tree path from s to its root, then core_path (from the root of s
+	// to the root of t), then the tree path down to t.
+	void join(index_t s, index_t t, const std::vector<index_t>& core_path, std::vector<index_t>& out) const;
+
+private:
+	// A way from a core vertex to a kernel vertex along its own chain.
+	struct attachment
+	{
+		index_t chain;
+		index_t first;
+		index_t last;
+	};
+
+	std::vector<attachment> get_attachments(index_t v) const;
+	void append_chain(index_t chain, index_t first, index_t last, std::vector<index_t>& out) const;
+
+	void visit_kernel_paths(index_t current, index_t t, std::uint64_t visited, index_t length, index_t skip_a, index_t skip_b,
+		std::vector<index_t>& current_path, std::vector<std::vector<index_t>>& paths) const;
+
+	std::uint64_t core_;
+	std::uint64_t kernel_;
+	std::uint64_t inner_;
+	std::vector<index_t> parent_;
+	std::vector<index_t> root_;
+	std::vector<index_t> depth_;
+	std::vector<std::vector<index_t>> chains_;
+	std::vector<index_t> chain_of_;
+	std::vector<index_t> offset_;
+	std::vector<std::vector<index_t>> incident_;
+	std::vector<index_t> adjacent_;
+};
+
+// Paths built from the kernel of the graph asked about, which is rebuilt when
+// the graph changes. Core paths are kept per pair of roots and length, so the
+// paths of a core pair are found once for all the leaves hanging off it (up
+// to a bounded number of stored vertices). Geodesics are the paths of
+// distance length.
+class kernel_path_source : public path_source
+{
+public:
+	kernel_path_source() : hash_(0), stored_(0) { }
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+
+	// The kernel of g.
+	const graph_kernel& get_kernel(const graph& g);
+
+private:
+	typedef std::tuple<index_t, index_t, index_t> key_type;
+
+	std::uint64_t hash_;
+	std::unique_ptr<graph_kernel> kernel_;
+	std::map<key_type, std::vector<std::vector<index_t>>> core_paths_;
+	std::size_t stored_;
+};
+
+#endif
@@ -0,0 +1,204 @@
+// lazy_solver.cpp
+#include "lazy_solver.hpp"
+
+#include "edge_index.hpp"
+#include "path_index.hpp"
+#include "rainbow_kernel.hpp"
+#include "verifier.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <random>
+#include <utility>
+
+namespace
+{
+	// Keeps the paths of every pair enumerated so far, so that a round only
+	// searches for the pairs it adds. Without a source the new pairs of a
+	// vertex u are found in one DFS from u cut at just those targets.
+	class pair_path_cache : public path_source
+	{
+	public:
+		pair_path_cache(index_t k, bool strong, path_source* source, lazy_statistics& stats)
+			: k_(k), strong_(strong), source_(source), stats_(stats)
+		{
+
+		}
+
+		// Enumerates the pairs not seen yet; pairs are in next_pair order.
+		void add_pairs(const graph& g, const std::vector<std::pair<index_t, index_t>>& pairs)
+		{
+			index_t u = -1;
+			index_t targets = 0;
+
+			for (const auto& pair : pairs)
+			{
+				if (paths_.count(pair) != 0)
+					continue;
+
+				++stats_.pairs;
+
+				if (source_ != nullptr)
+				{
+					auto& paths = paths_[pair];
+
+					if (strong_)
+						source_->get_shortest_paths(g, pair.first, pair.second, paths);
+					else
+						source_->get_paths(g, pair.first, pair.second, paths, k_);
+
+					stats_.paths += paths.size();
+					++stats_.searches;
+					continue;
+				}
+
+				if (pair.first != u)
+				{
+					search(g, u, targets);
+					u = pair.first;
+					targets = 0;
+				}
+
+				paths_[pair];
+				targets |= (1ULL << pair.second);
+			}
+
+			search(g, u, targets);
+		}
+
+		virtual void get_paths(const graph&, index_t s, index_t t, std::vector<edge_path>& paths, index_t)
+		{
+			copy(s, t, paths);
+		}
+
+		virtual void get_shortest_paths(const graph&, index_t s, index_t t, std::vector<edge_path>& paths)
+		{
+			copy(s, t, paths);
+		}
+
+	private:
+		void search(const graph& g, index_t u, index_t targets)
+		{
+			if (targets == 0)
+				return;
+
+			auto add = [this, u](index_t v, const edge_path& p)
+			{
+				paths_[std::make_pair(u, v)].emplace_back(p);
+				++stats_.paths;
+			};
+
+			if (strong_)
+				visit_shortest_paths_from<edge_path>(g, u, targets, add);
+			else
+				visit_paths_from<edge_path>(g, u, targets, std::vector<index_t>(g.num_vertices(), k_), add);
+
+			++stats_.searches;
+		}
+
+		void copy(index_t s, index_t t, std::vector<edge_path>& paths) const
+		{
+			const auto& found = paths_.at(std::make_pair(s, t));
+			paths.insert(paths.end(), found.begin(), found.end());
+		}
+
+		index_t k_;
+		bool strong_;
+		path_source* source_;
+		lazy_statistics& stats_;
+		std::map<std::pair<index_t, index_t>, std::vector<edge_path>> paths_;
+	};
+}
+
+solve_status solve_rainbow_lazy(const graph& g, index_t k, std::vector<index_t>& colours, bool strong, double time_limit, path_source* source, lazy_statistics* statistics)
+{
+	const index_t n = g.num_vertices();
+	const auto start = std::chrono::steady_clock::now();
+
+	lazy_statistics local;
+	lazy_statistics& stats = (statistics != nullptr) ? *statistics : local;
+	stats = lazy_statistics();
+
+	// Bridges are on every path of the pairs they separate, so any two of
+	// them must differ.
+	const std::vector<index_t> distinct = get_bridge_ids(g);
+
+	// Far pairs have few paths that fit, so they are the likeliest to fail.
+	std::vector<std::pair<index_t, index_t>> pairs;
+
+	for (index_t u = 0; u < n; ++u)
+	{
+		std::vector<index_t> dist(n, 0);
+		bfs(g, dist, u);
+
+		for (index_t v = u + 1; v < n; ++v)
+		{
+			if (is_adjacent(g, u, v))
+				continue;
+
+			++stats.total_pairs;
+
+			if (dist[v] >= k - 1)
+				pairs.emplace_back(u, v);
+		}
+	}
+
+	// Each round starts from the last colouring, so that it moves as little as
+	// the new pairs require; the first from a random one, which already
+	// satisfies most pairs.
+	std::mt19937_64 gen(1);
+	std::uniform_int_distribution<index_t> colour(1, k);
+	std::vector<index_t> phase(g.num_edges());
+
+	for (auto& c : phase)
+		c = colour(gen);
+
+	pair_path_cache cache(k, strong, source, stats);
+
+	for (;;)
+	{
+		double remaining = 0;
+
+		if (time_limit > 0)
+		{
+			remaining = time_limit - std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (remaining <= 0)
+				return solve_status::unknown;
+		}
+
+		cache.add_pairs(g, pairs);
+
+		const rainbow_checker checker(g, k, pairs, strong, &cache);
+		const edge_path_index paths(checker);
+		rainbow_solver solver(checker, paths, k);
+		solver.add_distinct(distinct);
+		solver.set_phase(phase);
+
+		++stats.rounds;
+
+		std::vector<index_t> candidate;
+		const solve_status status = solver.solve(candidate, remaining);
+
+		if (status != solve_status::satisfiable)
+			return status;
+
+		const auto violations = find_violations(g, candidate, strong);
+
+		if (violations.empty())
+		{
+			colours = candidate;
+			return solve_status::satisfiable;
+		}
+
+		phase = candidate;
+
+		// Both lists are in next_pair order.
+		std::vector<std::pair<index_t, index_t>> merged;
+		std::merge(pairs.begin(), pairs.end(), violations.begin(), violations.end(), std::back_inserter(merged));
+		merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+		pairs.swap(merged);
+	}
+}
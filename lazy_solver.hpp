@@ -0,0 +1,38 @@
+// lazy_solver.hpp
+#ifndef LAZY_SOLVER_HPP
+#define LAZY_SOLVER_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path_source.hpp"
+#include "rainbow_solver.hpp"
+#include <vector>
+
+struct lazy_statistics
+{
+	// Solver calls made.
+	index_t rounds = 0;
+
+	// Pairs whose paths were enumerated, out of all non-adjacent pairs. Each
+	// pair is enumerated once and its paths kept for the later rounds.
+	index_t pairs = 0;
+	index_t total_pairs = 0;
+
+	// Path searches run (one DFS per source vertex and round without a
+	// path_source, one call per pair with one) and the paths they found.
+	index_t searches = 0;
+	index_t paths = 0;
+};
+
+// Decides whether g has a rainbow colouring with k colours (strong: rainbow
+// geodesics) without enumerating the paths of every pair up front. The
+// rainbow_solver starts with the bridges pairwise distinct and only the pairs
+// at distance k - 1 or more; each colouring it finds is checked against all
+// pairs with find_violations, and the violated pairs are added with their
+// paths before solving again; only the new pairs are searched for. A subset
+// of the pairs without a solution proves there is none. The colouring is left
+// in colours (one colour per edge id) if satisfiable; time_limit (seconds, 0
+// for none) covers all rounds.
+solve_status solve_rainbow_lazy(const graph& g, index_t k, std::vector<index_t>& colours, bool strong = false, double time_limit = 0, path_source* source = nullptr, lazy_statistics* statistics = nullptr);
+
+#endif
@@ -0,0 +1,336 @@
+// local_search.cpp
+#include "local_search.hpp"
+
+#include "edge_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace
+{
+	// The violated pairs of a zdd_checker under a colouring that changes one
+	// edge at a time, with the interface of rainbow_state. Recolouring e
+	// checks again the pairs whose ZDDs hold e.
+	class zdd_state
+	{
+	public:
+		zdd_state(const zdd_checker& checker, const std::vector<std::vector<index_t>>& edge_pairs, const std::vector<index_t>& colours)
+			: checker_(checker), edge_pairs_(edge_pairs), colours_(colours), satisfied_(checker.num_pairs()), position_(checker.num_pairs(), -1)
+		{
+			for (index_t i = 0; i < checker_.num_pairs(); ++i)
+				mark(i, checker_.is_satisfied(i, colours_));
+		}
+
+		void recolour(index_t e, index_t colour)
+		{
+			colours_[e] = colour;
+
+			for (auto i : edge_pairs_[e])
+				mark(i, checker_.is_satisfied(i, colours_));
+		}
+
+		index_t delta(index_t e, index_t colour)
+		{
+			const index_t old = colours_[e];
+			index_t d = 0;
+			colours_[e] = colour;
+
+			for (auto i : edge_pairs_[e])
+				d += static_cast<index_t>(satisfied_[i]) - static_cast<index_t>(checker_.is_satisfied(i, colours_));
+
+			colours_[e] = old;
+			return d;
+		}
+
+		index_t colour(index_t e) const { return colours_[e]; }
+		const std::vector<index_t>& get_colours() const { return colours_; }
+
+		const std::vector<index_t>& get_violated() const { return violated_; }
+		index_t num_violations() const { return violated_.size(); }
+
+	private:
+		void mark(index_t i, bool satisfied)
+		{
+			satisfied_[i] = satisfied;
+
+			if (satisfied && position_[i] != -1)
+			{
+				// Swap with the last violated pair.
+				const index_t last = violated_.back();
+				violated_[position_[i]] = last;
+				position_[last] = position_[i];
+				violated_.pop_back();
+				position_[i] = -1;
+			}
+			else if (!satisfied && position_[i] == -1)
+			{
+				position_[i] = violated_.size();
+				violated_.emplace_back(i);
+			}
+		}
+
+		const zdd_checker& checker_;
+		const std::vector<std::vector<index_t>>& edge_pairs_;
+		std::vector<index_t> colours_;
+		std::vector<char> satisfied_;
+		std::vector<index_t> violated_;
+		std::vector<index_t> position_;
+	};
+
+	// Random colours 1..k unless colours has one colour per edge.
+	void initial_colouring(std::vector<index_t>& colours, index_t m, index_t k, std::mt19937_64& gen)
+	{
+		if (static_cast<index_t>(colours.size()) == m)
+			return;
+
+		std::uniform_int_distribution<index_t> colour(1, k);
+
+		colours.resize(m);
+		for (auto& c : colours)
+			c = colour(gen);
+	}
+
+	// The tabu search of local_search::solve over either kind of state. Leaves
+	// the best colouring in best and returns its number of violated pairs.
+	template <typename State>
+	index_t tabu_search(State& state, const std::vector<std::vector<index_t>>& pair_edges, index_t m, index_t k, const local_search_options& options, std::mt19937_64& gen, std::vector<index_t>& best, index_t& iterations)
+	{
+		const std::vector<index_t>& violated = state.get_violated();
+		iterations = 0;
+
+		best = state.get_colours();
+		index_t best_violations = state.num_violations();
+
+		std::vector<index_t> tabu_until(m * k, 0);
+		const auto start = std::chrono::steady_clock::now();
+
+		while (!violated.empty() && iterations < options.max_iterations)
+		{
+			if ((iterations & 255) == 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > options.time_limit)
+				break;
+
+			++iterations;
+
+			const index_t pair = violated[std::uniform_int_distribution<index_t>(0, violated.size() - 1)(gen)];
+			const std::vector<index_t>& edges = pair_edges[pair];
+			const index_t candidates = std::min<index_t>(options.max_candidates, edges.size());
+			const index_t current = state.num_violations();
+
+			index_t move_edge = -1;
+			index_t move_colour = 0;
+			index_t move_delta = std::numeric_limits<index_t>::max();
+			index_t ties = 0;
+
+			for (index_t i = 0; i < candidates; ++i)
+			{
+				const index_t e = (candidates == static_cast<index_t>(edges.size())) ? edges[i] : edges[std::uniform_int_distribution<index_t>(0, edges.size() - 1)(gen)];
+
+				for (index_t c = 1; c <= k; ++c)
+				{
+					if (c == state.colour(e))
+						continue;
+
+					const index_t d = state.delta(e, c);
+
+					// Tabu moves are allowed only if they beat the best colouring.
+					if (tabu_until[e * k + c - 1] > iterations && current + d >= best_violations)
+						continue;
+
+					if (d < move_delta)
+					{
+						move_edge = e;
+						move_colour = c;
+						move_delta = d;
+						ties = 1;
+					}
+					else if (d == move_delta && std::uniform_int_distribution<index_t>(0, ties++)(gen) == 0)
+					{
+						move_edge = e;
+						move_colour = c;
+					}
+				}
+			}
+
+			// Everything is tabu: take a random move.
+			if (move_edge == -1)
+			{
+				move_edge = edges[std::uniform_int_distribution<index_t>(0, edges.size() - 1)(gen)];
+				move_colour = std::uniform_int_distribution<index_t>(1, k)(gen);
+
+				if (k == 1 || move_colour == state.colour(move_edge))
+					continue;
+			}
+
+			const index_t old = state.colour(move_edge);
+			state.recolour(move_edge, move_colour);
+			tabu_until[move_edge * k + old - 1] = iterations + options.tabu_tenure + std::uniform_int_distribution<index_t>(0, options.tabu_tenure)(gen);
+
+			if (state.num_violations() < best_violations)
+			{
+				best = state.get_colours();
+				best_violations = state.num_violations();
+			}
+		}
+
+		return best_violations;
+	}
+}
+
+local_search::local_search(const graph& g, index_t k, bool strong, path_source* source)
+	: k_(k), checker_(g, k, strong, source), index_(checker_), pair_edges_(checker_.num_pairs()),
+	best_violations_(0), iterations_(0)
+{
+	assert(k >= 1 && k <= 64);
+
+	std::vector<char> seen(index_.num_edges());
+
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		const path_matrix& paths = checker_.get_paths(i);
+		std::fill(seen.begin(), seen.end(), 0);
+
+		for (index_t p = 0; p < paths.num_paths(); ++p)
+		{
+			for (index_t j = 0; j < paths.length(p); ++j)
+			{
+				const index_t e = paths.edge(p, j);
+
+				if (!seen[e])
+				{
+					seen[e] = 1;
+					pair_edges_[i].emplace_back(e);
+				}
+			}
+		}
+	}
+}
+
+bool local_search::solve(std::vector<index_t>& colours, const local_search_options& options)
+{
+	std::mt19937_64 gen(options.seed);
+	const index_t m = index_.num_edges();
+	initial_colouring(colours, m, k_, gen);
+
+	rainbow_state state(checker_, index_, colours);
+
+	// Pairs with no path of at most k edges can never be satisfied.
+	index_t hopeless = 0;
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		if (checker_.get_paths(i).num_paths() == 0)
+			++hopeless;
+	}
+
+	std::vector<index_t> best = colours;
+	best_violations_ = state.num_violations();
+	iterations_ = 0;
+
+	if (hopeless == 0)
+		best_violations_ = tabu_search(state, pair_edges_, m, k_, options, gen, best, iterations_);
+
+	best_violations_ += hopeless;
+	colours = best;
+
+	return best_violations_ == 0;
+}
+
+zdd_local_search::zdd_local_search(const graph& g, index_t k, bool strong)
+	: k_(k), checker_(g, k, strong), pair_edges_(checker_.num_pairs()), edge_pairs_(g.num_edges()),
+	best_violations_(0), iterations_(0)
+{
+	assert(k >= 1 && k <= 63);
+
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		pair_edges_[i] = checker_.get_elements(i);
+
+		for (auto e : pair_edges_[i])
+			edge_pairs_[e].emplace_back(i);
+	}
+}
+
+bool zdd_local_search::solve(std::vector<index_t>& colours, const local_search_options& options)
+{
+	std::mt19937_64 gen(options.seed);
+	const index_t m = edge_pairs_.size();
+	initial_colouring(colours, m, k_, gen);
+
+	zdd_state state(checker_, edge_pairs_, colours);
+
+	// Pairs with no path of at most k edges can never be satisfied.
+	index_t hopeless = 0;
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		if (checker_.get_zdd(i).get_root() == zdd::EMPTY)
+			++hopeless;
+	}
+
+	std::vector<index_t> best = colours;
+	best_violations_ = state.num_violations();
+	iterations_ = 0;
+
+	if (hopeless == 0)
+		best_violations_ = tabu_search(state, pair_edges_, m, k_, options, gen, best, iterations_);
+
+	best_violations_ += hopeless;
+	colours = best;
+
+	return best_violations_ == 0;
+}
+
+index_t local_search_upper_bound(const graph& g, std::vector<index_t>& colours, bool strong, const local_search_options& options)
+{
+	assert(is_connected(g));
+
+	const index_t n = g.num_vertices();
+	const index_t m = g.num_edges();
+	const index_t bridges = get_bridges(g).size() / 2;
+
+	// rc(G) <= n - 1 by colouring a spanning tree; src(G) <= m.
+	const index_t upper = strong ? m : n - 1;
+
+	for (index_t k = std::max(std::max(get_diameter(g), bridges), index_t(1)); k < upper && k <= 64; ++k)
+	{
+		local_search search(g, k, strong);
+		std::vector<index_t> candidate;
+
+		if (search.solve(candidate, options))
+		{
+			colours = candidate;
+			return k;
+		}
+	}
+
+	colours.assign(m, 1);
+
+	if (strong)
+	{
+		std::iota(colours.begin(), colours.end(), 1);
+		return m;
+	}
+
+	// Distinct colours on the edges of a BFS tree from vertex 0.
+	const edge_index index(g);
+	std::uint64_t visited = 1;
+	std::vector<index_t> queue(1, 0);
+	index_t next = 1;
+
+	for (std::size_t i = 0; i < queue.size(); ++i)
+	{
+		const index_t v = queue[i];
+
+		for (std::uint64_t x = g.adj_[v] & ~visited; x != 0; x &= x - 1)
+		{
+			const index_t w = ctz64(x);
+			visited |= (1ULL << w);
+			queue.emplace_back(w);
+			colours[index.id(v, w)] = next++;
+		}
+	}
+
+	return n - 1;
+}
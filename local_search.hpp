@@ -0,0 +1,99 @@
+// local_search.hpp
+#ifndef LOCAL_SEARCH_HPP
+#define LOCAL_SEARCH_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path_source.hpp"
+#include "path_index.hpp"
+#include "path_zdd.hpp"
+#include "rainbow_kernel.hpp"
+#include <cstdint>
+#include <vector>
+
+struct local_search_options
+{
+	std::uint64_t seed = 1;
+
+	// Budget of one solve() call.
+	index_t max_iterations = 1000000;
+	double time_limit = 10.0;
+
+	// A recoloured edge may not get its old colour back for tenure plus a
+	// random 0..tenure moves.
+	index_t tabu_tenure = 10;
+
+	// Edges of the chosen violated pair considered per move.
+	index_t max_candidates = 32;
+};
+
+// Tabu search over edge colourings with colours 1..k, minimising the number
+// of non-adjacent pairs without a rainbow path (geodesic if strong). Each
+// move recolours one edge on the paths of a violated pair; moves are scored
+// on the paths through that edge only, with a rainbow_state.
+class local_search
+{
+public:
+	local_search(const graph& g, index_t k, bool strong = false, path_source* source = nullptr);
+
+	// Starts from colours if it has one colour per edge id and from a random
+	// colouring otherwise; leaves the best colouring found in colours. True if
+	// it is a rainbow colouring.
+	bool solve(std::vector<index_t>& colours, const local_search_options& options = local_search_options());
+
+	// Violated pairs of the best colouring of the last solve().
+	index_t get_violations() const { return best_violations_; }
+	index_t get_iterations() const { return iterations_; }
+
+	const rainbow_checker& get_checker() const { return checker_; }
+
+private:
+	index_t k_;
+	rainbow_checker checker_;
+	edge_path_index index_;
+
+	// The distinct edges on the paths of each pair.
+	std::vector<std::vector<index_t>> pair_edges_;
+
+	index_t best_violations_;
+	index_t iterations_;
+};
+
+// The same tabu search over a zdd_checker, for graphs whose pairs have too
+// many paths to list: a move is scored by checking again, with
+// zdd::any_rainbow, the pairs whose ZDDs hold the recoloured edge. Slower per
+// move than local_search, but memory follows the ZDD sizes rather than the
+// path counts. Colours go up to 63.
+class zdd_local_search
+{
+public:
+	zdd_local_search(const graph& g, index_t k, bool strong = false);
+
+	// As local_search::solve.
+	bool solve(std::vector<index_t>& colours, const local_search_options& options = local_search_options());
+
+	index_t get_violations() const { return best_violations_; }
+	index_t get_iterations() const { return iterations_; }
+
+	const zdd_checker& get_checker() const { return checker_; }
+
+private:
+	index_t k_;
+	zdd_checker checker_;
+
+	// The edges on the paths of each pair, and the pairs with paths through
+	// each edge.
+	std::vector<std::vector<index_t>> pair_edges_;
+	std::vector<std::vector<index_t>> edge_pairs_;
+
+	index_t best_violations_;
+	index_t iterations_;
+};
+
+// Upper bound on rc(G) (src(G) if strong): tries k upwards from
+// max(diam(G), #bridges) and returns the first k for which local search finds
+// a rainbow colouring, which is left in colours. Every k gets the full budget
+// of the options.
+index_t local_search_upper_bound(const graph& g, std::vector<index_t>& colours, bool strong = false, const local_search_options& options = local_search_options());
+
+#endif
@@ -7,6 +7,7 @@
 #include "model_writer.hpp"
 #include "strong_model_writer.hpp"
 #include "minion_model_writer.hpp"
+#include "result_memo.hpp"
 
 #include <iostream>
 #include <bitset>
@@ -79,11 +80,17 @@ int main()
 	//graph g = build_star(n);
 	//create_rainbow_polynomial_points(g);
 
+	// Isomorphic graphs in a sweep are counted once.
+	result_memo memo;
+
 	for (index_t i = 3; i <= 9; ++i)
 	{
 		graph g = build_cycle(i);
 		std::cerr << "sc" << i << " = ";
-		auto sols = polynomial_points<strong_minion_model_writer>(g);
+
+		auto& sols = memo[g].strong_polynomial;
+		if (sols.empty())
+			sols = polynomial_points<strong_minion_model_writer>(g);
 
 		std::cerr << "\nInterpolatingPolynomial[{";
 		for (index_t i = 0; i < sols.size(); ++i)
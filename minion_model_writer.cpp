@@ -2,15 +2,28 @@
 #include "minion_model_writer.hpp"
 
 #include "graph.hpp"
+#include "edge_index.hpp"
+#include "symmetry.hpp"
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <vector>
 #include <sstream>
 #include <chrono>
+#include <numeric>
+#include <stdexcept>
 
 namespace
 {
+	const std::string NEQ_PREFIX = "d";
+	const std::string MAX_PREFIX = "m";
+
+	void add_minion_edge_name(const edge_index& edges, index_t e, std::ostream& os)
+	{
+		auto ends = edges.endpoints(e);
+		os << VAR_PREFIX << ends.first << "_" << ends.second;
+	}
+
 	void add_minion_alldiff(const std::vector<index_t>& edges, std::ostream& os)
 	{
 		os << "alldiff([";
@@ -30,36 +43,310 @@ namespace
 	{
 		add_minion_alldiff(to_edge_list(p), os);
 	}
+
+	void add_minion_variable_list(const std::vector<index_t>& edges, std::ostream& os)
+	{
+		os << "[";
+
+		for (auto it = edges.cbegin(); it != edges.cend(); it += 2)
+		{
+			os << VAR_PREFIX << *(it) << "_" << *(it + 1);
+
+			if (it != (edges.cend() - 2))
+				os << ",";
+		}
+
+		os << "]";
+	}
+
+	// The edge variables in the order add_minion_variables declares them,
+	// which is the order read_minion_solutions reads them back in.
+	void add_minion_print(const graph& g, std::ostream& os)
+	{
+		const index_t n = g.num_vertices();
+		bool first = true;
+
+		os << "PRINT [[";
+
+		for (index_t i = 0; i < n; ++i)
+		{
+			for (index_t j = i + 1; j < n; ++j)
+			{
+				if (!is_adjacent(g, i, j))
+					continue;
+
+				os << (first ? "" : ",") << VAR_PREFIX << i << "_" << j;
+				first = false;
+			}
+		}
+
+		os << "]]\n";
+	}
+
+	void add_minion_lex_leader(const graph& g, const std::vector<std::vector<index_t>>& generators, std::ostream& os)
+	{
+		const edge_index edges(g);
+		const auto perms = to_edge_permutations(edges, generators);
+
+		std::vector<index_t> identity(edges.size());
+		std::iota(identity.begin(), identity.end(), 0);
+
+		for (const auto& perm : perms)
+		{
+			if (perm == identity)
+				continue;
+
+			os << "lexleq(";
+			add_minion_variable_list(edges.to_edge_list(identity), os);
+			os << ", ";
+			add_minion_variable_list(edges.to_edge_list(perm), os);
+			os << ")\n";
+		}
+	}
+}
+
+std::ostream& minion_model_writer::get_constraint_stream()
+{
+	if (get_path_encoding() != path_encoding::disequality)
+		return get_output_stream();
+
+	constraints_.set_budget(get_memory_budget());
+	return constraints_.stream();
+}
+
+void minion_model_writer::add_minion_path_term(const edge_path& p, std::ostream& os)
+{
+	if (get_path_encoding() == path_encoding::alldiff)
+	{
+		add_minion_alldiff(p, os);
+		return;
+	}
+
+	std::vector<index_t> created;
+	const auto literals = get_disequalities().get_path_literals(p, created);
+
+	os << "watched-and({";
+
+	for (std::size_t i = 0; i < literals.size(); ++i)
+		os << (i == 0 ? "" : ",") << "w-literal(" << NEQ_PREFIX << literals[i] << ",1)";
+
+	os << "})";
+}
+
+void minion_model_writer::impl_add_comment(const std::string& text)
+{
+	get_constraint_stream() << get_comment() << " " << text << "\n";
 }
 
 void minion_model_writer::impl_preprocess()
 {
 	auto& os = get_output_stream();
 
+	if (get_path_encoding() == path_encoding::zdd)
+		throw std::runtime_error("The zdd path encoding is written by the MiniZinc writers only");
+
 	os << "MINION 3\n\n";
 	os << "**VARIABLES**\n\n";
 
 	add_minion_variables(get_graph(), get_solution_size(), os);
 
+	// m<i> is the largest colour among the first i + 1 edges of the value
+	// order; the first edge stands in for m0 and the last needs none.
+	if (get_value_symmetry() != value_symmetry::none)
+	{
+		for (index_t i = 1; i + 1 < get_graph().num_edges(); ++i)
+			os << "DISCRETE " << MAX_PREFIX << i << " {1.." << get_solution_size() << "}\n";
+	}
+
+	// The literals are only known once every pair is written, and Minion
+	// wants them declared first, so the constraints wait in constraints_.
+	if (get_path_encoding() == path_encoding::disequality)
+		return;
+
 	os << "\n**CONSTRAINTS**\n\n";
 }
 
 void minion_model_writer::impl_postprocess()
 {
 	auto& os = get_output_stream();
+
+	if (get_path_encoding() == path_encoding::disequality)
+	{
+		disequality_table& literals = get_disequalities();
+		const edge_index& edges = literals.get_edge_index();
+
+		for (index_t d = 0; d < literals.size(); ++d)
+			os << "BOOL " << NEQ_PREFIX << d << "\n";
+
+		os << "\n**CONSTRAINTS**\n\n";
+
+		// Literals only occur positively, so d -> e != f is enough.
+		for (index_t d = 0; d < literals.size(); ++d)
+		{
+			const auto pair = literals.get_edges(d);
+
+			os << "reifyimply(diseq(";
+			add_minion_edge_name(edges, pair.first, os);
+			os << ",";
+			add_minion_edge_name(edges, pair.second, os);
+			os << ")," << NEQ_PREFIX << d << ")\n";
+		}
+
+		constraints_.copy_to(os);
+	}
+
+	if (get_forced_distinct() != nullptr)
+	{
+		os << get_comment() << " Forced distinct edges\n";
+
+		for (const auto& clique : get_forced_cliques())
+		{
+			add_minion_alldiff(clique, os);
+			os << "\n";
+		}
+	}
+	else if (has_kernel() && get_bridges(get_graph()).size() >= 4)
+	{
+		// The pairs inside pendant trees were left out.
+		os << get_comment() << " Bridges\n";
+		add_minion_alldiff(get_bridges(get_graph()), os);
+		os << "\n";
+	}
+
+	if (!get_edge_symmetries().empty())
+	{
+		os << get_comment() << " Edge symmetries\n";
+		add_minion_lex_leader(get_graph(), get_edge_symmetries(), os);
+	}
+
+	if (get_value_symmetry() != value_symmetry::none && get_graph().num_edges() != 0)
+	{
+		const edge_index edges(get_graph());
+		index_t pinned = 0;
+		const auto order = get_value_order(pinned);
+
+		os << get_comment() << " Value symmetry\n";
+
+		for (index_t i = 0; i < pinned; ++i)
+		{
+			os << "eq(";
+			add_minion_edge_name(edges, order[i], os);
+			os << "," << i + 1 << ")\n";
+		}
+
+		// Restricted growth: the first edge gets colour 1 (as a pinned edge
+		// already does) and every other is at most one above the maximum
+		// before it.
+		if (pinned == 0)
+		{
+			os << "eq(";
+			add_minion_edge_name(edges, order[0], os);
+			os << ",1)\n";
+		}
+
+		for (std::size_t i = 1; i < order.size(); ++i)
+		{
+			std::ostringstream previous;
+
+			if (i == 1)
+				add_minion_edge_name(edges, order[0], previous);
+			else
+				previous << MAX_PREFIX << i - 1;
+
+			os << "ineq(";
+			add_minion_edge_name(edges, order[i], os);
+			os << "," << previous.str() << ",1)\n";
+
+			if (i + 1 < order.size())
+			{
+				os << "max([" << previous.str() << ",";
+				add_minion_edge_name(edges, order[i], os);
+				os << "]," << MAX_PREFIX << i << ")\n";
+			}
+		}
+	}
+
+	// Minion prints every variable unless told otherwise, and solutions with
+	// the auxiliary ones in them no longer read back as edge colours.
+	const bool auxiliary = (get_value_symmetry() != value_symmetry::none && get_graph().num_edges() > 2) ||
+		(get_path_encoding() == path_encoding::disequality && get_disequalities().size() != 0);
+
+	if ((has_search_order() || auxiliary) && get_graph().num_edges() != 0)
+	{
+		const edge_index edges(get_graph());
+		const index_t m = get_graph().num_edges();
+
+		os << "\n**SEARCH**\n\n";
+
+		// Branch on the edges first; the auxiliary variables follow from them.
+		if (has_search_order())
+		{
+			os << "VARORDER [";
+
+			bool first = true;
+			for (auto e : get_branching_order())
+			{
+				os << (first ? "" : ",");
+				add_minion_edge_name(edges, e, os);
+				first = false;
+			}
+
+			if (get_value_symmetry() != value_symmetry::none)
+			{
+				for (index_t i = 1; i + 1 < m; ++i)
+					os << "," << MAX_PREFIX << i;
+			}
+
+			if (get_path_encoding() == path_encoding::disequality)
+			{
+				for (index_t d = 0; d < get_disequalities().size(); ++d)
+					os << "," << NEQ_PREFIX << d;
+			}
+
+			os << "]\n";
+		}
+
+		if (auxiliary)
+			add_minion_print(get_graph(), os);
+	}
+
 	os << "\n**EOF**\n";
 }
 
 void minion_model_writer::impl_process_vertex_pair(index_t u, index_t v)
 {
-	auto& os = get_output_stream();
+	auto& os = get_constraint_stream();
 
 	os << get_comment() << u << " " << v << "\n";
-	std::vector<edge_path> paths;
+
 	// No path pruning: generate paths of all lengths.
 	// It is up to the user to make sure this is sensible.
 	// For example, if k < diam(G), the instance is trivially UNSAT.
-	list_paths(get_graph(), u, v, paths, std::numeric_limits<index_t>::max());
+	if (has_memory_budget())
+	{
+		path_spool spool(get_memory_budget(), get_rss_limit());
+		spool_pair_paths(u, v, spool, std::numeric_limits<index_t>::max());
+
+		os << "watched-or({";
+
+		bool first = true;
+		spool.for_each([&](const edge_path& p)
+		{
+			if (!first)
+				os << ", ";
+
+			add_minion_path_term(p, os);
+			first = false;
+		});
+
+		os << "})\n";
+
+		add_pair_statistics(u, v, spool);
+		return;
+	}
+
+	std::vector<edge_path> paths;
+	list_pair_paths(u, v, paths, std::numeric_limits<index_t>::max());
 
 	// MINION can't handle empty constraints such as "watched-or({ })"
 	//if (paths.size() < 2)
@@ -71,7 +358,7 @@ void minion_model_writer::impl_process_vertex_pair(index_t u, index_t v)
 	{
 		//if (paths[j].size())
 
-		add_minion_alldiff(paths[j], os);
+		add_minion_path_term(paths[j], os);
 
 		if (j != paths.size() - 1)
 			os << ", ";
@@ -82,17 +369,17 @@ void minion_model_writer::impl_process_vertex_pair(index_t u, index_t v)
 
 void strong_minion_model_writer::impl_process_vertex_pair(index_t u, index_t v)
 {
-	auto& os = get_output_stream();
+	auto& os = get_constraint_stream();
 
 	os << get_comment() << u << " " << v << "\n";
 	std::vector<edge_path> paths;
-	list_shortest_paths(get_graph(), u, v, paths);
+	list_pair_shortest_paths(u, v, paths);
 
 	os << "watched-or({";
 
 	for (index_t j = 0; j < paths.size(); ++j)
 	{
-		add_minion_alldiff(paths[j], os);
+		add_minion_path_term(paths[j], os);
 
 		if (j != paths.size() - 1)
 			os << ", ";
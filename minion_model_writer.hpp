@@ -3,6 +3,8 @@
 #define MINION_MODEL_WRITER_HPP
 
 #include "model_writer.hpp"
+#include "path_spool.hpp"
+#include "solver_runner.hpp"
 #include <vector>
 #include <string>
 #include <sstream>
@@ -19,11 +21,23 @@ public:
 
 	virtual ~minion_model_writer() { }
 
+protected:
+	// Where the constraints go: the output, or a buffer under the
+	// disequality encoding. Under a memory budget the buffer is moved to a
+	// temporary file whenever it has grown past the budget.
+	std::ostream& get_constraint_stream();
+
+	void add_minion_path_term(const edge_path& p, std::ostream& os);
+
 private:
 	virtual void impl_preprocess();
 	virtual void impl_postprocess();
 
 	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual void impl_add_comment(const std::string& text);
+
+	text_spool constraints_;
 };
 
 class strong_minion_model_writer : public minion_model_writer
@@ -37,6 +51,8 @@ public:
 
 private:
 	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual bool impl_shortest_paths() const { return true; }
 };
 
 namespace
@@ -59,64 +75,63 @@ namespace
 	}
 }
 
+// The default command for polynomial_points: Minion counting every solution,
+// reading /dev/stdin where there is one and otherwise a model file named
+// after it.
+inline std::vector<std::string> minion_count_command()
+{
+#if defined(_MSC_VER)
+	return { "minion", "-findallsols", "-noprintsols" };
+#else
+	return { "minion", "-findallsols", "-noprintsols", "/dev/stdin" };
+#endif
+}
+
+// Number of colourings with i colours for every i from 1 to m, counted by
+// Minion. The paths are found once and the model is sent to the solver with
+// the domains changed, either streamed into its standard input or written to
+// a temporary file whose name is added to the end of command.
 template <typename ModelWriter>
-std::vector<index_t> polynomial_points(const graph& g)
+std::vector<index_t> polynomial_points(const graph& g, const std::vector<std::string>& command = minion_count_command(),
+	model_input input = default_model_input())
 {
-	const std::string filename = "temp_poly.txt";
+	std::ostringstream model;
+	ModelWriter writer(g, 1, model);
+	writer.write();
 
-	// Find paths only once, then modify the file in-place.
-	std::ofstream ofs(filename);
+	const std::string text = model.str();
+	const std::string body = text.substr(text.find("**CONSTRAINTS**"));
 
-	//auto start = std::chrono::high_resolution_clock::now();
-	ModelWriter writer(g, 1, ofs);
-	writer.write();
-	//auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+	auto write_model = [&](index_t k, std::ostream& os)
+	{
+		os << "MINION 3\n\n";
+		os << "**VARIABLES**\n\n";
+
+		add_minion_variables(g, k, os);
+		os << "\n" << body;
+	};
 
-	ofs.close();
 	const index_t m = g.num_edges();
 	std::vector<index_t> sols;
 
 	for (index_t i = 1; i <= m; ++i)
 	{
-		std::fstream ifs(filename);
-		ifs << "MINION 3\n\n";
-		ifs << "**VARIABLES**\n\n";
-
-		add_minion_variables(g, i, ifs);
-		ifs << "\n**CONSTRAINTS**\n#";
-		ifs.close();
-
-		const std::string outfile = "out_" + std::to_string(i) + ".txt";
-		const std::string exec = "minion -findallsols -noprintsols " + filename + " > " + outfile;
-
-		//auto start = std::chrono::high_resolution_clock::now();
-		system(exec.c_str());
-		//auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
-		//std::cerr << "Point " << i << " evaluated in " << (duration.count() / 1000.0) << " s\n";
-
-		// Parse solution count
-		std::ifstream reader(outfile);
-		std::string line = "";
-		while (std::getline(reader, line))
+		if (input == model_input::file)
 		{
-			if (line.find("Solutions Found:") != std::string::npos)
-			{
-				index_t sol_count = -1;
-				std::istringstream ss(line);
+			temp_model_file file;
+			write_model(i, file.get_stream());
 
-				ss >> std::string() >> std::string() >> sol_count;
-				sols.emplace_back(sol_count);
-			}
+			solver_runner runner(file.get_command(command), solver_dialect::minion);
+			sols.emplace_back(runner.finish().solutions);
+		}
+		else
+		{
+			solver_runner runner(command, solver_dialect::minion);
+			write_model(i, runner.get_input_stream());
+			sols.emplace_back(runner.finish().solutions);
 		}
-
-		reader.close();
-		const std::string del = "del " + outfile;
-		system(del.c_str());
 	}
 
-	const std::string del = "del " + filename;
-	system(del.c_str());
-
 	return sols;
 }
 
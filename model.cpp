@@ -27,7 +27,7 @@ namespace
 			index_t adj = g.adj_[i];
 			for (index_t j = i; j < n; ++j)
 			{
-				if (adj & (1 << j))
+				if (adj & (1ULL << j))
 					os << VAR_DECL << i << "_" << j << ";\n";
 			}
 		}
@@ -42,7 +42,7 @@ namespace
 			index_t adj = g.adj_[i];
 			for (index_t j = i; j < n; ++j)
 			{
-				if (adj & (1 << j))
+				if (adj & (1ULL << j))
 					os << "DISCRETE " << VAR_PREFIX << i << "_" << j << " {1.." << k << "}\n";
 			}
 		}
@@ -3,15 +3,25 @@
 
 #include "graph.hpp"
 #include "path.hpp"
+#include "edge_index.hpp"
+#include "path_zdd.hpp"
+#include "rainbow_kernel.hpp"
+#include "search_order.hpp"
+#include "symmetry.hpp"
 
+#include <cassert>
 #include <string>
 #include <vector>
 #include <ostream>
+#include <numeric>
 
 namespace
 {
 	const std::string VAR_PREFIX = "x";
 	const std::string VAR_DECL = "var 1..k: " + VAR_PREFIX;
+	const std::string NEQ_PREFIX = "d";
+	const std::string NODE_PREFIX = "z";
+	const std::string TAKE_PREFIX = "h";
 
 	void add_vertex_variables(const graph& g, std::ostream& os)
 	{
@@ -32,12 +42,91 @@ namespace
 			index_t adj = g.adj_[i];
 			for (index_t j = i; j < n; ++j)
 			{
-				if (adj & (1 << j))
+				if (adj & (1ULL << j))
 					os << VAR_DECL << i << "_" << j << ";\n";
 			}
 		}
 	}
 
+	std::vector<std::string> get_edge_names(const graph& g)
+	{
+		const edge_index edges(g);
+		std::vector<std::string> names;
+
+		for (index_t e = 0; e < edges.size(); ++e)
+		{
+			const auto ends = edges.endpoints(e);
+			names.emplace_back(VAR_PREFIX + std::to_string(ends.first) + "_" + std::to_string(ends.second));
+		}
+
+		return names;
+	}
+
+	void add_variable_list(const std::vector<index_t>& edges, std::ostream& os)
+	{
+		os << "[";
+
+		for (auto it = edges.cbegin(); it != edges.cend(); it += 2)
+		{
+			os << VAR_PREFIX << *(it) << "_" << *(it + 1);
+
+			if (it != (edges.cend() - 2))
+				os << ",";
+		}
+
+		os << "]";
+	}
+
+	void add_lex_leader(const graph& g, const std::vector<std::vector<index_t>>& generators, std::ostream& os)
+	{
+		const edge_index edges(g);
+		const auto perms = to_edge_permutations(edges, generators);
+
+		std::vector<index_t> identity(edges.size());
+		std::iota(identity.begin(), identity.end(), 0);
+
+		os << "include \"lex_lesseq.mzn\";\n";
+
+		for (const auto& perm : perms)
+		{
+			if (perm == identity)
+				continue;
+
+			os << "constraint lex_lesseq(";
+			add_variable_list(edges.to_edge_list(identity), os);
+			os << ", ";
+			add_variable_list(edges.to_edge_list(perm), os);
+			os << ");\n";
+		}
+	}
+
+	void add_int_search(const graph& g, const std::vector<index_t>& order, std::ostream& os)
+	{
+		const edge_index edges(g);
+
+		os << " :: int_search(";
+		add_variable_list(edges.to_edge_list(order), os);
+		os << ", input_order, indomain_min)";
+	}
+
+	void add_warm_start(const graph& g, const std::vector<index_t>& colours, std::ostream& os)
+	{
+		const edge_index edges(g);
+		assert(static_cast<index_t>(colours.size()) == edges.size());
+
+		std::vector<index_t> ids(edges.size());
+		std::iota(ids.begin(), ids.end(), 0);
+
+		os << " :: warm_start(";
+		add_variable_list(edges.to_edge_list(ids), os);
+		os << ", [";
+
+		for (std::size_t e = 0; e < colours.size(); ++e)
+			os << (e == 0 ? "" : ",") << colours[e];
+
+		os << "])";
+	}
+
 	void add_path_constraints(const graph& g, index_t k, std::ostream& os)
 	{
 		index_t u = 0;
@@ -81,6 +170,8 @@ void prepare_model(index_t k, std::ostream& os)
 
 void model_writer::write()
 {
+	disequalities_.reset();
+
 	impl_preprocess();
 	impl_process();
 	impl_postprocess();
@@ -91,6 +182,71 @@ void model_writer::add_line(const std::string& line)
 	os_ << line << "\n";
 }
 
+void model_writer::add_comment(const std::string& text)
+{
+	impl_add_comment(text);
+}
+
+void model_writer::list_pair_paths(index_t u, index_t v, std::vector<edge_path>& paths, index_t length) const
+{
+	if (source_ != nullptr)
+		source_->get_paths(g_, u, v, paths, length);
+	else if (kernel_enabled_)
+		kernel_source_.get_paths(g_, u, v, paths, length);
+	else
+		single_source_.get_paths(g_, u, v, paths, length);
+}
+
+void model_writer::list_pair_shortest_paths(index_t u, index_t v, std::vector<edge_path>& paths) const
+{
+	if (source_ != nullptr)
+		source_->get_shortest_paths(g_, u, v, paths);
+	else if (kernel_enabled_)
+		kernel_source_.get_shortest_paths(g_, u, v, paths);
+	else
+		single_source_.get_shortest_paths(g_, u, v, paths);
+}
+
+void model_writer::spool_pair_paths(index_t u, index_t v, path_spool& spool, index_t length) const
+{
+	if (source_ != nullptr || kernel_enabled_)
+	{
+		std::vector<edge_path> paths;
+		list_pair_paths(u, v, paths, length);
+
+		for (const auto& p : paths)
+			spool.add(p);
+
+		return;
+	}
+
+	auto add = [&spool](const edge_path& p) { spool.add(p); };
+	visit_paths<edge_path>(g_, u, v, add, length);
+}
+
+void model_writer::add_pair_statistics(index_t u, index_t v, const path_spool& spool)
+{
+	statistics_.emplace_back(pair_statistics{ u, v, spool.size(), spool.peak_bytes(), spool.num_runs() });
+}
+
+std::vector<index_t> model_writer::get_bridge_ids() const
+{
+	return ::get_bridge_ids(g_);
+}
+
+std::vector<std::vector<index_t>> model_writer::get_forced_cliques() const
+{
+	assert(forced_ != nullptr);
+
+	const edge_index index(g_);
+	std::vector<std::vector<index_t>> cliques;
+
+	for (const auto& clique : forced_->get_cliques())
+		cliques.emplace_back(index.to_edge_list(clique));
+
+	return cliques;
+}
+
 void model_writer::impl_process()
 {
 	index_t u = 0;
@@ -98,22 +254,117 @@ void model_writer::impl_process()
 	const index_t n = g_.num_vertices();
 	const index_t pairs = nchoosek(n, 2);
 
-	os_ << comment_ << " Paths between vertex pairs\n";
+	forced_.reset();
+
+	if (forced_enabled_)
+		forced_.reset(new forced_distinct(impl_find_forced_distinct()));
+
+	add_comment("Paths between vertex pairs");
+
+	// Non-adjacent pairs come in the same order as in the checker.
+	index_t pair = 0;
 
 	for (index_t i = 0; i < pairs; ++i)
 	{
 		if (!is_adjacent(g_, u, v))
 		{
-			impl_process_vertex_pair(u, v);
+			if (forced_ != nullptr && forced_->is_satisfied(pair))
+				add_comment("Vertex pair " + std::to_string(u) + " " + std::to_string(v) + " satisfied by forced alldiffs");
+			else if (kernel_enabled_ && kernel_source_.get_kernel(g_).is_implied(u, v))
+				add_comment("Vertex pair " + std::to_string(u) + " " + std::to_string(v) + " implied by the kernel");
+			else
+				impl_process_vertex_pair(u, v);
+
+			++pair;
 		}
 
 		next_pair(u, v, n);
 	}
 }
 
+std::vector<index_t> model_writer::get_value_order(index_t& pinned)
+{
+	const index_t elements = impl_num_elements();
+	std::vector<index_t> order;
+
+	if (value_symmetry_ == value_symmetry::pin && symmetries_.empty())
+	{
+		order = impl_find_pinned();
+
+		// More than k of them is UNSAT anyway; the first k are enough.
+		if (static_cast<index_t>(order.size()) > k_)
+			order.resize(k_);
+	}
+
+	pinned = order.size();
+
+	std::vector<char> placed(elements, 0);
+
+	for (auto x : order)
+		placed[x] = 1;
+
+	for (index_t x = 0; x < elements; ++x)
+	{
+		if (!placed[x])
+			order.emplace_back(x);
+	}
+
+	return order;
+}
+
+std::vector<index_t> model_writer::impl_find_pinned() const
+{
+	if (forced_ != nullptr)
+		return forced_->get_cliques().empty() ? std::vector<index_t>() : forced_->get_cliques().front();
+
+	const forced_distinct facts = impl_find_forced_distinct();
+	return facts.get_cliques().empty() ? std::vector<index_t>() : facts.get_cliques().front();
+}
+
+void model_writer::add_value_symmetry(const std::vector<std::string>& names)
+{
+	if (value_symmetry_ == value_symmetry::none || names.empty())
+		return;
+
+	index_t pinned = 0;
+	const auto order = get_value_order(pinned);
+
+	os_ << "% Value symmetry\n";
+
+	for (index_t i = 0; i < pinned; ++i)
+		os_ << "constraint " << names[order[i]] << " = " << i + 1 << ";\n";
+
+	// Agrees with the pins, which come first.
+	os_ << "include \"value_precede_chain.mzn\";\n";
+	os_ << "constraint value_precede_chain([c | c in 1..k], [";
+
+	for (std::size_t i = 0; i < order.size(); ++i)
+		os_ << (i == 0 ? "" : ",") << names[order[i]];
+
+	os_ << "]);\n";
+}
+
+std::vector<index_t> model_writer::get_branching_order() const
+{
+	const rainbow_checker checker(g_, k_, impl_shortest_paths(), source_);
+	return get_search_order(checker, get_bridge_ids());
+}
+
+forced_distinct model_writer::impl_find_forced_distinct() const
+{
+	// Read off the paths of at most k edges. Longer paths cannot be rainbow
+	// with k colours, so the facts also hold for models that list them.
+	const rainbow_checker checker(g_, k_, impl_shortest_paths(), source_);
+	return forced_distinct(checker, get_bridge_ids());
+}
+
 void model_writer::impl_preprocess()
 {
 	prepare_model(k_, os_);
+
+	if (encoding_ == path_encoding::zdd)
+		os_ << "include \"alldifferent_except_0.mzn\";\n";
+
 	add_edge_variables(g_, os_);
 }
 
@@ -122,35 +373,220 @@ void model_writer::impl_postprocess()
 	// Bridges must get distinct colors.
 	auto bridges = get_bridges(g_);
 
-	// At least 2 bridges?
-	if (bridges.size() >= 4)
+	if (forced_ != nullptr)
 	{
+		// The bridges are among the forced edges.
+		os_ << "% Forced distinct edges\n";
+
+		for (const auto& clique : get_forced_cliques())
+		{
+			os_ << "constraint ( ";
+			add_alldiff(clique, os_);
+			os_ << ");\n";
+		}
+	}
+	else if (bridges.size() >= 4)
+	{
+		// At least 2 bridges.
 		os_ << "% Bridges\n";
 		os_ << "constraint ( ";
 		add_alldiff(bridges, os_);
 		os_ << ");\n";
 	}
 
-	os_ << "solve satisfy;";
+	if (!symmetries_.empty())
+	{
+		os_ << "% Edge symmetries\n";
+		add_lex_leader(g_, symmetries_, os_);
+	}
+
+	add_value_symmetry(get_edge_names(g_));
+
+	os_ << "solve";
+
+	if (search_enabled_ && g_.num_edges() != 0)
+		add_int_search(g_, get_branching_order(), os_);
+
+	if (!initial_.empty())
+		add_warm_start(g_, initial_, os_);
+
+	os_ << " satisfy;";
+}
+
+void model_writer::impl_add_comment(const std::string& text)
+{
+	os_ << comment_ << " " << text << "\n";
 }
 
 void model_writer::impl_process_vertex_pair(index_t u, index_t v)
 {
 	os_ << comment_ << " Vertex pair " << u << " " << v << "\n";
+
+	if (encoding_ == path_encoding::zdd)
+	{
+		add_zdd_pair(u, v, k_);
+		return;
+	}
+
+	std::vector<index_t> created;
+
+	if (has_memory_budget())
+	{
+		path_spool spool(budget_, rss_limit_);
+		spool_pair_paths(u, v, spool, k_);
+
+		os_ << "constraint ( ";
+
+		bool first = true;
+		spool.for_each([&](const edge_path& p)
+		{
+			if (!first)
+				os_ << "\\/ ";
+
+			add_path_term(p, created);
+			first = false;
+		});
+
+		os_ << ");\n";
+		add_disequality_literals(created);
+
+		add_pair_statistics(u, v, spool);
+		return;
+	}
+
 	std::vector<edge_path> paths;
-	list_paths(g_, u, v, paths, k_);
+	list_pair_paths(u, v, paths, k_);
 
 	os_ << "constraint ( ";
 
 	for (index_t j = 0; j < paths.size(); ++j)
 	{
-		add_alldiff(paths[j], os_);
+		add_path_term(paths[j], created);
 
 		if (j != paths.size() - 1)
 			os_ << "\\/ ";
 	}
 
 	os_ << ");\n";
+	add_disequality_literals(created);
+}
+
+disequality_table& model_writer::get_disequalities()
+{
+	if (disequalities_ == nullptr)
+		disequalities_.reset(new disequality_table(g_));
+
+	return *disequalities_;
+}
+
+void model_writer::add_path_term(const edge_path& p, std::vector<index_t>& created)
+{
+	if (encoding_ == path_encoding::alldiff)
+	{
+		add_alldiff(p, os_);
+		return;
+	}
+
+	const auto literals = get_disequalities().get_path_literals(p, created);
+
+	os_ << "(";
+
+	for (std::size_t i = 0; i < literals.size(); ++i)
+		os_ << (i == 0 ? "" : " /\\ ") << NEQ_PREFIX << literals[i];
+
+	os_ << ") ";
+}
+
+void model_writer::add_disequality_literals(const std::vector<index_t>& created)
+{
+	const edge_index& edges = get_disequalities().get_edge_index();
+
+	// MiniZinc does not mind a declaration after its first use.
+	for (auto d : created)
+	{
+		const auto pair = get_disequalities().get_edges(d);
+		const auto e = edges.endpoints(pair.first);
+		const auto f = edges.endpoints(pair.second);
+
+		os_ << "var bool: " << NEQ_PREFIX << d << " = (" << VAR_PREFIX << e.first << "_" << e.second
+			<< " != " << VAR_PREFIX << f.first << "_" << f.second << ");\n";
+	}
+}
+
+void model_writer::add_zdd_pair(index_t u, index_t v, index_t length)
+{
+	const zdd z = build_path_zdd(g_, u, v, length);
+	const std::vector<index_t> nodes = z.get_nodes();
+
+	// No path fits.
+	if (nodes.empty())
+	{
+		os_ << "constraint false;\n";
+		return;
+	}
+
+	const edge_index edges(g_);
+	const std::string pair = std::to_string(u) + "_" + std::to_string(v);
+
+	// Nodes are numbered 1.. in the arrays, children first.
+	std::vector<index_t> number(nodes.back() + 1, 0);
+	for (std::size_t i = 0; i < nodes.size(); ++i)
+		number[nodes[i]] = i + 1;
+
+	auto node = [&](index_t f) { return NODE_PREFIX + pair + "[" + std::to_string(number[f]) + "]"; };
+	auto take = [&](index_t f) { return TAKE_PREFIX + pair + "[" + std::to_string(number[f]) + "]"; };
+
+	os_ << "array[1.." << nodes.size() << "] of var bool: " << NODE_PREFIX << pair << ";\n";
+	os_ << "array[1.." << nodes.size() << "] of var bool: " << TAKE_PREFIX << pair << ";\n";
+	os_ << "constraint " << node(z.get_root()) << ";\n";
+
+	// The chosen path goes on to hi if it takes the edge, to lo if not, and
+	// never to the empty family.
+	std::vector<std::vector<index_t>> taken_at(edges.size());
+
+	for (auto f : nodes)
+	{
+		const index_t lo = z.get_lo(f);
+		const index_t hi = z.get_hi(f);
+
+		os_ << "constraint (" << take(f) << " -> " << node(f);
+
+		if (hi != zdd::BASE)
+			os_ << " /\\ " << node(hi);
+
+		os_ << ")";
+
+		if (lo == zdd::EMPTY)
+			os_ << " /\\ (" << node(f) << " -> " << take(f) << ")";
+		else if (lo != zdd::BASE)
+			os_ << " /\\ (" << node(f) << " -> " << take(f) << " \\/ " << node(lo) << ")";
+
+		os_ << ";\n";
+
+		taken_at[z.label(z.get_level(f))].emplace_back(f);
+	}
+
+	// An edge is taken at any of its nodes; the colours of the taken edges
+	// differ, the others count as 0.
+	os_ << "constraint alldifferent_except_0([";
+
+	bool first = true;
+	for (index_t e = 0; e < edges.size(); ++e)
+	{
+		if (taken_at[e].empty())
+			continue;
+
+		os_ << (first ? "" : ",") << "bool2int(";
+
+		for (std::size_t i = 0; i < taken_at[e].size(); ++i)
+			os_ << (i == 0 ? "" : " \\/ ") << take(taken_at[e][i]);
+
+		const auto ends = edges.endpoints(e);
+		os_ << ") * " << VAR_PREFIX << ends.first << "_" << ends.second;
+		first = false;
+	}
+
+	os_ << "]);\n";
 }
 
 void add_alldiff(const std::vector<index_t>& edges, std::ostream& os)
@@ -3,16 +3,57 @@
 #define MODEL_WRITER_HPP
 
 #include "common.hpp"
+#include "disequality.hpp"
+#include "forced_distinct.hpp"
 #include "graph.hpp"
+#include "graph_kernel.hpp"
 #include "path.hpp"
+#include "path_source.hpp"
+#include "path_spool.hpp"
+#include "single_source.hpp"
+#include <cstddef>
+#include <memory>
 #include <ostream>
 #include <string>
+#include <vector>
+
+// How the disjunction over the paths of a vertex pair is written.
+enum class path_encoding
+{
+	// One alldiff per path.
+	alldiff,
+
+	// One shared literal per edge pair for "e and f get different colours"
+	// (see disequality_table), and a path as the conjunction of its literals.
+	disequality,
+
+	// The ZDD of the paths (build_path_zdd) in place of the disjunction: per
+	// node a boolean for "the chosen path passes here" and one for "and takes
+	// the node's edge", with the edges taken pairwise distinct. The model
+	// grows with the ZDD rather than with the number of paths. The paths are
+	// read off the graph, whatever path source is set.
+	zdd
+};
+
+// How the interchangeable colours are told apart in decision models.
+enum class value_symmetry
+{
+	none,
+
+	// Colour c + 1 is not used before colour c along the value order (see
+	// model_writer::get_value_order).
+	precedence,
+
+	// As precedence, with the largest clique of elements forced pairwise
+	// distinct pinned to colours 1, 2, ... at the front of the order.
+	pin
+};
 
 class model_writer
 {
 public:
 	model_writer(const graph& g, index_t k, std::ostream& os, const std::string& comment = "%")
-		: g_(g), k_(k), os_(os), comment_(comment)
+		: g_(g), k_(k), os_(os), comment_(comment), source_(nullptr), budget_(0), rss_limit_(0), forced_enabled_(false), kernel_enabled_(false), encoding_(path_encoding::alldiff), value_symmetry_(value_symmetry::none), search_enabled_(false)
 	{
 
 	}
@@ -23,11 +64,128 @@ public:
 
 	void add_line(const std::string& line);
 
+	void add_comment(const std::string& text);
+
+	// Take paths from the given source instead of enumerating them.
+	void set_path_source(path_source* source) { source_ = source; }
+
+	// Break the symmetries of the given vertex automorphisms (for instance
+	// canonical_label(g).generators) with lex-leader constraints on the edge
+	// colors. Honoured by the MiniZinc and Minion writers. Only the
+	// generators get a constraint, so some symmetric solutions may remain,
+	// and solution counts drop by an amount that depends on the solution:
+	// leave this off when counting colourings.
+	void set_edge_symmetries(const std::vector<std::vector<index_t>>& generators) { symmetries_ = generators; }
+
+	// Hand the solver a colouring to start from (one colour per edge_index id,
+	// for instance from local_search). Honoured by the MiniZinc writer.
+	void set_initial_solution(const std::vector<index_t>& colours) { initial_ = colours; }
+
+	// Hold at most this many bytes of paths per vertex pair in memory (and
+	// spill early once the process RSS passes rss_limit); 0 means no limit.
+	// Honoured by the MiniZinc and Minion writers, except that a path source
+	// or the kernel still hands over all paths of a pair at once. The Minion writer under the
+	// disequality encoding holds its constraints until the literals are
+	// declared, and moves them to a temporary file in pieces of the budget.
+	// Without a budget, pairs are read from one DFS per source vertex, which
+	// holds the paths to all of its targets at once; with one, a source over
+	// the budget is enumerated pair by pair.
+	void set_memory_budget(std::size_t budget, std::size_t rss_limit = 0) { budget_ = budget; rss_limit_ = rss_limit; single_source_.set_memory_budget(budget); }
+
+	// Per-pair path counts and peak memory, collected under a memory budget.
+	const std::vector<pair_statistics>& get_pair_statistics() const { return statistics_; }
+
+	// Find the elements forced to differ before writing the pairs (see
+	// forced_distinct), write them as clique alldiffs in place of the bridge
+	// constraint and leave out the pairs they satisfy. Honoured by every text
+	// edge writer and the total writer; the binary writers store every pair
+	// and throw std::runtime_error instead.
+	void set_forced_distinct(bool enabled) { forced_enabled_ = enabled; }
+
+	// The facts of the last write with set_forced_distinct, or null.
+	const forced_distinct* get_forced_distinct() const { return forced_.get(); }
+
+	// Model only the kernel of the graph (see graph_kernel): leave out the
+	// pairs it implies, and build the paths of the others from kernel paths
+	// unless another source is set. The bridges are kept distinct. Honoured
+	// by the MiniZinc (including total) and Minion writers.
+	void set_kernel(bool enabled) { kernel_enabled_ = enabled; }
+
+	// Honoured by the MiniZinc and Minion edge writers, except that only the
+	// MiniZinc ones write the zdd encoding (Minion throws); the FlatZinc
+	// writer always uses the disequality encoding.
+	void set_path_encoding(path_encoding encoding) { encoding_ = encoding; }
+
+	// Keep only one of the k! colourings that differ by renaming the colours.
+	// Every solution has such a representative, but solution counts shrink by
+	// a factor that depends on the solution, so leave this off when counting
+	// (as polynomial_points does). With edge symmetries set, pin is read as
+	// precedence: the lex-leader constraints and the precedence both follow
+	// the edge ids, which keeps them compatible. Honoured by every writer;
+	// the vertex writer pins its cut vertices.
+	void set_value_symmetry(value_symmetry mode) { value_symmetry_ = mode; }
+
+	// The element ids in the order the value symmetry is broken on: the
+	// pinned elements (pinned of them, at most k) first, then the rest by id.
+	std::vector<index_t> get_value_order(index_t& pinned);
+
+	// Tell the solver to branch on the edges most constrained first (see
+	// get_search_order), as read off the paths of at most k edges. Honoured
+	// by the MiniZinc and Minion edge writers.
+	void set_search_order(bool enabled) { search_enabled_ = enabled; }
+
 protected:
 	const graph& get_graph() const { return g_; }
 	index_t get_solution_size() const { return k_; }
 	std::ostream& get_output_stream() const { return os_; }
 	const std::string& get_comment() const { return comment_; }
+	const std::vector<std::vector<index_t>>& get_edge_symmetries() const { return symmetries_; }
+	const std::vector<index_t>& get_initial_solution() const { return initial_; }
+	path_source* get_path_source() const { return source_; }
+	bool has_kernel() const { return kernel_enabled_; }
+	bool has_forced_distinct() const { return forced_enabled_; }
+
+	void list_pair_paths(index_t u, index_t v, std::vector<edge_path>& paths, index_t length) const;
+	void list_pair_shortest_paths(index_t u, index_t v, std::vector<edge_path>& paths) const;
+
+	bool has_memory_budget() const { return budget_ != 0 || rss_limit_ != 0; }
+	std::size_t get_memory_budget() const { return budget_; }
+	std::size_t get_rss_limit() const { return rss_limit_; }
+	// Streams the paths into the spool as they are found. A path source or the
+	// kernel hands over whole vectors, so with either the paths of one pair
+	// are held in full once before they reach the spool.
+	void spool_pair_paths(index_t u, index_t v, path_spool& spool, index_t length) const;
+	void add_pair_statistics(index_t u, index_t v, const path_spool& spool);
+
+	// Edge ids of the bridges, every two of which must differ.
+	std::vector<index_t> get_bridge_ids() const;
+
+	// The cliques of get_forced_distinct() as edge endpoint lists, for add_alldiff.
+	std::vector<std::vector<index_t>> get_forced_cliques() const;
+
+	path_encoding get_path_encoding() const { return encoding_; }
+	disequality_table& get_disequalities();
+
+	// Writes p as one MiniZinc term of a path disjunction. The disequality
+	// literals it makes are appended to created, to be declared with
+	// add_disequality_literals once the constraint is written.
+	void add_path_term(const edge_path& p, std::vector<index_t>& created);
+	void add_disequality_literals(const std::vector<index_t>& created);
+
+	// Writes the constraint of pair u-v in the zdd encoding, over the paths
+	// of at most length edges.
+	void add_zdd_pair(index_t u, index_t v, index_t length);
+
+	value_symmetry get_value_symmetry() const { return value_symmetry_; }
+
+	bool has_search_order() const { return search_enabled_; }
+
+	// Edge ids, bridges first and then by how constrained they are.
+	std::vector<index_t> get_branching_order() const;
+
+	// Writes the value symmetry constraints in MiniZinc, names[x] being the
+	// variable of element x.
+	void add_value_symmetry(const std::vector<std::string>& names);
 
 private:
 	virtual void impl_preprocess();
@@ -36,10 +194,43 @@ private:
 
 	virtual void impl_process_vertex_pair(index_t u, index_t v);
 
+	virtual void impl_add_comment(const std::string& text);
+
+	// Whether the pairs are written with their geodesics only, which decides
+	// the paths the forced edges are read from.
+	virtual bool impl_shortest_paths() const { return false; }
+
+	// The forced facts for the paths of this model, with the bridges distinct.
+	virtual forced_distinct impl_find_forced_distinct() const;
+
+	// Number of elements that take a colour: the edges by default.
+	virtual index_t impl_num_elements() const { return g_.num_edges(); }
+
+	// Elements that get pairwise distinct colours in every solution.
+	virtual std::vector<index_t> impl_find_pinned() const;
+
 	const graph& g_;
 	index_t k_;
 	std::ostream& os_;
 	const std::string comment_;
+	path_source* source_;
+
+	// Without a source, the paths of a vertex u are found for all pairs at once.
+	mutable single_source_path_source single_source_;
+
+	std::vector<std::vector<index_t>> symmetries_;
+	std::vector<index_t> initial_;
+	std::size_t budget_;
+	std::size_t rss_limit_;
+	std::vector<pair_statistics> statistics_;
+	bool forced_enabled_;
+	std::unique_ptr<forced_distinct> forced_;
+	bool kernel_enabled_;
+	mutable kernel_path_source kernel_source_;
+	path_encoding encoding_;
+	std::unique_ptr<disequality_table> disequalities_;
+	value_symmetry value_symmetry_;
+	bool search_enabled_;
 };
 
 void prepare_model(index_t k, std::ostream& os);
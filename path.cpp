@@ -5,7 +5,24 @@
 
 void drop_endpoints(vertex_path& p)
 {
-	
+	if (p.size() < 1)
+		return;
+
+	// Backtracking the endpoints keeps the vertex count in step.
+	const index_t internal = p.get_internal_vertices();
+
+	for (index_t ends = p.get_vertices() & ~internal; ends != 0; ends &= ends - 1)
+		p.backtrack_vertex(ctz64(ends));
+}
+
+std::vector<index_t> to_internal_list(const vertex_path& p)
+{
+	std::vector<index_t> internal;
+
+	for (index_t x = p.get_internal_vertices(); x != 0; x &= x - 1)
+		internal.emplace_back(ctz64(x));
+
+	return internal;
 }
 
 std::vector<index_t> to_edge_list(const edge_path& p)
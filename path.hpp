@@ -47,61 +47,67 @@ public:
 	}
 };
 
-class vertex_path : public path<vertex_path, std::vector<bool>::const_iterator>
+// A path kept as the bitmask of its vertices, which is all that vertex
+// rainbow connection needs. The first and last vertices discovered are
+// remembered so the endpoints can be told apart from the internal vertices.
+class vertex_path : public path<vertex_path, std::vector<index_t>::const_iterator>
 {
 public:
-	vertex_path() : p_(64, false) { }
+	vertex_path() : visited_(0), vertices_(0), first_(0), last_(0) { }
 
-	vertex_path(index_t s)
-		: //path_(1 << s),
-		p_(64, false)
-	{
-		p_[s] = true;
-	}
+	vertex_path(index_t s) : visited_(0), vertices_(0), first_(s), last_(s) { }
 
 	void discover_vertex(index_t v)
 	{
-		//path_ |= (1 << v);
-		p_[v] = true;
+		if (vertices_ == 0)
+			first_ = v;
+
+		visited_ |= (1ULL << v);
+		last_ = v;
+		++vertices_;
 	}
 
 	void backtrack_vertex(index_t v)
 	{
-		//path_ &= ~(1 << v);
-		p_[v] = false;
+		visited_ &= ~(1ULL << v);
+		--vertices_;
 	}
 
 	bool contains_vertex(index_t v) const
 	{
-		//assert(bittest64(path_, v) == p_[v]);
-		//return bittest64(path_, v);
-		return p_[v];
+		return bittest64(visited_, v);
 	}
 
-	bool size() const
+	// Number of edges, as for edge_path.
+	index_t size() const
 	{
-		return p_.size();
+		return vertices_ - 1;
 	}
 
-	typedef std::vector<bool>::const_iterator Iterator;
-
-	Iterator cbegin() const 
+	index_t get_vertices() const
 	{
-		return p_.cbegin(); 
+		return visited_;
 	}
 
-	Iterator cend() const
+	// The vertices other than the two endpoints.
+	index_t get_internal_vertices() const
 	{
-		return p_.cend();
+		return visited_ & ~(1ULL << first_) & ~(1ULL << last_);
 	}
 
 private:
-	//index_t path_;
-	std::vector<bool> p_;
+	index_t visited_;
+	index_t vertices_;
+	index_t first_;
+	index_t last_;
 };
 
+// Leaves only the internal vertices in the path.
 void drop_endpoints(vertex_path& p);
 
+// Internal vertices in increasing order.
+std::vector<index_t> to_internal_list(const vertex_path& p);
+
 class edge_path : public path<edge_path, std::vector<index_t>::const_iterator>
 {
 public: // 1ULL
@@ -111,7 +117,7 @@ public: // 1ULL
 		assert(edges_.empty());
 	}
 
-	edge_path(index_t s)
+	edge_path(index_t s) : visited_(0)
 	{
 		//discover_vertex(s);
 	}
@@ -0,0 +1,387 @@
+// path_cache.cpp
+#include "path_cache.hpp"
+#include "canonical.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <iomanip>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const std::uint64_t MAGIC = 0x43505243; // "RCPC"
+	const std::uint64_t VERSION = 1;
+
+	struct file_header
+	{
+		std::uint64_t magic;
+		std::uint64_t version;
+		std::uint64_t n;
+		std::uint64_t shortest;
+		std::uint64_t length;
+		std::uint64_t adj[64];
+	};
+
+	// One entry per ordered pair u*n+v; offset 0 means the pair was not stored.
+	struct pair_entry
+	{
+		std::uint64_t offset;
+		std::uint64_t count;
+	};
+
+	std::string cache_filename(const std::string& directory, const graph& g, bool shortest, index_t length)
+	{
+		std::ostringstream ss;
+		ss << std::hex << std::setw(16) << std::setfill('0') << hash_graph(g) << std::dec;
+		ss << (shortest ? "_shortest" : "_all_");
+
+		if (!shortest)
+			ss << length;
+
+		ss << ".rcpc";
+		return (std::filesystem::path(directory) / ss.str()).string();
+	}
+
+	void write_path(const edge_path& p, std::ostream& os)
+	{
+		os.put(static_cast<char>(p.size() + 1));
+
+		for (auto it = p.cbegin(); it != p.cend(); ++it)
+		{
+			os.put(static_cast<char>(*it));
+		}
+	}
+
+	// Enumerates every non-adjacent pair into a temporary file and renames it
+	// into place, so concurrent runs never see a partial file.
+	void build_cache_file(const graph& g, bool shortest, index_t length, const std::string& filename)
+	{
+		const index_t n = g.num_vertices();
+
+		std::random_device rd;
+		const std::string temp = filename + "." + std::to_string(rd()) + ".tmp";
+		std::ofstream ofs(temp, std::ios::binary);
+
+		if (!ofs)
+			throw std::runtime_error("Cannot write path cache file " + temp);
+
+		file_header header = {};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.n = n;
+		header.shortest = shortest ? 1 : 0;
+		header.length = length;
+
+		for (index_t i = 0; i < n; ++i)
+		{
+			header.adj[i] = g.adj_[i];
+		}
+
+		std::vector<pair_entry> table(n * n, pair_entry{ 0, 0 });
+
+		ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(pair_entry));
+
+		index_t u = 0;
+		index_t v = 1;
+		const index_t pairs = nchoosek(n, 2);
+
+		for (index_t i = 0; i < pairs; ++i)
+		{
+			if (!is_adjacent(g, u, v))
+			{
+				std::vector<edge_path> paths;
+
+				if (shortest)
+					list_shortest_paths(g, u, v, paths);
+				else
+					list_paths(g, u, v, paths, length);
+
+				table[u * n + v].offset = ofs.tellp();
+				table[u * n + v].count = paths.size();
+
+				for (const auto& p : paths)
+				{
+					write_path(p, ofs);
+				}
+			}
+
+			next_pair(u, v, n);
+		}
+
+		ofs.seekp(sizeof(header));
+		ofs.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(pair_entry));
+		ofs.close();
+
+		if (!ofs)
+			throw std::runtime_error("Cannot write path cache file " + temp);
+
+		std::error_code ec;
+		std::filesystem::rename(temp, filename, ec);
+
+		if (ec)
+		{
+			std::filesystem::remove(temp, ec);
+
+			// Someone else may have won the race; that is fine.
+			if (!std::filesystem::exists(filename))
+				throw std::runtime_error("Cannot rename path cache file to " + filename);
+		}
+	}
+
+	bool matches(const mapped_file& file, const graph& g, bool shortest, index_t length)
+	{
+		if (file.size() < sizeof(file_header))
+			return false;
+
+		file_header header;
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (header.magic != MAGIC || header.version != VERSION || header.n != static_cast<std::uint64_t>(g.num_vertices()))
+			return false;
+
+		if (header.shortest != (shortest ? 1 : 0) || header.length != static_cast<std::uint64_t>(length))
+			return false;
+
+		for (index_t i = 0; i < g.num_vertices(); ++i)
+		{
+			if (header.adj[i] != static_cast<std::uint64_t>(g.adj_[i]))
+				return false;
+		}
+
+		return file.size() >= sizeof(file_header) + header.n * header.n * sizeof(pair_entry);
+	}
+
+	void to_edge_paths(const cached_paths& cached, std::vector<edge_path>& paths, index_t length)
+	{
+		const unsigned char* it = cached.data;
+
+		for (index_t i = 0; i < cached.count; ++i)
+		{
+			const index_t vertices = *it++;
+
+			if (vertices - 1 <= length)
+			{
+				edge_path p;
+				for (index_t j = 0; j < vertices; ++j)
+				{
+					p.discover_vertex(cached.vertices[it[cached.reversed ? vertices - 1 - j : j]]);
+				}
+
+				paths.emplace_back(p);
+			}
+
+			it += vertices;
+		}
+	}
+}
+
+#if defined(_MSC_VER)
+
+mapped_file::mapped_file(const std::string& filename)
+	: data_(nullptr), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+{
+	file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file_ == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Cannot open " + filename);
+
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(file_, &size))
+	{
+		CloseHandle(file_);
+		throw std::runtime_error("Cannot stat " + filename);
+	}
+
+	size_ = static_cast<std::size_t>(size.QuadPart);
+
+	// An empty file cannot be mapped, and holds nothing to read.
+	if (size_ == 0)
+		return;
+
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mapping_ != nullptr)
+		data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+
+	if (data_ == nullptr)
+	{
+		if (mapping_ != nullptr)
+			CloseHandle(mapping_);
+
+		CloseHandle(file_);
+		throw std::runtime_error("Cannot map " + filename);
+	}
+}
+
+mapped_file::~mapped_file()
+{
+	if (data_ != nullptr)
+		UnmapViewOfFile(data_);
+
+	if (mapping_ != nullptr)
+		CloseHandle(mapping_);
+
+	CloseHandle(file_);
+}
+
+#else
+
+mapped_file::mapped_file(const std::string& filename)
+	: data_(nullptr), size_(0), fd_(-1)
+{
+	fd_ = ::open(filename.c_str(), O_RDONLY);
+
+	if (fd_ < 0)
+		throw std::runtime_error("Cannot open " + filename);
+
+	struct stat st;
+
+	if (::fstat(fd_, &st) != 0)
+	{
+		::close(fd_);
+		throw std::runtime_error("Cannot stat " + filename);
+	}
+
+	size_ = st.st_size;
+
+	// An empty file cannot be mapped, and holds nothing to read.
+	if (size_ == 0)
+		return;
+
+	void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+
+	if (p == MAP_FAILED)
+	{
+		::close(fd_);
+		throw std::runtime_error("Cannot map " + filename);
+	}
+
+	data_ = static_cast<const unsigned char*>(p);
+}
+
+mapped_file::~mapped_file()
+{
+	if (data_ != nullptr)
+		munmap(const_cast<unsigned char*>(data_), size_);
+
+	::close(fd_);
+}
+
+#endif
+
+path_cache::path_cache(const std::string& directory)
+	: directory_(directory), files_()
+{
+	std::filesystem::create_directories(directory_);
+}
+
+const path_cache::labelling& path_cache::label(const graph& g)
+{
+	const std::uint64_t hash = hash_graph(g);
+	auto it = labellings_.find(hash);
+
+	if (it != labellings_.end() && it->second.adj == g.adj_)
+		return it->second;
+
+	const canonical_labelling c = canonical_label(g);
+	std::vector<index_t> vertices(g.num_vertices());
+
+	for (index_t v = 0; v < g.num_vertices(); ++v)
+	{
+		vertices[c.labels[v]] = v;
+	}
+
+	// A hash collision replaces the other graph, which is labelled again if
+	// it comes back.
+	if (it != labellings_.end())
+		labellings_.erase(it);
+
+	return labellings_.emplace(hash, labelling{ g.adj_, c.labels, vertices, relabel(g, c.labels) }).first->second;
+}
+
+const mapped_file& path_cache::open(const graph& canonical, bool shortest, index_t length)
+{
+	// The length bound has no meaning for geodesics.
+	if (shortest)
+		length = 0;
+
+	const key_type key(hash_graph(canonical), shortest, length);
+	auto it = files_.find(key);
+
+	if (it != files_.end())
+		return *it->second;
+
+	const std::string filename = cache_filename(directory_, canonical, shortest, length);
+
+	if (!std::filesystem::exists(filename))
+		build_cache_file(canonical, shortest, length, filename);
+
+	std::unique_ptr<mapped_file> file(new mapped_file(filename));
+
+	// A hash collision or a stale file: rebuild it for this graph.
+	if (!matches(*file, canonical, shortest, length))
+	{
+		file.reset();
+		std::filesystem::remove(filename);
+		build_cache_file(canonical, shortest, length, filename);
+		file.reset(new mapped_file(filename));
+	}
+
+	return *(files_[key] = std::move(file));
+}
+
+cached_paths path_cache::find(const graph& g, index_t s, index_t t, bool shortest, index_t length)
+{
+	const labelling& l = label(g);
+	const mapped_file& file = open(l.canonical, shortest, length);
+	const index_t n = g.num_vertices();
+
+	const bool reversed = l.labels[s] > l.labels[t];
+	const index_t a = reversed ? l.labels[t] : l.labels[s];
+	const index_t b = reversed ? l.labels[s] : l.labels[t];
+
+	pair_entry entry;
+	std::memcpy(&entry, file.data() + sizeof(file_header) + (a * n + b) * sizeof(pair_entry), sizeof(entry));
+
+	if (entry.offset == 0)
+		return cached_paths{ nullptr, 0, nullptr, false };
+
+	return cached_paths{ file.data() + entry.offset, static_cast<index_t>(entry.count), l.vertices.data(), reversed };
+}
+
+void path_cache::get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	cached_paths cached = find(g, s, t, false, length);
+
+	if (cached.data == nullptr)
+		list_paths(g, s, t, paths, length);
+	else
+		to_edge_paths(cached, paths, length);
+}
+
+void path_cache::get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	cached_paths cached = find(g, s, t, true, 0);
+
+	if (cached.data == nullptr)
+		list_shortest_paths(g, s, t, paths);
+	else
+		to_edge_paths(cached, paths, std::numeric_limits<index_t>::max());
+}
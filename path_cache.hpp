@@ -0,0 +1,94 @@
+// path_cache.hpp
+#ifndef PATH_CACHE_HPP
+#define PATH_CACHE_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// A read-only file mapped into memory.
+class mapped_file
+{
+public:
+	explicit mapped_file(const std::string& filename);
+	~mapped_file();
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	const unsigned char* data() const { return data_; }
+	std::size_t size() const { return size_; }
+
+private:
+	const unsigned char* data_;
+	std::size_t size_;
+#if defined(_MSC_VER)
+	void* file_;
+	void* mapping_;
+#else
+	int fd_;
+#endif
+};
+
+// The paths of one vertex pair inside a mapped cache file. Each path is
+// stored as its vertex count followed by the vertices, one byte each, in the
+// canonical labelling of the graph: vertices[x] is the vertex of the graph
+// asked about that x stands for. Only the pairs with the smaller label first
+// are stored, so reversed paths run from t to s.
+struct cached_paths
+{
+	const unsigned char* data;
+	index_t count;
+	const index_t* vertices;
+	bool reversed;
+};
+
+// An on-disk cache of enumerated s-t paths, shared across writers, values
+// of k and runs. There is one file per (canonical form, mode, length bound),
+// so isomorphic graphs share it; on the first request it is filled with the
+// paths of every non-adjacent pair of the canonically labelled graph, and
+// afterwards it is memory-mapped and read in place. Paths are mapped back to
+// the labels of the graph asked about as they are read, so they come in the
+// order of the canonical graph rather than that of list_paths on it.
+//
+// Hand it to a writer with model_writer::set_path_source.
+class path_cache : public path_source
+{
+public:
+	explicit path_cache(const std::string& directory);
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+
+	// Zero-copy access; data is null if the pair is not in the cache.
+	cached_paths find(const graph& g, index_t s, index_t t, bool shortest, index_t length);
+
+private:
+	typedef std::tuple<std::uint64_t, bool, index_t> key_type;
+
+	// A graph as given and its canonical labelling, found once per graph.
+	struct labelling
+	{
+		std::vector<index_t> adj;
+		std::vector<index_t> labels;
+		std::vector<index_t> vertices;
+		graph canonical;
+	};
+
+	const labelling& label(const graph& g);
+	const mapped_file& open(const graph& canonical, bool shortest, index_t length);
+
+	std::string directory_;
+	std::map<std::uint64_t, labelling> labellings_;
+	std::map<key_type, std::unique_ptr<mapped_file>> files_;
+};
+
+#endif
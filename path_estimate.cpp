@@ -0,0 +1,120 @@
+// path_estimate.cpp
+#include "path_estimate.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+
+path_estimate estimate_paths(const graph& g, index_t s, index_t t, index_t length, index_t probes, std::uint64_t seed)
+{
+	std::mt19937_64 gen(seed);
+
+	path_estimate sum = { 0.0, 0.0, 0.0 };
+
+	for (index_t probe = 0; probe < probes; ++probe)
+	{
+		std::uint64_t visited = (1ULL << s);
+		index_t current = s;
+		index_t depth = 0;
+		double weight = 1.0;
+
+		for (;;)
+		{
+			sum.nodes += weight;
+
+			if (current == t)
+			{
+				sum.paths += weight;
+				sum.edges += weight * depth;
+				break;
+			}
+
+			if (depth >= length)
+				break;
+
+			const std::uint64_t children = g.adj_[current] & ~visited;
+			const int d = popcount64(children);
+
+			if (d == 0)
+				break;
+
+			// Pick the i-th child uniformly at random.
+			std::uint64_t pick = children;
+			for (int i = std::uniform_int_distribution<int>(0, d - 1)(gen); i > 0; --i)
+				pick &= pick - 1;
+
+			current = ctz64(pick);
+			visited |= (1ULL << current);
+			weight *= d;
+			++depth;
+		}
+	}
+
+	return path_estimate{ sum.paths / probes, sum.edges / probes, sum.nodes / probes };
+}
+
+std::vector<pair_cost> estimate_pair_costs(const graph& g, index_t length, index_t probes, std::uint64_t seed)
+{
+	std::vector<pair_cost> costs;
+
+	index_t u = 0;
+	index_t v = 1;
+	const index_t n = g.num_vertices();
+	const index_t pairs = nchoosek(n, 2);
+
+	for (index_t i = 0; i < pairs; ++i)
+	{
+		if (!is_adjacent(g, u, v))
+		{
+			const path_estimate e = estimate_paths(g, u, v, length, probes, seed + i);
+			costs.emplace_back(pair_cost{ u, v, e, e.nodes + e.edges });
+		}
+
+		next_pair(u, v, n);
+	}
+
+	return costs;
+}
+
+void sort_by_cost(std::vector<pair_cost>& costs)
+{
+	std::stable_sort(costs.begin(), costs.end(), [](const pair_cost& a, const pair_cost& b)
+	{
+		return a.cost > b.cost;
+	});
+}
+
+void print_cost_report(const std::vector<pair_cost>& costs, std::ostream& os, index_t top)
+{
+	double paths = 0.0;
+	double cost = 0.0;
+
+	for (const auto& c : costs)
+	{
+		paths += c.estimate.paths;
+		cost += c.cost;
+	}
+
+	auto sorted = costs;
+	sort_by_cost(sorted);
+
+	const auto flags = os.flags();
+	const auto precision = os.precision();
+
+	os << "Estimated cost of " << costs.size() << " vertex pairs\n";
+	os << std::scientific << std::setprecision(3);
+	os << "  total paths: " << paths << "\n";
+	os << "  total cost:  " << cost << "\n";
+
+	for (index_t i = 0; i < top && i < sorted.size(); ++i)
+	{
+		const auto& c = sorted[i];
+		os << "  pair " << c.u << " " << c.v
+			<< ": paths " << c.estimate.paths
+			<< ", nodes " << c.estimate.nodes
+			<< ", cost " << c.cost << "\n";
+	}
+
+	os.flags(flags);
+	os.precision(precision);
+}
@@ -0,0 +1,45 @@
+// path_estimate.hpp
+#ifndef PATH_ESTIMATE_HPP
+#define PATH_ESTIMATE_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Knuth-style estimates of the DFS tree explored by list_paths: the mean of
+// the products of branching factors along random root-to-leaf probes.
+struct path_estimate
+{
+	// Number of s-t paths with at most 'length' edges.
+	double paths;
+
+	// Total number of edges over those paths (output size).
+	double edges;
+
+	// Number of search nodes visited by the enumeration.
+	double nodes;
+};
+
+path_estimate estimate_paths(const graph& g, index_t s, index_t t, index_t length, index_t probes, std::uint64_t seed = 1);
+
+// Estimated cost of enumerating and writing out the paths of one pair, in
+// search nodes plus emitted edges.
+struct pair_cost
+{
+	index_t u;
+	index_t v;
+	path_estimate estimate;
+	double cost;
+};
+
+// Estimates every non-adjacent pair, in next_pair order.
+std::vector<pair_cost> estimate_pair_costs(const graph& g, index_t length, index_t probes = 256, std::uint64_t seed = 1);
+
+// Most expensive pairs first, so a scheduler does not start a straggler last.
+void sort_by_cost(std::vector<pair_cost>& costs);
+
+void print_cost_report(const std::vector<pair_cost>& costs, std::ostream& os = std::cout, index_t top = 10);
+
+#endif
@@ -0,0 +1,179 @@
+// path_index.cpp
+#include "path_index.hpp"
+
+#include <cassert>
+#include <utility>
+
+namespace
+{
+	void append_varint(std::vector<unsigned char>& out, std::uint64_t x)
+	{
+		while (x >= 0x80)
+		{
+			out.push_back(static_cast<unsigned char>((x & 0x7f) | 0x80));
+			x >>= 7;
+		}
+
+		out.push_back(static_cast<unsigned char>(x));
+	}
+}
+
+edge_path_index::edge_path_index(const rainbow_checker& checker)
+	: starts_(), counts_(checker.num_elements(), 0)
+{
+	const index_t m = counts_.size();
+
+	// Pairs and rows are visited in order, so every list comes out sorted.
+	std::vector<std::vector<std::pair<index_t, index_t>>> lists(m);
+
+	for (index_t i = 0; i < checker.num_pairs(); ++i)
+	{
+		const path_matrix& paths = checker.get_paths(i);
+
+		for (index_t p = 0; p < paths.num_paths(); ++p)
+		{
+			for (index_t j = 0; j < paths.length(p); ++j)
+				lists[paths.edge(p, j)].emplace_back(i, p);
+		}
+	}
+
+	std::vector<unsigned char> rows;
+
+	for (index_t e = 0; e < m; ++e)
+	{
+		starts_.emplace_back(data_.size());
+		counts_[e] = lists[e].size();
+
+		index_t last_pair = 0;
+
+		for (std::size_t i = 0; i < lists[e].size(); )
+		{
+			const index_t pair = lists[e][i].first;
+			index_t last_row = 0;
+			index_t count = 0;
+			rows.clear();
+
+			for (; i < lists[e].size() && lists[e][i].first == pair; ++i, ++count)
+			{
+				append_varint(rows, lists[e][i].second - last_row);
+				last_row = lists[e][i].second;
+			}
+
+			append_varint(data_, pair - last_pair);
+			append_varint(data_, count);
+			append_varint(data_, rows.size());
+			data_.insert(data_.end(), rows.begin(), rows.end());
+			last_pair = pair;
+		}
+
+		std::vector<std::pair<index_t, index_t>>().swap(lists[e]);
+	}
+
+	starts_.emplace_back(data_.size());
+	data_.shrink_to_fit();
+}
+
+rainbow_state::rainbow_state(const rainbow_checker& checker, const edge_path_index& index, const std::vector<index_t>& colours)
+	: checker_(checker), index_(index), colours_(colours), packed_(colours),
+	witness_(checker.num_pairs(), -1), position_(checker.num_pairs(), -1)
+{
+	assert(static_cast<index_t>(colours.size()) == index.num_edges());
+
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+		mark(i, checker_.get_paths(i).find_rainbow(packed_));
+}
+
+bool rainbow_state::is_rainbow(index_t pair, index_t row) const
+{
+	const path_matrix& paths = checker_.get_paths(pair);
+	std::uint64_t mask = 0;
+
+	for (index_t j = 0; j < paths.length(row); ++j)
+		mask |= (1ULL << (colours_[paths.edge(row, j)] - 1));
+
+	return popcount64(mask) == paths.length(row);
+}
+
+index_t rainbow_state::find_rainbow_row(const posting_group& group) const
+{
+	index_t found = -1;
+
+	group.for_each_row([&](index_t row)
+	{
+		if (found == -1 && is_rainbow(group.pair, row))
+			found = row;
+	});
+
+	return found;
+}
+
+void rainbow_state::mark(index_t pair, index_t witness)
+{
+	if (witness == -1 && position_[pair] == -1)
+	{
+		position_[pair] = violated_.size();
+		violated_.emplace_back(pair);
+	}
+	else if (witness != -1 && position_[pair] != -1)
+	{
+		const index_t last = violated_.back();
+		violated_[position_[pair]] = last;
+		position_[last] = position_[pair];
+		violated_.pop_back();
+		position_[pair] = -1;
+	}
+
+	witness_[pair] = witness;
+}
+
+void rainbow_state::recolour(index_t e, index_t colour)
+{
+	assert(colour >= 1 && colour <= 64);
+
+	colours_[e] = colour;
+	packed_.set(e, colour);
+
+	index_.for_each_pair(e, [&](const posting_group& group)
+	{
+		const index_t witness = witness_[group.pair];
+
+		// Only paths through e can have become rainbow.
+		if (witness == -1)
+			mark(group.pair, find_rainbow_row(group));
+		else if (!is_rainbow(group.pair, witness))
+			mark(group.pair, checker_.get_paths(group.pair).find_rainbow(packed_));
+	});
+}
+
+index_t rainbow_state::delta(index_t e, index_t colour)
+{
+	assert(colour >= 1 && colour <= 64);
+
+	// Evaluated on the recoloured state, which is undone at the end.
+	const index_t old = colours_[e];
+	colours_[e] = colour;
+	packed_.set(e, colour);
+
+	index_t d = 0;
+
+	index_.for_each_pair(e, [&](const posting_group& group)
+	{
+		const index_t witness = witness_[group.pair];
+
+		if (witness == -1)
+		{
+			if (find_rainbow_row(group) != -1)
+				--d;
+		}
+		else if (!is_rainbow(group.pair, witness))
+		{
+			if (!checker_.get_paths(group.pair).any_rainbow(packed_))
+				++d;
+		}
+	});
+
+	colours_[e] = old;
+	packed_.set(e, old);
+
+	return d;
+}
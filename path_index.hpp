@@ -0,0 +1,146 @@
+// path_index.hpp
+#ifndef PATH_INDEX_HPP
+#define PATH_INDEX_HPP
+
+#include "common.hpp"
+#include "rainbow_kernel.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace detail
+{
+	inline std::uint64_t read_varint(const unsigned char*& it)
+	{
+		// Almost all gaps, counts and sizes fit in one byte.
+		if (*it < 0x80)
+			return *it++;
+
+		std::uint64_t x = 0;
+
+		for (int shift = 0; ; shift += 7)
+		{
+			x |= static_cast<std::uint64_t>(*it & 0x7f) << shift;
+
+			if ((*it++ & 0x80) == 0)
+				return x;
+		}
+	}
+}
+
+// The paths of one pair that go through an edge: rows of the pair's
+// path_matrix, stored as varint-coded gaps.
+struct posting_group
+{
+	index_t pair;
+	index_t count;
+	const unsigned char* rows;
+
+	template <typename Visitor>
+	void for_each_row(Visitor visit) const
+	{
+		const unsigned char* it = rows;
+		index_t row = 0;
+
+		for (index_t i = 0; i < count; ++i)
+		{
+			row += detail::read_varint(it);
+			visit(row);
+		}
+	}
+};
+
+// Inverted index from element (edge) ids to the paths of a rainbow_checker
+// that contain them. The posting list of an edge is grouped by pair, in pair
+// order; each group is a header (pair gap, row count, size in bytes) followed by the
+// sorted rows, all varint-coded, so a group can be skipped without decoding.
+class edge_path_index
+{
+public:
+	explicit edge_path_index(const rainbow_checker& checker);
+
+	index_t num_edges() const { return counts_.size(); }
+
+	// Number of paths through edge e.
+	index_t postings(index_t e) const { return counts_[e]; }
+
+	// Size of the compressed posting lists.
+	std::size_t bytes() const { return data_.size(); }
+
+	// Calls visit(const posting_group&) for every pair with a path through e.
+	template <typename Visitor>
+	void for_each_pair(index_t e, Visitor visit) const
+	{
+		const unsigned char* it = data_.data() + starts_[e];
+		const unsigned char* end = data_.data() + starts_[e + 1];
+		posting_group group = { 0, 0, nullptr };
+
+		while (it != end)
+		{
+			group.pair += detail::read_varint(it);
+			group.count = detail::read_varint(it);
+			const std::size_t size = detail::read_varint(it);
+
+			group.rows = it;
+			visit(static_cast<const posting_group&>(group));
+			it += size;
+		}
+	}
+
+	// Calls visit(pair, row) for every path through e.
+	template <typename Visitor>
+	void for_each(index_t e, Visitor visit) const
+	{
+		for_each_pair(e, [&visit](const posting_group& group)
+		{
+			group.for_each_row([&](index_t row) { visit(group.pair, row); });
+		});
+	}
+
+private:
+	std::vector<std::size_t> starts_;
+	std::vector<index_t> counts_;
+	std::vector<unsigned char> data_;
+};
+
+// Which pairs of a rainbow_checker have a rainbow path under a colouring that
+// changes one edge at a time. Every satisfied pair keeps a witness rainbow
+// path; recolouring e only touches the pairs in the posting list of e, and
+// of those only the violated ones (whose rows through e may turn rainbow)
+// and the ones whose witness runs through e and stops being rainbow.
+class rainbow_state
+{
+public:
+	rainbow_state(const rainbow_checker& checker, const edge_path_index& index, const std::vector<index_t>& colours);
+
+	void recolour(index_t e, index_t colour);
+
+	// Change in the number of violated pairs that recolour(e, colour) would make.
+	index_t delta(index_t e, index_t colour);
+
+	index_t colour(index_t e) const { return colours_[e]; }
+	const std::vector<index_t>& get_colours() const { return colours_; }
+
+	// Pairs without a rainbow path, in no particular order.
+	const std::vector<index_t>& get_violated() const { return violated_; }
+	index_t num_violations() const { return violated_.size(); }
+
+	// Row of a rainbow path of the pair, or -1.
+	index_t get_witness(index_t pair) const { return witness_[pair]; }
+
+private:
+	bool is_rainbow(index_t pair, index_t row) const;
+	index_t find_rainbow_row(const posting_group& group) const;
+	void mark(index_t pair, index_t witness);
+
+	const rainbow_checker& checker_;
+	const edge_path_index& index_;
+	std::vector<index_t> colours_;
+	packed_colouring packed_;
+
+	std::vector<index_t> witness_;
+	std::vector<index_t> violated_;
+	std::vector<index_t> position_;
+};
+
+#endif
@@ -0,0 +1,126 @@
+// path_mitm.cpp
+#include "path_mitm.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace
+{
+	// Half-paths from one root with at most depth edges. A half is its vertex
+	// mask and the start of its vertex sequence in vertices; it sits in the
+	// bucket of its last vertex and its number of edges.
+	struct half_paths
+	{
+		half_paths(index_t n, index_t depth) : depth(depth), buckets(n * (depth + 1)) { }
+
+		std::vector<std::pair<std::uint64_t, index_t>>& bucket(index_t v, index_t edges)
+		{
+			return buckets[v * (depth + 1) + edges];
+		}
+
+		index_t depth;
+		std::vector<std::vector<std::pair<std::uint64_t, index_t>>> buckets;
+		std::vector<index_t> vertices;
+	};
+
+	void grow(const graph& g, index_t v, index_t avoid, std::uint64_t mask, std::vector<index_t>& stack, half_paths& halves)
+	{
+		const index_t edges = stack.size() - 1;
+
+		if (edges > 0)
+		{
+			halves.bucket(v, edges).emplace_back(mask, halves.vertices.size());
+			halves.vertices.insert(halves.vertices.end(), stack.begin(), stack.end());
+		}
+
+		if (edges == halves.depth)
+			return;
+
+		for (index_t adj = g.adj_[v] & ~mask & ~(1ULL << avoid); adj != 0; adj &= adj - 1)
+		{
+			const index_t w = ctz64(adj);
+
+			stack.emplace_back(w);
+			grow(g, w, avoid, mask | (1ULL << w), stack, halves);
+			stack.pop_back();
+		}
+	}
+
+	half_paths grow_halves(const graph& g, index_t root, index_t avoid, index_t depth)
+	{
+		half_paths halves(g.num_vertices(), depth);
+		std::vector<index_t> stack(1, root);
+
+		grow(g, root, avoid, (1ULL << root), stack, halves);
+		return halves;
+	}
+}
+
+void list_paths_mitm(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	assert(s != t);
+
+	const index_t n = g.num_vertices();
+	length = std::min(length, n - 1);
+
+	if (length < 1)
+		return;
+
+	// The one path that meets at t itself.
+	if (is_adjacent(g, s, t))
+	{
+		edge_path p;
+		p.discover_vertex(s);
+		p.discover_vertex(t);
+		paths.emplace_back(p);
+	}
+
+	const index_t from_s = (length + 1) / 2;
+	const index_t from_t = length / 2;
+
+	if (from_t == 0)
+		return;
+
+	half_paths s_halves = grow_halves(g, s, t, from_s);
+	half_paths t_halves = grow_halves(g, t, s, from_t);
+
+	for (index_t m = 0; m < n; ++m)
+	{
+		if (m == s || m == t)
+			continue;
+
+		for (index_t a = 1; a <= from_s; ++a)
+		{
+			// A path of l edges meets ceil(l / 2) edges from s.
+			for (index_t b = a - 1; b <= a && a + b <= length; ++b)
+			{
+				if (b == 0 || b > from_t)
+					continue;
+
+				const auto& left = s_halves.bucket(m, a);
+				const auto& right = t_halves.bucket(m, b);
+
+				for (const auto& x : left)
+				{
+					for (const auto& y : right)
+					{
+						if ((x.first & y.first) != (1ULL << m))
+							continue;
+
+						edge_path p;
+
+						for (index_t j = 0; j <= a; ++j)
+							p.discover_vertex(s_halves.vertices[x.second + j]);
+
+						for (index_t j = b - 1; j >= 0; --j)
+							p.discover_vertex(t_halves.vertices[y.second + j]);
+
+						paths.emplace_back(p);
+					}
+				}
+			}
+		}
+	}
+}
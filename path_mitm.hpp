@@ -0,0 +1,37 @@
+// path_mitm.hpp
+#ifndef PATH_MITM_HPP
+#define PATH_MITM_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include <vector>
+
+// Meet-in-the-middle enumeration of the simple s-t paths with at most length
+// edges, in no particular order. A path of l edges is split at the vertex
+// ceil(l / 2) edges from s, so half-paths of at most ceil(length / 2) edges
+// are grown from s and from t (never through t and s), bucketed by end vertex
+// and length, and every bucket pair whose lengths add up to a path is joined
+// on the vertex masks: two halves make a path iff they share only the
+// meeting vertex. The search trees are b^(k/2) deep instead of b^k, which
+// pays off on dense graphs; the join still touches every pair of halves
+// meeting at a vertex.
+void list_paths_mitm(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+// Hand it to a writer or a rainbow_checker to enumerate with list_paths_mitm.
+class mitm_path_source : public path_source
+{
+public:
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+	{
+		list_paths_mitm(g, s, t, paths, length);
+	}
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths)
+	{
+		list_shortest_paths(g, s, t, paths);
+	}
+};
+
+#endif
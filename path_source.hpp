@@ -0,0 +1,22 @@
+// path_source.hpp
+#ifndef PATH_SOURCE_HPP
+#define PATH_SOURCE_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include <vector>
+
+// Where a model_writer gets the s-t paths of a vertex pair from. Without a
+// source the writers enumerate them with list_paths/list_shortest_paths.
+class path_source
+{
+public:
+	virtual ~path_source() { }
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length) = 0;
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths) = 0;
+};
+
+#endif
@@ -0,0 +1,259 @@
+// path_spool.cpp
+#include "path_spool.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// RSS is read from the system only every so many paths.
+	const index_t RSS_INTERVAL = 4096;
+
+	bool record_less(const unsigned char* a, const unsigned char* b)
+	{
+		return std::lexicographical_compare(a + 1, a + 1 + a[0], b + 1, b + 1 + b[0]);
+	}
+
+	edge_path to_path(const unsigned char* record)
+	{
+		edge_path p;
+
+		for (index_t i = 1; i <= record[0]; ++i)
+			p.discover_vertex(record[i]);
+
+		return p;
+	}
+
+	// Reads the next record of a run; false at the end.
+	bool read_record(std::FILE* run, unsigned char* record)
+	{
+		const int len = std::fgetc(run);
+
+		if (len == EOF)
+			return false;
+
+		record[0] = static_cast<unsigned char>(len);
+		return std::fread(record + 1, 1, len, run) == static_cast<std::size_t>(len);
+	}
+}
+
+std::size_t resident_set_size()
+{
+#if defined(_MSC_VER)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize;
+
+	return 0;
+#elif defined(__linux__)
+	std::ifstream statm("/proc/self/statm");
+	std::size_t pages = 0;
+	std::size_t resident = 0;
+
+	if (statm >> pages >> resident)
+		return resident * sysconf(_SC_PAGESIZE);
+
+	return 0;
+#else
+	return 0;
+#endif
+}
+
+path_spool::path_spool(std::size_t budget, std::size_t rss_limit)
+	: budget_(budget), rss_limit_(rss_limit), count_(0), peak_(0)
+{
+
+}
+
+path_spool::~path_spool()
+{
+	clear();
+}
+
+std::size_t path_spool::memory_bytes() const
+{
+	return buffer_.size() + offsets_.size() * sizeof(std::size_t);
+}
+
+void path_spool::add(const edge_path& p)
+{
+	offsets_.emplace_back(buffer_.size());
+	buffer_.emplace_back(static_cast<unsigned char>(p.size() + 1));
+
+	for (auto it = p.cbegin(); it != p.cend(); ++it)
+		buffer_.emplace_back(static_cast<unsigned char>(*it));
+
+	++count_;
+	peak_ = std::max(peak_, memory_bytes());
+
+	bool over = (budget_ != 0 && memory_bytes() > budget_);
+
+	if (!over && rss_limit_ != 0 && (count_ % RSS_INTERVAL) == 0)
+		over = (resident_set_size() > rss_limit_);
+
+	if (over)
+		spill();
+}
+
+void path_spool::sort_buffer()
+{
+	std::sort(offsets_.begin(), offsets_.end(), [this](std::size_t a, std::size_t b)
+	{
+		return record_less(&buffer_[a], &buffer_[b]);
+	});
+}
+
+void path_spool::spill()
+{
+	if (offsets_.empty())
+		return;
+
+	sort_buffer();
+
+	std::FILE* run = std::tmpfile();
+
+	if (run == nullptr)
+		throw std::runtime_error("Cannot create a temporary file for spilling paths");
+
+	// Owned by the spool from here, so the destructor closes it on failure.
+	runs_.emplace_back(run);
+
+	for (auto offset : offsets_)
+	{
+		const std::size_t size = buffer_[offset] + 1;
+
+		if (std::fwrite(&buffer_[offset], 1, size, run) != size)
+			throw std::runtime_error("Cannot write spilled paths to a temporary file");
+	}
+
+	if (std::fflush(run) != 0 || std::ferror(run))
+		throw std::runtime_error("Cannot write spilled paths to a temporary file");
+
+	std::rewind(run);
+
+	buffer_.clear();
+	buffer_.shrink_to_fit();
+	offsets_.clear();
+	offsets_.shrink_to_fit();
+}
+
+void path_spool::for_each(const std::function<void(const edge_path&)>& f)
+{
+	if (runs_.empty())
+	{
+		sort_buffer();
+
+		for (auto offset : offsets_)
+			f(to_path(&buffer_[offset]));
+
+		return;
+	}
+
+	// Make the in-memory tail a run too, then merge all runs.
+	spill();
+
+	const index_t r = runs_.size();
+	std::vector<std::vector<unsigned char>> heads(r, std::vector<unsigned char>(256));
+
+	auto greater = [&heads](index_t a, index_t b)
+	{
+		return record_less(heads[b].data(), heads[a].data());
+	};
+
+	std::priority_queue<index_t, std::vector<index_t>, decltype(greater)> q(greater);
+
+	for (index_t i = 0; i < r; ++i)
+	{
+		std::rewind(runs_[i]);
+
+		if (read_record(runs_[i], heads[i].data()))
+			q.push(i);
+	}
+
+	while (!q.empty())
+	{
+		const index_t i = q.top();
+		q.pop();
+
+		f(to_path(heads[i].data()));
+
+		if (read_record(runs_[i], heads[i].data()))
+			q.push(i);
+	}
+}
+
+void path_spool::clear()
+{
+	for (auto run : runs_)
+		std::fclose(run);
+
+	runs_.clear();
+	buffer_.clear();
+	offsets_.clear();
+	count_ = 0;
+	peak_ = 0;
+}
+
+text_spool::~text_spool()
+{
+	if (spill_ != nullptr)
+		std::fclose(spill_);
+}
+
+std::ostream& text_spool::stream()
+{
+	if (budget_ != 0 && static_cast<std::size_t>(buffer_.tellp()) > budget_)
+	{
+		if (spill_ == nullptr)
+			spill_ = std::tmpfile();
+
+		if (spill_ == nullptr)
+			throw std::runtime_error("Cannot create a temporary file for spilling constraints");
+
+		const std::string text = buffer_.str();
+
+		if (std::fwrite(text.data(), 1, text.size(), spill_) != text.size())
+			throw std::runtime_error("Cannot spill constraints to a temporary file");
+
+		buffer_.str("");
+	}
+
+	return buffer_;
+}
+
+void text_spool::copy_to(std::ostream& os)
+{
+	if (spill_ != nullptr)
+	{
+		if (std::fflush(spill_) != 0 || std::ferror(spill_))
+			throw std::runtime_error("Cannot spill constraints to a temporary file");
+
+		std::vector<char> chunk(1 << 16);
+		std::rewind(spill_);
+
+		for (std::size_t got; (got = std::fread(chunk.data(), 1, chunk.size(), spill_)) != 0; )
+			os.write(chunk.data(), got);
+
+		std::fclose(spill_);
+		spill_ = nullptr;
+	}
+
+	// Read back through the buffer (hence a stringstream) rather than copied
+	// out with str(); inserting an empty buffer would set failbit on os.
+	if (buffer_.tellp() > 0)
+		os << buffer_.rdbuf();
+
+	buffer_.str("");
+	buffer_.clear();
+}
@@ -0,0 +1,99 @@
+// path_spool.hpp
+#ifndef PATH_SPOOL_HPP
+#define PATH_SPOOL_HPP
+
+#include "common.hpp"
+#include "path.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+// Resident set size of this process in bytes, or 0 if unknown.
+std::size_t resident_set_size();
+
+// Holds the paths of one vertex pair within a memory budget. Paths are kept
+// compactly in memory (a vertex count and one byte per vertex); once they
+// take more than the budget, or the process grows past the RSS limit, the
+// buffer is sorted and spilled to a temporary file as a run. Iteration
+// merges the runs, so paths come out sorted by vertex sequence whether or
+// not anything was spilled.
+class path_spool
+{
+public:
+	explicit path_spool(std::size_t budget, std::size_t rss_limit = 0);
+	~path_spool();
+
+	path_spool(const path_spool&) = delete;
+	path_spool& operator=(const path_spool&) = delete;
+
+	void add(const edge_path& p);
+
+	void for_each(const std::function<void(const edge_path&)>& f);
+
+	void clear();
+
+	index_t size() const { return count_; }
+	bool empty() const { return count_ == 0; }
+
+	// Largest number of bytes held in memory at any time.
+	std::size_t peak_bytes() const { return peak_; }
+
+	index_t num_runs() const { return runs_.size(); }
+
+private:
+	std::size_t memory_bytes() const;
+	void sort_buffer();
+	void spill();
+
+	std::size_t budget_;
+	std::size_t rss_limit_;
+	index_t count_;
+	std::size_t peak_;
+
+	std::vector<unsigned char> buffer_;
+	std::vector<std::size_t> offsets_;
+	std::vector<std::FILE*> runs_;
+};
+
+// Text a writer has to hold back until its header is written. It is kept in
+// memory and moved to a temporary file whenever it has grown past the budget
+// (0 keeps it all in memory); copy_to writes it out in order.
+class text_spool
+{
+public:
+	explicit text_spool(std::size_t budget = 0) : budget_(budget), spill_(nullptr) { }
+	~text_spool();
+
+	text_spool(const text_spool&) = delete;
+	text_spool& operator=(const text_spool&) = delete;
+
+	void set_budget(std::size_t budget) { budget_ = budget; }
+
+	// The stream to append to, spilling what it holds first if over budget.
+	std::ostream& stream();
+
+	// Writes everything appended so far to os and starts over.
+	void copy_to(std::ostream& os);
+
+	bool has_spilled() const { return spill_ != nullptr; }
+
+private:
+	std::size_t budget_;
+	std::stringstream buffer_;
+	std::FILE* spill_;
+};
+
+// Per-pair counters collected by a writer with a memory budget.
+struct pair_statistics
+{
+	index_t u;
+	index_t v;
+	index_t paths;
+	std::size_t peak_bytes;
+	index_t runs;
+};
+
+#endif
@@ -0,0 +1,597 @@
+// path_zdd.cpp
+#include "path_zdd.hpp"
+#include "edge_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+const index_t zdd::EMPTY;
+const index_t zdd::BASE;
+
+namespace
+{
+	// Frontier states of the Simpath construction: per vertex, the other end
+	// of the partial path it ends, itself while unused, INNER once it can take
+	// no more edges, and OUT before it enters and after it leaves the frontier.
+	// The last byte is the number of edges used.
+	const char INNER = -1;
+	const char OUT = -2;
+
+	// Where an edge decision leads: a state of the next layer, or a terminal,
+	// plus the internal vertices decided on the way there.
+	struct transition
+	{
+		static const index_t TO_EMPTY = -1;
+		static const index_t TO_BASE = -2;
+
+		index_t state;
+		std::uint64_t inner;
+	};
+
+	class simpath
+	{
+	public:
+		simpath(const graph& g, index_t s, index_t t, index_t length)
+			: g_(g), s_(s), t_(t), length_(length), n_(g.num_vertices()), m_(g.num_edges()),
+			first_(n_, -1), last_(n_, -1)
+		{
+			for (index_t e = 0; e < m_; ++e)
+			{
+				for (index_t v : { g.edges_[2 * e], g.edges_[2 * e + 1] })
+				{
+					if (first_[v] == -1)
+						first_[v] = e;
+
+					last_[v] = e;
+				}
+			}
+		}
+
+		index_t first(index_t v) const { return first_[v]; }
+		index_t last(index_t v) const { return last_[v]; }
+
+		// The states left after deciding edge e in state, both ways.
+		void step(index_t e, std::string state, std::string& lo, transition& lo_to, std::string& hi, transition& hi_to) const
+		{
+			for (index_t v = 0; v < n_; ++v)
+			{
+				if (first_[v] == e)
+					state[v] = static_cast<char>(v);
+			}
+
+			lo = state;
+			lo_to = leave(e, lo);
+
+			hi = state;
+			hi_to = add_edge(e, hi);
+
+			if (hi_to.state == 0)
+				hi_to = leave(e, hi);
+		}
+
+	private:
+		bool is_terminal(index_t v) const { return v == s_ || v == t_; }
+
+		// Takes edge e; state 0 means the path goes on.
+		transition add_edge(index_t e, std::string& state) const
+		{
+			const index_t x = g_.edges_[2 * e];
+			const index_t y = g_.edges_[2 * e + 1];
+			const index_t used = static_cast<unsigned char>(state[n_]) + 1;
+
+			if (state[x] == INNER || state[y] == INNER || used > length_)
+				return transition{ transition::TO_EMPTY, 0 };
+
+			// The far ends of the partial paths at x and y.
+			const index_t a = state[x];
+			const index_t b = state[y];
+
+			if (a == y)
+				return transition{ transition::TO_EMPTY, 0 };
+
+			state[n_] = static_cast<char>(used);
+
+			for (index_t v : { x, y })
+			{
+				// A vertex that already ended a path is now inner.
+				if (state[v] != v)
+					state[v] = INNER;
+			}
+
+			for (auto end : { std::make_pair(a, b), std::make_pair(b, a) })
+			{
+				if (state[end.first] == OUT)
+					continue;
+
+				// s and t take a single edge.
+				state[end.first] = is_terminal(end.first) ? INNER : static_cast<char>(end.second);
+			}
+
+			if (!(is_terminal(a) && is_terminal(b)))
+				return transition{ 0, 0 };
+
+			// The s-t path is complete; no other partial path may be left.
+			std::uint64_t inner = 0;
+
+			for (index_t v = 0; v < n_; ++v)
+			{
+				if (state[v] == OUT || is_terminal(v))
+					continue;
+
+				if (state[v] == INNER)
+					inner |= (1ULL << v);
+				else if (state[v] != v)
+					return transition{ transition::TO_EMPTY, 0 };
+			}
+
+			return transition{ transition::TO_BASE, inner };
+		}
+
+		// Drops the vertices whose last edge is e from the frontier.
+		transition leave(index_t e, std::string& state) const
+		{
+			std::uint64_t inner = 0;
+
+			for (index_t v = 0; v < n_; ++v)
+			{
+				if (last_[v] != e)
+					continue;
+
+				if (is_terminal(v))
+				{
+					if (state[v] != INNER)
+						return transition{ transition::TO_EMPTY, 0 };
+				}
+				else if (state[v] == INNER)
+				{
+					inner |= (1ULL << v);
+				}
+				else if (state[v] != v)
+				{
+					// A partial path ends here for good.
+					return transition{ transition::TO_EMPTY, 0 };
+				}
+
+				state[v] = OUT;
+			}
+
+			// Nothing completes after the last edge.
+			if (e == m_ - 1)
+				return transition{ transition::TO_EMPTY, 0 };
+
+			return transition{ 0, inner };
+		}
+
+		const graph& g_;
+		index_t s_;
+		index_t t_;
+		index_t length_;
+		index_t n_;
+		index_t m_;
+		std::vector<index_t> first_;
+		std::vector<index_t> last_;
+	};
+}
+
+zdd::zdd(const std::vector<index_t>& labels)
+	: labels_(labels), nodes_(2, node{ 0, 0, 0 }), root_(EMPTY)
+{
+
+}
+
+index_t zdd::make(index_t level, index_t lo, index_t hi)
+{
+	if (hi == EMPTY)
+		return lo;
+
+	assert(level < this->level(lo) && level < this->level(hi));
+
+	const auto it = unique_.emplace(key_type(level, lo, hi), nodes_.size());
+
+	if (it.second)
+		nodes_.push_back(node{ level, lo, hi });
+
+	return it.first->second;
+}
+
+std::vector<index_t> zdd::get_nodes() const
+{
+	std::vector<char> seen(nodes_.size(), 0);
+	std::vector<index_t> stack(1, root_);
+	std::vector<index_t> found;
+
+	while (!stack.empty())
+	{
+		const index_t f = stack.back();
+		stack.pop_back();
+
+		if (f <= BASE || seen[f])
+			continue;
+
+		seen[f] = 1;
+		found.emplace_back(f);
+		stack.emplace_back(nodes_[f].lo);
+		stack.emplace_back(nodes_[f].hi);
+	}
+
+	// Children are made before their parents.
+	std::sort(found.begin(), found.end());
+	return found;
+}
+
+std::uint64_t zdd::count() const
+{
+	const std::uint64_t unknown = std::numeric_limits<std::uint64_t>::max() - 1;
+	std::vector<std::uint64_t> counts(nodes_.size(), unknown);
+	counts[EMPTY] = 0;
+	counts[BASE] = 1;
+
+	// Children have larger levels, and were made before their parents.
+	for (std::size_t f = 2; f < nodes_.size(); ++f)
+	{
+		const std::uint64_t lo = counts[nodes_[f].lo];
+		const std::uint64_t hi = counts[nodes_[f].hi];
+		counts[f] = (lo > std::numeric_limits<std::uint64_t>::max() - hi) ? std::numeric_limits<std::uint64_t>::max() : lo + hi;
+	}
+
+	return counts[root_];
+}
+
+bool zdd::has_empty_set(index_t f) const
+{
+	while (f > BASE)
+		f = nodes_[f].lo;
+
+	return f == BASE;
+}
+
+index_t zdd::unite(index_t f, index_t g, pair_memo& memo)
+{
+	if (f == EMPTY || f == g)
+		return g;
+
+	if (g == EMPTY)
+		return f;
+
+	if (f > g)
+		std::swap(f, g);
+
+	const auto key = std::make_pair(f, g);
+	const auto it = memo.find(key);
+
+	if (it != memo.end())
+		return it->second;
+
+	const index_t lf = level(f);
+	const index_t lg = level(g);
+	const node a = f <= BASE ? node{ lf, f, EMPTY } : nodes_[f];
+	const node b = g <= BASE ? node{ lg, g, EMPTY } : nodes_[g];
+	index_t result;
+
+	if (lf < lg)
+		result = make(lf, unite(a.lo, g, memo), a.hi);
+	else if (lg < lf)
+		result = make(lg, unite(f, b.lo, memo), b.hi);
+	else
+		result = make(lf, unite(a.lo, b.lo, memo), unite(a.hi, b.hi, memo));
+
+	memo[key] = result;
+	return result;
+}
+
+index_t zdd::nonsup(index_t f, index_t g, pair_memo& memo)
+{
+	if (g == EMPTY || f == EMPTY)
+		return f;
+
+	if (f == g || has_empty_set(g))
+		return EMPTY;
+
+	// Only the empty set is left in f, and g has no subset of it.
+	if (f == BASE)
+		return BASE;
+
+	const auto key = std::make_pair(f, g);
+	const auto it = memo.find(key);
+
+	if (it != memo.end())
+		return it->second;
+
+	const index_t lf = level(f);
+	const index_t lg = level(g);
+	const node a = nodes_[f];
+	index_t result;
+
+	if (lg < lf)
+	{
+		// No set of f has the element, so the sets of g with it are no subsets.
+		result = nonsup(f, nodes_[g].lo, memo);
+	}
+	else if (lf < lg)
+	{
+		result = make(lf, nonsup(a.lo, g, memo), nonsup(a.hi, g, memo));
+	}
+	else
+	{
+		const node b = nodes_[g];
+		const index_t lo = nonsup(a.lo, b.lo, memo);
+		const index_t hi = nonsup(nonsup(a.hi, b.lo, memo), b.hi, memo);
+		result = make(lf, lo, hi);
+	}
+
+	memo[key] = result;
+	return result;
+}
+
+index_t zdd::minimal(index_t f, std::map<index_t, index_t>& memo, pair_memo& nonsup_memo)
+{
+	if (f <= BASE)
+		return f;
+
+	const auto it = memo.find(f);
+
+	if (it != memo.end())
+		return it->second;
+
+	// A set with the element can only contain sets of the lo family without it.
+	const node a = nodes_[f];
+	const index_t lo = minimal(a.lo, memo, nonsup_memo);
+	const index_t hi = nonsup(minimal(a.hi, memo, nonsup_memo), lo, nonsup_memo);
+	const index_t result = make(a.level, lo, hi);
+
+	memo[f] = result;
+	return result;
+}
+
+zdd zdd::minimal() const
+{
+	zdd result(*this);
+	std::map<index_t, index_t> memo;
+	pair_memo nonsup_memo;
+
+	result.root_ = result.minimal(root_, memo, nonsup_memo);
+	return result;
+}
+
+bool zdd::any_rainbow(index_t f, std::uint64_t used, const std::vector<index_t>& colours, std::set<std::pair<index_t, std::uint64_t>>& failed) const
+{
+	if (f <= BASE)
+		return f == BASE;
+
+	if (failed.count(std::make_pair(f, used)) != 0)
+		return false;
+
+	const node& a = nodes_[f];
+	const std::uint64_t colour = 1ULL << colours[labels_[a.level]];
+
+	if ((used & colour) == 0 && any_rainbow(a.hi, used | colour, colours, failed))
+		return true;
+
+	if (any_rainbow(a.lo, used, colours, failed))
+		return true;
+
+	failed.emplace(f, used);
+	return false;
+}
+
+bool zdd::any_rainbow(const std::vector<index_t>& colours) const
+{
+	std::set<std::pair<index_t, std::uint64_t>> failed;
+	return any_rainbow(root_, 0, colours, failed);
+}
+
+index_t zdd::project(index_t f, const std::vector<char>& dropped, std::map<index_t, index_t>& memo, pair_memo& unite_memo)
+{
+	if (f <= BASE)
+		return f;
+
+	const auto it = memo.find(f);
+
+	if (it != memo.end())
+		return it->second;
+
+	const node a = nodes_[f];
+	const index_t lo = project(a.lo, dropped, memo, unite_memo);
+	const index_t hi = project(a.hi, dropped, memo, unite_memo);
+	const index_t result = dropped[a.level] ? unite(lo, hi, unite_memo) : make(a.level, lo, hi);
+
+	memo[f] = result;
+	return result;
+}
+
+zdd build_path_zdd(const graph& g, index_t s, index_t t, index_t length, bool vertices)
+{
+	assert(s != t);
+
+	const index_t n = g.num_vertices();
+	const index_t m = g.num_edges();
+	const simpath sp(g, s, t, std::min(length, n - 1));
+
+	// Levels: every edge, each followed by the vertices it is the last edge of.
+	std::vector<index_t> labels;
+	std::vector<index_t> edge_level(m);
+	std::vector<index_t> vertex_level(n, -1);
+
+	for (index_t e = 0; e < m; ++e)
+	{
+		edge_level[e] = labels.size();
+		labels.emplace_back(e);
+
+		for (index_t v = 0; vertices && v < n; ++v)
+		{
+			if (sp.last(v) == e)
+			{
+				vertex_level[v] = labels.size();
+				labels.emplace_back(m + v);
+			}
+		}
+	}
+
+	zdd z(labels);
+
+	if (sp.first(s) == -1 || sp.first(t) == -1)
+		return z;
+
+	// Top-down: the distinct states of every layer and where they lead.
+	std::vector<std::vector<std::pair<transition, transition>>> layers(m);
+	std::vector<std::string> states(1, std::string(n, OUT) + '\0');
+
+	for (index_t e = 0; e < m && !states.empty(); ++e)
+	{
+		std::unordered_map<std::string, index_t> index_of;
+		std::vector<std::string> next;
+		std::string lo, hi;
+
+		for (const auto& state : states)
+		{
+			transition lo_to, hi_to;
+			sp.step(e, state, lo, lo_to, hi, hi_to);
+
+			for (auto to : { std::make_pair(&lo_to, &lo), std::make_pair(&hi_to, &hi) })
+			{
+				if (to.first->state != 0)
+					continue;
+
+				const auto it = index_of.emplace(*to.second, next.size());
+
+				if (it.second)
+					next.emplace_back(*to.second);
+
+				to.first->state = it.first->second;
+			}
+
+			layers[e].emplace_back(lo_to, hi_to);
+		}
+
+		states.swap(next);
+	}
+
+	// Bottom-up: the reduced node of every state.
+	std::vector<index_t> ids;
+	std::vector<index_t> next_ids;
+
+	auto resolve = [&](const transition& to)
+	{
+		index_t f = to.state >= 0 ? next_ids[to.state] : (to.state == transition::TO_BASE ? zdd::BASE : zdd::EMPTY);
+
+		if (!vertices)
+			return f;
+
+		// Internal vertices, deepest level first.
+		std::vector<index_t> inner;
+		for (std::uint64_t x = to.inner; x != 0; x &= x - 1)
+			inner.emplace_back(vertex_level[ctz64(x)]);
+
+		std::sort(inner.rbegin(), inner.rend());
+
+		for (auto level : inner)
+			f = z.make(level, zdd::EMPTY, f);
+
+		return f;
+	};
+
+	for (index_t e = m - 1; e >= 0; --e)
+	{
+		ids.clear();
+
+		for (const auto& node : layers[e])
+		{
+			const index_t lo = resolve(node.first);
+			const index_t hi = resolve(node.second);
+			ids.emplace_back(z.make(edge_level[e], lo, hi));
+		}
+
+		next_ids.swap(ids);
+	}
+
+	z.set_root(next_ids.empty() ? zdd::EMPTY : next_ids[0]);
+	return z;
+}
+
+zdd_checker::zdd_checker(const graph& g, index_t k, bool shortest, bool total)
+	: elements_(total ? g.num_edges() + g.num_vertices() : g.num_edges())
+{
+	const index_t n = g.num_vertices();
+	const index_t length = total ? (k + 1) / 2 : k;
+
+	for (index_t u = 0; u < n; ++u)
+	{
+		std::vector<index_t> dist(n, 0);
+
+		if (shortest)
+			bfs(g, dist, u);
+
+		for (index_t v = u + 1; v < n; ++v)
+		{
+			if (is_adjacent(g, u, v))
+				continue;
+
+			// An unreachable v has distance 0, which admits no path.
+			pairs_.emplace_back(u, v);
+			zdds_.emplace_back(build_path_zdd(g, u, v, shortest ? dist[v] : length, total));
+		}
+	}
+}
+
+std::vector<index_t> zdd_checker::get_elements(index_t i) const
+{
+	const zdd& z = zdds_[i];
+	std::vector<index_t> elements;
+
+	for (auto f : z.get_nodes())
+		elements.emplace_back(z.label(z.get_level(f)));
+
+	std::sort(elements.begin(), elements.end());
+	elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+	return elements;
+}
+
+index_t zdd_checker::count_violations(const std::vector<index_t>& colours) const
+{
+	index_t violations = 0;
+
+	for (const auto& z : zdds_)
+	{
+		if (!z.any_rainbow(colours))
+			++violations;
+	}
+
+	return violations;
+}
+
+std::vector<std::pair<index_t, index_t>> zdd_checker::find_violations(const std::vector<index_t>& colours) const
+{
+	std::vector<std::pair<index_t, index_t>> violations;
+
+	for (index_t i = 0; i < num_pairs(); ++i)
+	{
+		if (!zdds_[i].any_rainbow(colours))
+			violations.emplace_back(pairs_[i]);
+	}
+
+	return violations;
+}
+
+void zdd_path_source::get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	const edge_index index(g);
+	const zdd z = build_path_zdd(g, s, t, length);
+
+	z.for_each([&](const std::vector<index_t>& ids)
+	{
+		paths.emplace_back(to_edge_path(index, s, ids));
+	});
+}
+
+void zdd_path_source::get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	std::vector<index_t> dist(g.num_vertices(), 0);
+	bfs(g, dist, s);
+
+	// No path is shorter than a geodesic.
+	if (dist[t] > 0)
+		get_paths(g, s, t, paths, dist[t]);
+}
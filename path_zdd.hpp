@@ -0,0 +1,206 @@
+// path_zdd.hpp
+#ifndef PATH_ZDD_HPP
+#define PATH_ZDD_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A zero-suppressed decision diagram: a family of sets of element ids. Each
+// level decides one element, in a fixed order; node 0 is the empty family and
+// node 1 the family holding only the empty set. Nodes are shared, and no node
+// has 0 as its hi child.
+class zdd
+{
+public:
+	static const index_t EMPTY = 0;
+	static const index_t BASE = 1;
+
+	// The element decided at every level.
+	explicit zdd(const std::vector<index_t>& labels);
+
+	index_t num_levels() const { return labels_.size(); }
+	index_t label(index_t level) const { return labels_[level]; }
+
+	index_t get_root() const { return root_; }
+	void set_root(index_t root) { root_ = root; }
+
+	// The reduced node for (level, lo, hi).
+	index_t make(index_t level, index_t lo, index_t hi);
+
+	// Nodes reachable from the root, terminals excluded.
+	index_t size() const { return get_nodes().size(); }
+
+	// The same nodes by increasing id, which puts every node after its
+	// children.
+	std::vector<index_t> get_nodes() const;
+
+	// Level and children of a node that is not a terminal.
+	index_t get_level(index_t f) const { return nodes_[f].level; }
+	index_t get_lo(index_t f) const { return nodes_[f].lo; }
+	index_t get_hi(index_t f) const { return nodes_[f].hi; }
+
+	// Number of sets (saturating).
+	std::uint64_t count() const;
+
+	// Calls visit(const std::vector<index_t>& elements) for every set, the
+	// elements in level order.
+	template <typename Visitor>
+	void for_each(Visitor visit) const
+	{
+		std::vector<index_t> elements;
+		visit_sets(root_, elements, visit);
+	}
+
+	// The sets with no proper subset in the family.
+	zdd minimal() const;
+
+	// Whether some set has pairwise different colours, with colours[e] in
+	// 1..63 for every element e. Works on the nodes with the colours used so
+	// far, so the sets are never listed; the cost grows with the nodes times
+	// the colour subsets met at each.
+	bool any_rainbow(const std::vector<index_t>& colours) const;
+
+	// The family with only the elements for which keep(element) holds left in
+	// every set.
+	template <typename Predicate>
+	zdd project(Predicate keep) const
+	{
+		zdd result(*this);
+		std::vector<char> dropped(labels_.size());
+
+		for (index_t level = 0; level < num_levels(); ++level)
+			dropped[level] = !keep(labels_[level]);
+
+		std::map<index_t, index_t> memo;
+		pair_memo unite_memo;
+		result.root_ = result.project(root_, dropped, memo, unite_memo);
+		return result;
+	}
+
+private:
+	struct node
+	{
+		index_t level;
+		index_t lo;
+		index_t hi;
+	};
+
+	typedef std::tuple<index_t, index_t, index_t> key_type;
+	typedef std::map<std::pair<index_t, index_t>, index_t> pair_memo;
+
+	struct key_hash
+	{
+		std::size_t operator()(const key_type& key) const
+		{
+			std::uint64_t h = std::get<0>(key);
+			h = h * 0x9e3779b97f4a7c15ULL ^ std::get<1>(key);
+			h = h * 0x9e3779b97f4a7c15ULL ^ std::get<2>(key);
+			return h ^ (h >> 29);
+		}
+	};
+
+	index_t level(index_t f) const { return f <= BASE ? num_levels() : nodes_[f].level; }
+
+	template <typename Visitor>
+	void visit_sets(index_t f, std::vector<index_t>& elements, Visitor& visit) const
+	{
+		if (f == EMPTY)
+			return;
+
+		if (f == BASE)
+		{
+			visit(static_cast<const std::vector<index_t>&>(elements));
+			return;
+		}
+
+		visit_sets(nodes_[f].lo, elements, visit);
+
+		elements.emplace_back(labels_[nodes_[f].level]);
+		visit_sets(nodes_[f].hi, elements, visit);
+		elements.pop_back();
+	}
+
+	bool has_empty_set(index_t f) const;
+	index_t unite(index_t f, index_t g, pair_memo& memo);
+
+	// The sets of f that contain no set of g.
+	index_t nonsup(index_t f, index_t g, pair_memo& memo);
+
+	index_t minimal(index_t f, std::map<index_t, index_t>& memo, pair_memo& nonsup_memo);
+	bool any_rainbow(index_t f, std::uint64_t used, const std::vector<index_t>& colours, std::set<std::pair<index_t, std::uint64_t>>& failed) const;
+	index_t project(index_t f, const std::vector<char>& dropped, std::map<index_t, index_t>& memo, pair_memo& unite_memo);
+
+	std::vector<index_t> labels_;
+	std::vector<node> nodes_;
+	std::unordered_map<key_type, index_t, key_hash> unique_;
+	index_t root_;
+};
+
+// The edge sets of the simple s-t paths with at most length edges, built
+// frontier by frontier over the edges in graph::edges_ order (Knuth's
+// Simpath): a ZDD node is a state of the vertices still to be touched by a
+// later edge, namely which are unused, which are inner or finished, and which
+// end a partial path at which other vertex, together with the number of
+// edges used so far. Elements are edge ids. With vertices set the internal vertices m + v
+// are included too, which gives the element sets of make_total_checker; each
+// vertex is decided right after its last edge.
+zdd build_path_zdd(const graph& g, index_t s, index_t t, index_t length, bool vertices = false);
+
+// Path ZDDs for every non-adjacent pair of a graph, in next_pair order: the
+// counterpart of rainbow_checker for graphs whose pairs have too many paths
+// to list. Pairs are checked with zdd::any_rainbow, so colours go up to 63.
+class zdd_checker
+{
+public:
+	// Paths of at most k edges, or only the geodesics if shortest is set.
+	// With total the sets are the element ids of make_total_checker, of paths
+	// with at most (k + 1) / 2 edges.
+	zdd_checker(const graph& g, index_t k, bool shortest = false, bool total = false);
+
+	index_t num_pairs() const { return pairs_.size(); }
+	index_t num_elements() const { return elements_; }
+	std::pair<index_t, index_t> get_pair(index_t i) const { return pairs_[i]; }
+	const zdd& get_zdd(index_t i) const { return zdds_[i]; }
+
+	// The elements on some path of pair i, increasing.
+	std::vector<index_t> get_elements(index_t i) const;
+
+	// Whether pair i has a rainbow path; colours[x] is the colour of element x.
+	bool is_satisfied(index_t i, const std::vector<index_t>& colours) const { return zdds_[i].any_rainbow(colours); }
+
+	index_t count_violations(const std::vector<index_t>& colours) const;
+
+	// The pairs without a rainbow path, as find_violations (or
+	// find_total_violations) gives them.
+	std::vector<std::pair<index_t, index_t>> find_violations(const std::vector<index_t>& colours) const;
+
+private:
+	index_t elements_;
+	std::vector<std::pair<index_t, index_t>> pairs_;
+	std::vector<zdd> zdds_;
+};
+
+// Paths read off a path ZDD per pair (with to_edge_path). A convenience
+// adapter for comparing against list_paths: it builds the ZDD of every pair
+// it is asked for and expands it into explicit paths, so it saves nothing
+// over enumerating them. Use the ZDD itself (zdd_checker, or the zdd path
+// encoding of the MiniZinc writer) to avoid the expansion.
+class zdd_path_source : public path_source
+{
+public:
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+};
+
+#endif
@@ -0,0 +1,384 @@
+// rainbow_kernel.cpp
+#include "rainbow_kernel.hpp"
+#include "single_source.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#if defined(__AVX512F__)
+	const index_t LANES = 16;
+#elif defined(__AVX2__)
+	const index_t LANES = 8;
+#else
+	const index_t LANES = 1;
+#endif
+
+	// Paths checked per gather.
+	const index_t GATHER_LANES = 8;
+
+	// Rows and batches are padded to this many lanes whatever the kernel.
+	const index_t BLOCK = 16;
+
+	// Variable shifts by 32 or more give zero, so this shift sets no bit.
+	const std::int32_t NO_BIT = 32;
+
+	// Colours that fit in a 32-bit lane.
+	const index_t SIMD_COLOURS = 32;
+
+	index_t round_up(index_t x, index_t multiple)
+	{
+		return (x + multiple - 1) / multiple * multiple;
+	}
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+	bool use_simd(index_t max_colour)
+	{
+		return max_colour <= SIMD_COLOURS;
+	}
+#endif
+}
+
+const char* rainbow_kernel_name()
+{
+#if defined(__AVX512F__)
+	return "avx512";
+#elif defined(__AVX2__)
+	return "avx2";
+#else
+	return "scalar";
+#endif
+}
+
+packed_colouring::packed_colouring(const std::vector<index_t>& colours)
+	: shifts_(colours.size() + 1, NO_BIT), max_colour_(0)
+{
+	for (std::size_t e = 0; e < colours.size(); ++e)
+	{
+		assert(colours[e] >= 1 && colours[e] <= 64);
+		shifts_[e] = static_cast<std::int32_t>(colours[e] - 1);
+		max_colour_ = std::max(max_colour_, colours[e]);
+	}
+}
+
+void packed_colouring::set(index_t e, index_t colour)
+{
+	assert(e >= 0 && e < num_edges());
+	assert(colour >= 1 && colour <= 64);
+	shifts_[e] = static_cast<std::int32_t>(colour - 1);
+	max_colour_ = std::max(max_colour_, colour);
+}
+
+colouring_batch::colouring_batch(index_t num_edges, index_t capacity)
+	: edges_(num_edges), size_(capacity), lanes_(round_up(capacity, BLOCK)), max_colour_(0),
+	shifts_(num_edges * lanes_, NO_BIT)
+{
+
+}
+
+void colouring_batch::set(index_t b, const std::vector<index_t>& colours)
+{
+	assert(b < size_);
+	assert(static_cast<index_t>(colours.size()) == edges_);
+
+	for (index_t e = 0; e < edges_; ++e)
+	{
+		assert(colours[e] >= 1 && colours[e] <= 64);
+		shifts_[e * lanes_ + b] = static_cast<std::int32_t>(colours[e] - 1);
+		max_colour_ = std::max(max_colour_, colours[e]);
+	}
+}
+
+path_matrix::path_matrix(const std::vector<std::vector<index_t>>& paths, index_t num_edges)
+	: paths_(paths.size()), stride_(round_up(paths_, BLOCK)), width_(0), pad_(num_edges)
+{
+	std::vector<index_t> order(paths_);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&paths](index_t a, index_t b)
+	{
+		return paths[a].size() < paths[b].size();
+	});
+
+	for (const auto& p : paths)
+		width_ = std::max(width_, static_cast<index_t>(p.size()));
+
+	columns_.assign(width_ * stride_, static_cast<std::int32_t>(pad_));
+	lengths_.assign(stride_, 0);
+	block_widths_.assign(stride_ / BLOCK, 0);
+
+	for (index_t row = 0; row < paths_; ++row)
+	{
+		const std::vector<index_t>& p = paths[order[row]];
+
+		for (std::size_t j = 0; j < p.size(); ++j)
+		{
+			assert(p[j] >= 0 && p[j] < num_edges);
+			columns_[j * stride_ + row] = static_cast<std::int32_t>(p[j]);
+		}
+
+		lengths_[row] = static_cast<std::int32_t>(p.size());
+		block_widths_[row / BLOCK] = lengths_[row];
+	}
+}
+
+index_t path_matrix::find_rainbow(const packed_colouring& c) const
+{
+	assert(c.num_edges() == pad_);
+	const std::int32_t* shifts = c.data();
+
+#if defined(__AVX2__)
+	// 16-lane gathers are no faster than two 8-lane ones, so the AVX2 kernel
+	// is used here even when AVX-512 is available.
+	if (c.max_colour() <= SIMD_COLOURS)
+	{
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i zero = _mm256_setzero_si256();
+
+		for (index_t p = 0; p < paths_; p += GATHER_LANES)
+		{
+			__m256i seen = zero;
+			__m256i dup = zero;
+
+			for (index_t j = 0, w = block_widths_[p / BLOCK]; j < w; ++j)
+			{
+				const __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&columns_[j * stride_ + p]));
+				const __m256i bits = _mm256_sllv_epi32(one, _mm256_i32gather_epi32(shifts, ids, 4));
+				dup = _mm256_or_si256(dup, _mm256_and_si256(seen, bits));
+				seen = _mm256_or_si256(seen, bits);
+			}
+
+			index_t rainbow = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(dup, zero)));
+
+			if (paths_ - p < GATHER_LANES)
+				rainbow &= (1LL << (paths_ - p)) - 1;
+
+			if (rainbow != 0)
+				return p + ctz64(rainbow);
+		}
+
+		return -1;
+	}
+#endif
+
+	// A path is rainbow if its colour mask has as many bits as it has edges.
+	for (index_t p = 0; p < paths_; ++p)
+	{
+		std::uint64_t mask = 0;
+
+		for (index_t j = 0; j < lengths_[p]; ++j)
+			mask |= (1ULL << shifts[columns_[j * stride_ + p]]);
+
+		if (popcount64(mask) == lengths_[p])
+			return p;
+	}
+
+	return -1;
+}
+
+void path_matrix::any_rainbow(const colouring_batch& batch, std::vector<char>& satisfied) const
+{
+	assert(batch.num_edges() == pad_);
+	assert(static_cast<index_t>(satisfied.size()) >= batch.size());
+
+	const index_t size = batch.size();
+
+#if defined(__AVX512F__)
+	if (use_simd(batch.max_colour()))
+	{
+		const __m512i one = _mm512_set1_epi32(1);
+		const __m512i zero = _mm512_setzero_si512();
+
+		for (index_t b = 0; b < size; b += LANES)
+		{
+			// Lanes past the end of the batch are masked off.
+			const index_t live = std::min(LANES, size - b);
+			const index_t all = (1LL << live) - 1;
+			index_t done = 0;
+
+			for (index_t i = 0; i < live; ++i)
+				done |= static_cast<index_t>(satisfied[b + i] != 0) << i;
+
+			for (index_t p = 0; p < paths_ && done != all; ++p)
+			{
+				__m512i seen = zero;
+				__m512i dup = zero;
+
+				for (index_t j = 0; j < lengths_[p]; ++j)
+				{
+					const __m512i bits = _mm512_sllv_epi32(one, _mm512_loadu_si512(batch.row(columns_[j * stride_ + p]) + b));
+					dup = _mm512_or_si512(dup, _mm512_and_si512(seen, bits));
+					seen = _mm512_or_si512(seen, bits);
+				}
+
+				done |= _mm512_cmpeq_epi32_mask(dup, zero) & all;
+			}
+
+			for (index_t i = 0; i < live; ++i)
+				satisfied[b + i] = bittest64(done, i);
+		}
+
+		return;
+	}
+#elif defined(__AVX2__)
+	if (use_simd(batch.max_colour()))
+	{
+		const __m256i one = _mm256_set1_epi32(1);
+		const __m256i zero = _mm256_setzero_si256();
+
+		for (index_t b = 0; b < size; b += LANES)
+		{
+			// Lanes past the end of the batch are masked off.
+			const index_t live = std::min(LANES, size - b);
+			const index_t all = (1LL << live) - 1;
+			index_t done = 0;
+
+			for (index_t i = 0; i < live; ++i)
+				done |= static_cast<index_t>(satisfied[b + i] != 0) << i;
+
+			for (index_t p = 0; p < paths_ && done != all; ++p)
+			{
+				__m256i seen = zero;
+				__m256i dup = zero;
+
+				for (index_t j = 0; j < lengths_[p]; ++j)
+				{
+					const __m256i shifts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(batch.row(columns_[j * stride_ + p]) + b));
+					const __m256i bits = _mm256_sllv_epi32(one, shifts);
+					dup = _mm256_or_si256(dup, _mm256_and_si256(seen, bits));
+					seen = _mm256_or_si256(seen, bits);
+				}
+
+				done |= _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(dup, zero))) & all;
+			}
+
+			for (index_t i = 0; i < live; ++i)
+				satisfied[b + i] = bittest64(done, i);
+		}
+
+		return;
+	}
+#endif
+
+	for (index_t b = 0; b < size; ++b)
+	{
+		for (index_t p = 0; p < paths_ && !satisfied[b]; ++p)
+		{
+			std::uint64_t mask = 0;
+
+			for (index_t j = 0; j < lengths_[p]; ++j)
+				mask |= (1ULL << batch.row(columns_[j * stride_ + p])[b]);
+
+			satisfied[b] = (popcount64(mask) == lengths_[p]);
+		}
+	}
+}
+
+rainbow_checker::rainbow_checker(const graph& g, index_t length, bool shortest, path_source* source, bool total)
+	: index_(g), elements_(total ? g.num_edges() + g.num_vertices() : g.num_edges())
+{
+	std::vector<std::pair<index_t, index_t>> pairs;
+	index_t u = 0;
+	index_t v = 1;
+	const index_t n = g.num_vertices();
+
+	for (index_t i = 0; i < nchoosek(n, 2); ++i)
+	{
+		if (!is_adjacent(g, u, v))
+			pairs.emplace_back(u, v);
+
+		next_pair(u, v, n);
+	}
+
+	add_pairs(g, pairs, length, shortest, source, total);
+}
+
+rainbow_checker::rainbow_checker(const graph& g, index_t k, const std::vector<std::pair<index_t, index_t>>& pairs, bool shortest, path_source* source)
+	: index_(g), elements_(g.num_edges())
+{
+	add_pairs(g, pairs, k, shortest, source, false);
+}
+
+void rainbow_checker::add_pairs(const graph& g, const std::vector<std::pair<index_t, index_t>>& pairs, index_t length, bool shortest, path_source* source, bool total)
+{
+	single_source_path_source single_source;
+
+	if (source == nullptr)
+		source = &single_source;
+
+	for (const auto& pair : pairs)
+	{
+		const index_t u = pair.first;
+		const index_t v = pair.second;
+		assert(u < v && !is_adjacent(g, u, v));
+
+		std::vector<edge_path> paths;
+
+		if (shortest)
+			source->get_shortest_paths(g, u, v, paths);
+		else
+			source->get_paths(g, u, v, paths, length);
+
+		std::vector<std::vector<index_t>> ids;
+		ids.reserve(paths.size());
+
+		for (const auto& p : paths)
+			ids.emplace_back(total ? to_total_ids(index_, p) : index_.to_ids(p));
+
+		pairs_.emplace_back(u, v);
+		paths_.emplace_back(ids, elements_);
+	}
+}
+
+std::vector<index_t> to_total_ids(const edge_index& index, const edge_path& p)
+{
+	std::vector<index_t> ids = index.to_ids(p);
+
+	for (auto it = p.cbegin() + 1; it + 1 < p.cend(); ++it)
+		ids.emplace_back(index.size() + *it);
+
+	return ids;
+}
+
+rainbow_checker make_total_checker(const graph& g, index_t k, path_source* source)
+{
+	return rainbow_checker(g, (k + 1) / 2, false, source, true);
+}
+
+rainbow_checker make_hybrid_checker(const graph& g, index_t k, path_source* source)
+{
+	return rainbow_checker(g, k, false, source, true);
+}
+
+index_t rainbow_checker::count_violations(const packed_colouring& c) const
+{
+	index_t violations = 0;
+
+	for (const auto& p : paths_)
+	{
+		if (!p.any_rainbow(c))
+			++violations;
+	}
+
+	return violations;
+}
+
+void rainbow_checker::count_violations(const colouring_batch& batch, std::vector<index_t>& violations) const
+{
+	violations.assign(batch.size(), 0);
+	std::vector<char> satisfied(batch.size());
+
+	for (const auto& p : paths_)
+	{
+		std::fill(satisfied.begin(), satisfied.end(), 0);
+		p.any_rainbow(batch, satisfied);
+
+		for (index_t b = 0; b < batch.size(); ++b)
+			violations[b] += !satisfied[b];
+	}
+}
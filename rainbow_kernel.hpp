@@ -0,0 +1,159 @@
+// rainbow_kernel.hpp
+#ifndef RAINBOW_KERNEL_HPP
+#define RAINBOW_KERNEL_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "edge_index.hpp"
+#include "path_source.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Rainbow checks of edge colourings against the paths of vertex pairs. Edge
+// colours are 1..k as in the models. With AVX2 (or AVX-512) and k <= 32 the
+// checks run 8 (16) lanes at a time; otherwise a scalar 64-bit kernel is used.
+
+// Name of the kernel compiled in: "avx512", "avx2" or "scalar".
+const char* rainbow_kernel_name();
+
+// One colouring, stored as bit shifts (colour - 1) per edge id, followed by a
+// padding edge that sets no bit.
+class packed_colouring
+{
+public:
+	// colours[e] is the colour of edge id e.
+	explicit packed_colouring(const std::vector<index_t>& colours);
+
+	// Recolours edge e, for incremental updates.
+	void set(index_t e, index_t colour);
+
+	index_t num_edges() const { return shifts_.size() - 1; }
+	index_t max_colour() const { return max_colour_; }
+	const std::int32_t* data() const { return shifts_.data(); }
+
+private:
+	std::vector<std::int32_t> shifts_;
+	index_t max_colour_;
+};
+
+// Many colourings of the same edges, stored edge-major so that one load reads
+// the colour of an edge under consecutive colourings.
+class colouring_batch
+{
+public:
+	colouring_batch(index_t num_edges, index_t capacity);
+
+	// Colouring b becomes colours (which has one colour per edge id).
+	void set(index_t b, const std::vector<index_t>& colours);
+
+	index_t num_edges() const { return edges_; }
+	index_t size() const { return size_; }
+	index_t lanes() const { return lanes_; }
+	index_t max_colour() const { return max_colour_; }
+	const std::int32_t* row(index_t e) const { return &shifts_[e * lanes_]; }
+
+private:
+	index_t edges_;
+	index_t size_;
+	index_t lanes_;
+	index_t max_colour_;
+	std::vector<std::int32_t> shifts_;
+};
+
+// The paths of one vertex pair as edge-id rows padded to the longest path,
+// stored column by column: column j holds the j-th edge of every path. Rows
+// are sorted shortest first, so each block of rows is only as wide as its
+// longest path.
+class path_matrix
+{
+public:
+	path_matrix() : paths_(0), stride_(0), width_(0), pad_(0) { }
+
+	// paths are lists of edge ids below num_edges.
+	path_matrix(const std::vector<std::vector<index_t>>& paths, index_t num_edges);
+
+	index_t num_paths() const { return paths_; }
+	index_t width() const { return width_; }
+	index_t length(index_t p) const { return lengths_[p]; }
+	index_t edge(index_t p, index_t j) const { return columns_[j * stride_ + p]; }
+
+	// Row of a rainbow path under the colouring, or -1 if there is none.
+	index_t find_rainbow(const packed_colouring& c) const;
+
+	bool any_rainbow(const packed_colouring& c) const { return find_rainbow(c) != -1; }
+
+	// satisfied[b] is set to 1 if some path is rainbow under colouring b and
+	// left alone otherwise, so results can be accumulated over several sets.
+	void any_rainbow(const colouring_batch& batch, std::vector<char>& satisfied) const;
+
+private:
+	index_t paths_;
+	index_t stride_;
+	index_t width_;
+	index_t pad_;
+	std::vector<std::int32_t> columns_;
+	std::vector<std::int32_t> lengths_;
+	std::vector<std::int32_t> block_widths_;
+};
+
+// Path matrices for every non-adjacent pair of a graph, in next_pair order.
+// Paths are lists of element ids: edge ids, and for total rainbow connection
+// also m + v for every internal vertex v.
+class rainbow_checker
+{
+public:
+	// Paths of at most k edges, or only the geodesics if shortest is set.
+	rainbow_checker(const graph& g, index_t k, bool shortest = false, path_source* source = nullptr)
+		: rainbow_checker(g, k, shortest, source, false)
+	{
+
+	}
+
+	// Only the given pairs (u < v, non-adjacent); pairs are best given in
+	// next_pair order.
+	rainbow_checker(const graph& g, index_t k, const std::vector<std::pair<index_t, index_t>>& pairs, bool shortest = false, path_source* source = nullptr);
+
+	index_t num_pairs() const { return pairs_.size(); }
+	index_t num_elements() const { return elements_; }
+	std::pair<index_t, index_t> get_pair(index_t i) const { return pairs_[i]; }
+	const path_matrix& get_paths(index_t i) const { return paths_[i]; }
+	const edge_index& get_edge_index() const { return index_; }
+
+	// Number of pairs without a rainbow path.
+	index_t count_violations(const packed_colouring& c) const;
+
+	// violations[b] for every colouring b of the batch.
+	void count_violations(const colouring_batch& batch, std::vector<index_t>& violations) const;
+
+private:
+	friend rainbow_checker make_total_checker(const graph& g, index_t k, path_source* source);
+	friend rainbow_checker make_hybrid_checker(const graph& g, index_t k, path_source* source);
+
+	rainbow_checker(const graph& g, index_t length, bool shortest, path_source* source, bool total);
+
+	void add_pairs(const graph& g, const std::vector<std::pair<index_t, index_t>>& pairs, index_t length, bool shortest, path_source* source, bool total);
+
+	edge_index index_;
+	index_t elements_;
+	std::vector<std::pair<index_t, index_t>> pairs_;
+	std::vector<path_matrix> paths_;
+};
+
+// Element ids of a path for total rainbow connection: its edge ids, then
+// m + v for every internal vertex v.
+std::vector<index_t> to_total_ids(const edge_index& index, const edge_path& p);
+
+// Checker for total rainbow connection with k colours shared by edges and
+// vertices. A path of l edges has 2l - 1 elements, so paths have at most
+// (k + 1) / 2 edges.
+rainbow_checker make_total_checker(const graph& g, index_t k, path_source* source = nullptr);
+
+// Checker for rainbow vertex-edge connection, where edges and vertices take
+// colours 1..k from separate palettes and a path needs rainbow edges and
+// rainbow internal vertices. It has the element ids of make_total_checker,
+// and paths of at most k edges; colourings give vertex v the colour k + c
+// for its c, which makes one check cover both palettes.
+rainbow_checker make_hybrid_checker(const graph& g, index_t k, path_source* source = nullptr);
+
+#endif
@@ -0,0 +1,302 @@
+// rainbow_solver.cpp
+#include "rainbow_solver.hpp"
+#include "total_model_writer.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+rainbow_solver::rainbow_solver(const rainbow_checker& checker, const edge_path_index& index, index_t k)
+	: checker_(checker), index_(index), k_(k), alive_count_(checker.num_pairs(), 0),
+	complete_count_(checker.num_pairs(), 0), satisfied_(0),
+	distinct_(checker.num_elements()), domains_(checker.num_elements(), (k == 64) ? ~0ULL : ((1ULL << k) - 1)),
+	colours_(checker.num_elements(), 0),
+	nodes_(0), time_limit_(0), timed_out_(false)
+{
+	assert(k >= 1 && k <= 64);
+	assert(index.num_edges() == checker.num_elements());
+
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		const path_matrix& paths = checker_.get_paths(i);
+		offsets_.emplace_back(masks_.size());
+		alive_count_[i] = paths.num_paths();
+
+		for (index_t p = 0; p < paths.num_paths(); ++p)
+		{
+			masks_.emplace_back(0);
+			uncoloured_.emplace_back(paths.length(p));
+		}
+	}
+
+	alive_.assign(masks_.size(), 1);
+}
+
+void rainbow_solver::add_distinct(const std::vector<index_t>& elements)
+{
+	for (auto x : elements)
+	{
+		for (auto y : elements)
+		{
+			if (x != y)
+				distinct_[x].emplace_back(y);
+		}
+	}
+}
+
+void rainbow_solver::set_search_order(const std::vector<index_t>& order)
+{
+	assert(static_cast<index_t>(order.size()) == checker_.num_elements());
+
+	rank_.assign(order.size(), 0);
+
+	for (std::size_t i = 0; i < order.size(); ++i)
+		rank_[order[i]] = i;
+}
+
+bool rainbow_solver::assign(index_t x, index_t colour)
+{
+	for (auto y : distinct_[x])
+	{
+		if (colours_[y] == colour)
+			return false;
+	}
+
+	const std::uint64_t bit = 1ULL << (colour - 1);
+	bool ok = true;
+
+	colours_[x] = colour;
+
+	index_.for_each_pair(x, [&](const posting_group& group)
+	{
+		if (!ok)
+			return;
+
+		group.for_each_row([&](index_t row)
+		{
+			const index_t p = offsets_[group.pair] + row;
+
+			if (!ok || !alive_[p])
+				return;
+
+			const bool killed = (masks_[p] & bit) != 0;
+			trail_.push_back(trail_entry{ group.pair, p, masks_[p], killed });
+
+			if (killed)
+			{
+				alive_[p] = 0;
+
+				if (--alive_count_[group.pair] == 0)
+					ok = false;
+			}
+			else
+			{
+				masks_[p] |= bit;
+
+				if (--uncoloured_[p] == 0 && complete_count_[group.pair]++ == 0)
+					++satisfied_;
+			}
+		});
+	});
+
+	return ok;
+}
+
+void rainbow_solver::undo(std::size_t mark)
+{
+	while (trail_.size() > mark)
+	{
+		const trail_entry& t = trail_.back();
+		masks_[t.path] = t.mask;
+
+		if (t.killed)
+		{
+			alive_[t.path] = 1;
+			++alive_count_[t.pair];
+		}
+		else if (uncoloured_[t.path]++ == 0 && --complete_count_[t.pair] == 0)
+		{
+			--satisfied_;
+		}
+
+		trail_.pop_back();
+	}
+}
+
+index_t rainbow_solver::choose() const
+{
+	if (satisfied_ == checker_.num_pairs())
+	{
+		for (auto x : rest_)
+		{
+			if (colours_[x] == 0)
+				return x;
+		}
+
+		return -1;
+	}
+
+	index_t best = -1;
+
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		if (complete_count_[i] == 0 && (best == -1 || alive_count_[i] < alive_count_[best]))
+			best = i;
+	}
+
+	const path_matrix& paths = checker_.get_paths(best);
+	index_t x = -1;
+
+	for (index_t p = 0; p < paths.num_paths(); ++p)
+	{
+		if (!alive_[offsets_[best] + p])
+			continue;
+
+		for (index_t j = 0; j < paths.length(p); ++j)
+		{
+			const index_t y = paths.edge(p, j);
+
+			if (colours_[y] != 0)
+				continue;
+
+			if (x == -1 || (rank_.empty() ? index_.postings(y) > index_.postings(x) : rank_[y] < rank_[x]))
+				x = y;
+		}
+	}
+
+	assert(x != -1);
+	return x;
+}
+
+bool rainbow_solver::search(std::uint64_t used)
+{
+	const index_t x = choose();
+
+	if (x == -1)
+		return true;
+
+	// The used colours, and one unused colour standing for all of them: the
+	// preferred colour of x if it is free, else the smallest free one.
+	const std::uint64_t all = domains_[x];
+	std::uint64_t values = used & all;
+
+	if (values != all)
+	{
+		const index_t free = ctz64(~used & all);
+		const bool preferred_free = !phase_.empty() && bittest64(all & ~used, phase_[x] - 1);
+		values |= (1ULL << (preferred_free ? phase_[x] - 1 : free));
+	}
+
+	for (index_t i = 0; values != 0; ++i)
+	{
+		// The preferred colour goes first.
+		index_t c = ctz64(values) + 1;
+
+		if (i == 0 && !phase_.empty() && bittest64(values, phase_[x] - 1))
+			c = phase_[x];
+
+		values &= ~(1ULL << (c - 1));
+
+		if ((++nodes_ & 1023) == 0 && time_limit_ > 0 &&
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count() > time_limit_)
+		{
+			timed_out_ = true;
+		}
+
+		if (timed_out_)
+			break;
+
+		const std::size_t mark = trail_.size();
+
+		if (assign(x, c) && search(used | (1ULL << (c - 1))))
+			return true;
+
+		undo(mark);
+		colours_[x] = 0;
+	}
+
+	return false;
+}
+
+solve_status rainbow_solver::solve(std::vector<index_t>& colours, double time_limit)
+{
+	assert(phase_.empty() || static_cast<index_t>(phase_.size()) == checker_.num_elements());
+
+	nodes_ = 0;
+	time_limit_ = time_limit;
+	timed_out_ = false;
+	start_ = std::chrono::steady_clock::now();
+
+	for (index_t i = 0; i < checker_.num_pairs(); ++i)
+	{
+		if (alive_count_[i] == 0)
+			return solve_status::unsatisfiable;
+	}
+
+	// Elements on no path of an unsatisfied pair only need to respect the
+	// distinct sets; all others can take any colour.
+	rest_.clear();
+	for (index_t x = 0; x < checker_.num_elements(); ++x)
+	{
+		if (!distinct_[x].empty())
+			rest_.emplace_back(x);
+	}
+
+	std::fill(colours_.begin(), colours_.end(), 0);
+
+	const bool found = search(0);
+
+	if (found)
+	{
+		colours = colours_;
+
+		for (index_t x = 0; x < checker_.num_elements(); ++x)
+		{
+			if (colours[x] == 0)
+				colours[x] = phase_.empty() ? ctz64(domains_[x]) + 1 : phase_[x];
+		}
+	}
+
+	undo(0);
+
+	if (found)
+		return solve_status::satisfiable;
+
+	return timed_out_ ? solve_status::unknown : solve_status::unsatisfiable;
+}
+
+solve_status solve_total_rainbow(const graph& g, index_t k, std::vector<index_t>& colours, double time_limit, path_source* source)
+{
+	const rainbow_checker checker = make_total_checker(g, k, source);
+	const edge_path_index index(checker);
+
+	rainbow_solver solver(checker, index, k);
+	solver.add_distinct(get_total_distinct_elements(g));
+
+	return solver.solve(colours, time_limit);
+}
+
+solve_status solve_hybrid_rainbow(const graph& g, index_t k, std::vector<index_t>& colours, double time_limit, path_source* source)
+{
+	assert(k >= 1 && k <= 32);
+
+	const rainbow_checker checker = make_hybrid_checker(g, k, source);
+	const edge_path_index index(checker);
+	const index_t m = g.num_edges();
+	const std::uint64_t palette = (1ULL << k) - 1;
+
+	rainbow_solver solver(checker, index, 2 * k);
+	solver.add_distinct(get_total_distinct_elements(g));
+
+	for (index_t x = 0; x < checker.num_elements(); ++x)
+		solver.set_domain(x, x < m ? palette : palette << k);
+
+	const solve_status status = solver.solve(colours, time_limit);
+
+	if (status == solve_status::satisfiable)
+	{
+		for (index_t x = m; x < checker.num_elements(); ++x)
+			colours[x] -= k;
+	}
+
+	return status;
+}
@@ -0,0 +1,115 @@
+// rainbow_solver.hpp
+#ifndef RAINBOW_SOLVER_HPP
+#define RAINBOW_SOLVER_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path_index.hpp"
+#include "path_source.hpp"
+#include "rainbow_kernel.hpp"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+enum class solve_status
+{
+	satisfiable,
+	unsatisfiable,
+	unknown
+};
+
+// Exact backtracking search for a colouring of the elements of a
+// rainbow_checker with colours 1..k under which every pair has a rainbow
+// path. Every path keeps the mask of its colours and dies when an element
+// repeats one; a pair whose paths have all died fails the branch, and a pair
+// with a live path that is fully coloured is satisfied. The search branches
+// on an uncoloured element of the unsatisfied pair with the fewest live
+// paths, the one on most paths. Unused colours are interchangeable, so an
+// element only tries the colours used so far and one unused colour. Changes
+// are trailed and undone on backtracking.
+class rainbow_solver
+{
+public:
+	rainbow_solver(const rainbow_checker& checker, const edge_path_index& index, index_t k);
+
+	// The elements must get pairwise distinct colours.
+	void add_distinct(const std::vector<index_t>& elements);
+
+	// The colours element x may take, bit c - 1 standing for colour c; all of
+	// 1..k by default. Colours are interchangeable within a domain, so the
+	// domains given should be equal or disjoint.
+	void set_domain(index_t x, std::uint64_t colours) { domains_[x] = colours; }
+
+	// Colours to try first, one per element (for instance the last solution
+	// when constraints have been added); elements left free take them too.
+	void set_phase(const std::vector<index_t>& colours) { phase_ = colours; }
+
+	// Branch, within the pair chosen, on the element earliest in this order
+	// (for instance get_search_order) instead of the one on most paths.
+	void set_search_order(const std::vector<index_t>& order);
+
+	// Leaves one colour per element in colours if satisfiable; unknown once
+	// time_limit seconds have passed (0 means no limit).
+	solve_status solve(std::vector<index_t>& colours, double time_limit = 0);
+
+	std::uint64_t get_nodes() const { return nodes_; }
+
+private:
+	bool assign(index_t x, index_t colour);
+	void undo(std::size_t mark);
+	index_t choose() const;
+	bool search(std::uint64_t used);
+
+	const rainbow_checker& checker_;
+	const edge_path_index& index_;
+	index_t k_;
+
+	// First path of every pair in the flat path arrays.
+	std::vector<index_t> offsets_;
+	std::vector<std::uint64_t> masks_;
+	std::vector<index_t> uncoloured_;
+	std::vector<char> alive_;
+	std::vector<index_t> alive_count_;
+	std::vector<index_t> complete_count_;
+	index_t satisfied_;
+
+	std::vector<std::vector<index_t>> distinct_;
+	std::vector<std::uint64_t> domains_;
+	std::vector<index_t> colours_;
+	std::vector<index_t> phase_;
+
+	// Position of every element in the search order, or empty.
+	std::vector<index_t> rank_;
+
+	// Elements left once every pair is satisfied: those in distinct sets.
+	std::vector<index_t> rest_;
+
+	// A path an assignment changed, with its old mask.
+	struct trail_entry
+	{
+		index_t pair;
+		index_t path;
+		std::uint64_t mask;
+		bool killed;
+	};
+
+	std::vector<trail_entry> trail_;
+
+	std::uint64_t nodes_;
+	double time_limit_;
+	bool timed_out_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+// Total rainbow colouring of g with k colours, one per element id of
+// make_total_checker (edge ids, then m + v for vertex v). Bridges and cut
+// vertices are pairwise distinct.
+solve_status solve_total_rainbow(const graph& g, index_t k, std::vector<index_t>& colours, double time_limit = 0, path_source* source = nullptr);
+
+// Rainbow vertex-edge colouring of g with k edge colours and k vertex
+// colours (k <= 32), laid out as for solve_total_rainbow. The vertices are
+// searched over colours k + 1..2k of make_hybrid_checker and given back as
+// 1..k.
+solve_status solve_hybrid_rainbow(const graph& g, index_t k, std::vector<index_t>& colours, double time_limit = 0, path_source* source = nullptr);
+
+#endif
@@ -0,0 +1,75 @@
+// result_memo.cpp
+#include "result_memo.hpp"
+#include "lazy_solver.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+std::size_t result_memo::form_hash::operator()(const std::vector<index_t>& form) const
+{
+	std::uint64_t h = 14695981039346656037ULL;
+
+	for (auto word : form)
+	{
+		h ^= static_cast<std::uint64_t>(word);
+		h *= 1099511628211ULL;
+		h ^= (h >> 29);
+	}
+
+	return static_cast<std::size_t>(h);
+}
+
+const graph_results* result_memo::find(const graph& g) const
+{
+	return find(canonical_label(g));
+}
+
+const graph_results* result_memo::find(const canonical_labelling& c) const
+{
+	auto it = results_.find(c.form);
+	return (it != results_.end()) ? &it->second : nullptr;
+}
+
+graph_results& result_memo::operator[](const graph& g)
+{
+	return (*this)[canonical_label(g)];
+}
+
+graph_results& result_memo::operator[](const canonical_labelling& c)
+{
+	return results_[c.form];
+}
+
+index_t rainbow_connection_number(const graph& g, result_memo& memo, bool strong)
+{
+	if (!is_connected(g))
+		throw std::runtime_error("The rainbow connection number needs a connected graph");
+
+	const canonical_labelling c = canonical_label(g);
+	graph_results& results = memo[c];
+	index_t& value = strong ? results.src : results.rc;
+
+	if (value >= 0)
+		return value;
+
+	std::vector<index_t> colours;
+
+	// Every edge coloured apart is a strong rainbow colouring, so the search
+	// ends by k = m.
+	for (index_t k = get_diameter(g); ; ++k)
+	{
+		if (solve_rainbow_lazy(g, k, colours, strong) == solve_status::satisfiable)
+			return value = k;
+	}
+}
+
+std::vector<index_t> rainbow_connection_numbers(const std::vector<graph>& graphs, result_memo& memo, bool strong)
+{
+	std::vector<index_t> values;
+	values.reserve(graphs.size());
+
+	for (const auto& g : graphs)
+		values.emplace_back(rainbow_connection_number(g, memo, strong));
+
+	return values;
+}
@@ -0,0 +1,58 @@
+// result_memo.hpp
+#ifndef RESULT_MEMO_HPP
+#define RESULT_MEMO_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "canonical.hpp"
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+// Isomorphism invariants computed for a graph. Unknown values are -1 or empty.
+struct graph_results
+{
+	graph_results() : rc(-1), src(-1) { }
+
+	index_t rc;
+	index_t src;
+
+	// Number of rainbow (strong rainbow) colorings with 1, 2, ... colors.
+	std::vector<index_t> rainbow_polynomial;
+	std::vector<index_t> strong_polynomial;
+};
+
+// Results keyed by canonical form, so that isomorphic graphs in a batch are
+// modelled and solved only once.
+class result_memo
+{
+public:
+	// Null if no isomorphic graph has been stored.
+	const graph_results* find(const graph& g) const;
+	const graph_results* find(const canonical_labelling& c) const;
+
+	// The stored results, created empty on first use.
+	graph_results& operator[](const graph& g);
+	graph_results& operator[](const canonical_labelling& c);
+
+	std::size_t size() const { return results_.size(); }
+
+private:
+	struct form_hash
+	{
+		std::size_t operator()(const std::vector<index_t>& form) const;
+	};
+
+	std::unordered_map<std::vector<index_t>, graph_results, form_hash> results_;
+};
+
+// The rainbow connection number of g (strong: the strong one), from memo if
+// an isomorphic graph has been solved and otherwise by solve_rainbow_lazy
+// for k = diam(g), diam(g) + 1, ... and stored. g must be connected.
+index_t rainbow_connection_number(const graph& g, result_memo& memo, bool strong = false);
+
+// The same for every graph of a batch, so that each isomorphism class is
+// solved once and its other members cost a lookup.
+std::vector<index_t> rainbow_connection_numbers(const std::vector<graph>& graphs, result_memo& memo, bool strong = false);
+
+#endif
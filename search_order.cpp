@@ -0,0 +1,61 @@
+// search_order.cpp
+#include "search_order.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+
+element_statistics get_element_statistics(const rainbow_checker& checker)
+{
+	element_statistics stats;
+	stats.pairs.assign(checker.num_elements(), 0);
+	stats.single_path_pairs.assign(checker.num_elements(), 0);
+
+	// seen[x] is one more than the last pair counted for x.
+	std::vector<index_t> seen(checker.num_elements(), 0);
+
+	for (index_t i = 0; i < checker.num_pairs(); ++i)
+	{
+		const path_matrix& paths = checker.get_paths(i);
+
+		for (index_t p = 0; p < paths.num_paths(); ++p)
+		{
+			for (index_t j = 0; j < paths.length(p); ++j)
+			{
+				const index_t x = paths.edge(p, j);
+
+				if (seen[x] != i + 1)
+				{
+					seen[x] = i + 1;
+					++stats.pairs[x];
+				}
+
+				if (paths.num_paths() == 1)
+					++stats.single_path_pairs[x];
+			}
+		}
+	}
+
+	return stats;
+}
+
+std::vector<index_t> get_search_order(const rainbow_checker& checker, const std::vector<index_t>& distinct)
+{
+	const element_statistics stats = get_element_statistics(checker);
+
+	std::vector<char> is_distinct(checker.num_elements(), 0);
+
+	for (auto x : distinct)
+		is_distinct[x] = 1;
+
+	std::vector<index_t> order(checker.num_elements());
+	std::iota(order.begin(), order.end(), 0);
+
+	std::sort(order.begin(), order.end(), [&](index_t x, index_t y)
+	{
+		return std::make_tuple(-is_distinct[x], -stats.single_path_pairs[x], -stats.pairs[x], x) <
+			std::make_tuple(-is_distinct[y], -stats.single_path_pairs[y], -stats.pairs[y], y);
+	});
+
+	return order;
+}
@@ -0,0 +1,24 @@
+// search_order.hpp
+#ifndef SEARCH_ORDER_HPP
+#define SEARCH_ORDER_HPP
+
+#include "common.hpp"
+#include "rainbow_kernel.hpp"
+#include <vector>
+
+// How constrained every element of a checker is: the number of pairs with
+// the element on some path, and the number of pairs whose only path it is on.
+struct element_statistics
+{
+	std::vector<index_t> pairs;
+	std::vector<index_t> single_path_pairs;
+};
+
+element_statistics get_element_statistics(const rainbow_checker& checker);
+
+// The elements most constrained first, for a solver to branch on: the
+// distinct elements (such as the bridges), then the rest by the number of
+// single-path pairs and then of pairs they occur in, ties by id.
+std::vector<index_t> get_search_order(const rainbow_checker& checker, const std::vector<index_t>& distinct = std::vector<index_t>());
+
+#endif
@@ -0,0 +1,91 @@
+// single_source.cpp
+#include "single_source.hpp"
+
+#include <utility>
+
+namespace
+{
+	// Thrown from the DFS once the paths of a source pass the budget.
+	struct over_budget { };
+}
+
+bool single_source_path_source::take(const graph& g, index_t s, index_t t, bool shortest, index_t length, std::vector<edge_path>& paths)
+{
+	if (t < s || is_adjacent(g, s, t))
+		return false;
+
+	const index_t n = g.num_vertices();
+	const std::uint64_t hash = hash_graph(g);
+
+	if (hash_ != hash || source_ != s || shortest_ != shortest || length_ != length)
+	{
+		hash_ = hash;
+		source_ = s;
+		shortest_ = shortest;
+		length_ = length;
+		targets_ = 0;
+
+		for (index_t v = s + 1; v < n; ++v)
+		{
+			if (!is_adjacent(g, s, v))
+				targets_ |= (1ULL << v);
+		}
+
+		paths_.assign(n, std::vector<edge_path>());
+		bytes_ = 0;
+
+		auto add = [this](index_t v, const edge_path& p)
+		{
+			bytes_ += sizeof(edge_path) + p.size() * sizeof(index_t);
+
+			if (budget_ != 0 && bytes_ > budget_)
+				throw over_budget();
+
+			paths_[v].emplace_back(p);
+		};
+
+		++searches_;
+
+		try
+		{
+			if (shortest)
+				visit_shortest_paths_from<edge_path>(g, s, targets_, add);
+			else
+				visit_paths_from<edge_path>(g, s, targets_, std::vector<index_t>(n, length), add);
+		}
+		catch (const over_budget&)
+		{
+			// The pairs of this source go one at a time instead.
+			paths_.assign(n, std::vector<edge_path>());
+			targets_ = 0;
+		}
+	}
+
+	if (!bittest64(targets_, t))
+		return false;
+
+	for (auto& p : paths_[t])
+		paths.emplace_back(std::move(p));
+
+	std::vector<edge_path>().swap(paths_[t]);
+	targets_ &= ~(1ULL << t);
+	return true;
+}
+
+void single_source_path_source::get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	if (!take(g, s, t, false, length, paths))
+	{
+		list_paths(g, s, t, paths, length);
+		++searches_;
+	}
+}
+
+void single_source_path_source::get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	if (!take(g, s, t, true, 0, paths))
+	{
+		list_shortest_paths(g, s, t, paths);
+		++searches_;
+	}
+}
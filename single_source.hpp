@@ -0,0 +1,56 @@
+// single_source.hpp
+#ifndef SINGLE_SOURCE_HPP
+#define SINGLE_SOURCE_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Finds the paths of all pairs (s, t) with t > s non-adjacent in one DFS from
+// s (visit_paths_from), keeps them per target and hands them out pair by
+// pair. Pairs are asked for in next_pair order, so every source is searched
+// once instead of once per target. Other pairs, or a pair asked for twice,
+// are enumerated on their own.
+//
+// This is what the writers and rainbow_checker use when no other source is
+// set; it holds the paths of one source at a time, to all of its targets.
+// Under a memory budget a source whose paths take more is given up on and
+// its pairs are enumerated one at a time.
+class single_source_path_source : public path_source
+{
+public:
+	single_source_path_source() : hash_(0), source_(-1), shortest_(false), length_(0), targets_(0), searches_(0), budget_(0), bytes_(0) { }
+
+	// Roughly the most bytes of paths to hold for one source; 0 means no
+	// limit.
+	void set_memory_budget(std::size_t budget) { budget_ = budget; }
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+
+	// Number of DFS runs so far, batched or not.
+	index_t get_searches() const { return searches_; }
+
+private:
+	bool take(const graph& g, index_t s, index_t t, bool shortest, index_t length, std::vector<edge_path>& paths);
+
+	std::uint64_t hash_;
+	index_t source_;
+	bool shortest_;
+	index_t length_;
+
+	// Targets whose paths have not been handed out yet.
+	index_t targets_;
+	std::vector<std::vector<edge_path>> paths_;
+	index_t searches_;
+
+	std::size_t budget_;
+	std::size_t bytes_;
+};
+
+#endif
@@ -0,0 +1,469 @@
+// solver_runner.cpp
+#include "solver_runner.hpp"
+
+#include <cerrno>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Bytes passed to the pipe at a time.
+	const std::size_t BUFFER_SIZE = 1 << 16;
+
+	bool starts_with(const std::string& line, const std::string& prefix)
+	{
+		return line.compare(0, prefix.size(), prefix) == 0;
+	}
+}
+
+void solver_output_parser::add_line(const std::string& line)
+{
+	// Output from Windows builds ends lines with \r\n.
+	if (!line.empty() && line.back() == '\r')
+	{
+		add_line(line.substr(0, line.size() - 1));
+		return;
+	}
+
+	if (dialect_ == solver_dialect::minion)
+		add_minion_line(line);
+	else
+		add_minizinc_line(line);
+}
+
+void solver_output_parser::add_minion_line(const std::string& line)
+{
+	if (starts_with(line, "Sol:"))
+	{
+		if (fresh_)
+			result_.values.clear();
+
+		fresh_ = false;
+
+		std::istringstream values(line.substr(4));
+		for (index_t v; values >> v; )
+			result_.values.emplace_back(v);
+	}
+	else if (starts_with(line, "Solution Number:"))
+	{
+		fresh_ = true;
+		++result_.solutions;
+		result_.status = solve_status::satisfiable;
+	}
+	else if (starts_with(line, "Time out"))
+	{
+		timed_out_ = true;
+	}
+	else if (starts_with(line, "Problem solvable?:"))
+	{
+		if (line.find("yes") != std::string::npos)
+			result_.status = solve_status::satisfiable;
+		else
+			result_.status = timed_out_ ? solve_status::unknown : solve_status::unsatisfiable;
+	}
+	else if (starts_with(line, "Solutions Found:"))
+	{
+		std::istringstream(line.substr(16)) >> result_.solutions;
+	}
+}
+
+void solver_output_parser::add_minizinc_line(const std::string& line)
+{
+	if (line == "----------")
+	{
+		fresh_ = true;
+		++result_.solutions;
+		result_.status = solve_status::satisfiable;
+	}
+	else if (line == "=====UNSATISFIABLE=====")
+	{
+		result_.status = solve_status::unsatisfiable;
+	}
+	else if (starts_with(line, "=====") && line != "==========")
+	{
+		// UNKNOWN, ERROR and the like.
+		result_.status = solve_status::unknown;
+	}
+	else
+	{
+		// name = value;
+		const std::size_t eq = line.find(" = ");
+
+		if (eq == std::string::npos || line.back() != ';')
+			return;
+
+		index_t value = 0;
+		if (!(std::istringstream(line.substr(eq + 3, line.size() - eq - 4)) >> value))
+			return;
+
+		if (fresh_)
+			result_.assignment.clear();
+
+		fresh_ = false;
+		result_.assignment[line.substr(0, eq)] = value;
+	}
+}
+
+solver_runner::pipe_buffer::pipe_buffer(solver_runner& runner)
+	: runner_(runner), buffer_(BUFFER_SIZE), broken_(false)
+{
+	setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+bool solver_runner::pipe_buffer::drain()
+{
+	const std::size_t size = pptr() - pbase();
+
+	if (!broken_ && size != 0)
+		broken_ = !runner_.write_input(pbase(), size);
+
+	setp(buffer_.data(), buffer_.data() + buffer_.size());
+	return !broken_;
+}
+
+solver_runner::pipe_buffer::int_type solver_runner::pipe_buffer::overflow(int_type c)
+{
+	if (!drain())
+		return traits_type::eof();
+
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(c);
+		pbump(1);
+	}
+
+	return traits_type::not_eof(c);
+}
+
+int solver_runner::pipe_buffer::sync()
+{
+	return drain() ? 0 : -1;
+}
+
+solver_runner::~solver_runner()
+{
+	finish();
+}
+
+const solver_result& solver_runner::finish()
+{
+	if (finished_)
+		return parser_.get_result();
+
+	finished_ = true;
+
+	input_.flush();
+	close_input();
+
+	if (reader_.joinable())
+		reader_.join();
+
+	parser_.get_result().exit_code = wait();
+	return parser_.get_result();
+}
+
+void solver_runner::read_output()
+{
+	std::vector<char> chunk(BUFFER_SIZE);
+	std::string line;
+
+	for (;;)
+	{
+#if defined(_MSC_VER)
+		DWORD got = 0;
+
+		if (!ReadFile(stdout_, chunk.data(), static_cast<DWORD>(chunk.size()), &got, nullptr) || got == 0)
+			break;
+#else
+		const ssize_t got = ::read(stdout_, chunk.data(), chunk.size());
+
+		if (got < 0 && errno == EINTR)
+			continue;
+
+		if (got <= 0)
+			break;
+#endif
+
+		for (std::size_t i = 0; i < static_cast<std::size_t>(got); ++i)
+		{
+			if (chunk[i] != '\n')
+			{
+				line.push_back(chunk[i]);
+				continue;
+			}
+
+			parser_.add_line(line);
+			line.clear();
+		}
+	}
+
+	if (!line.empty())
+		parser_.add_line(line);
+}
+
+#if defined(_MSC_VER)
+
+solver_runner::solver_runner(const std::vector<std::string>& command, solver_dialect dialect)
+	: process_(nullptr), stdin_(nullptr), stdout_(nullptr), parser_(dialect), buffer_(*this), input_(&buffer_), finished_(false)
+{
+	if (command.empty())
+		throw std::runtime_error("No solver command");
+
+	SECURITY_ATTRIBUTES inherit = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+	HANDLE child_in = nullptr;
+	HANDLE child_out = nullptr;
+
+	if (!CreatePipe(&child_in, &stdin_, &inherit, 0) || !CreatePipe(&stdout_, &child_out, &inherit, 0))
+		throw std::runtime_error("Cannot create solver pipes");
+
+	// Only the child's ends are inherited.
+	SetHandleInformation(stdin_, HANDLE_FLAG_INHERIT, 0);
+	SetHandleInformation(stdout_, HANDLE_FLAG_INHERIT, 0);
+
+	std::string line;
+
+	for (const auto& arg : command)
+		line += (line.empty() ? "\"" : " \"") + arg + "\"";
+
+	STARTUPINFOA startup = {};
+	startup.cb = sizeof(startup);
+	startup.dwFlags = STARTF_USESTDHANDLES;
+	startup.hStdInput = child_in;
+	startup.hStdOutput = child_out;
+	startup.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+	PROCESS_INFORMATION info = {};
+	const bool started = CreateProcessA(nullptr, &line[0], nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &info) != 0;
+
+	CloseHandle(child_in);
+	CloseHandle(child_out);
+
+	if (started)
+	{
+		CloseHandle(info.hThread);
+		process_ = info.hProcess;
+	}
+	else
+	{
+		// As from a shell: nothing to read, and exit code 127.
+		CloseHandle(stdin_);
+		stdin_ = nullptr;
+	}
+
+	reader_ = std::thread(&solver_runner::read_output, this);
+}
+
+bool solver_runner::write_input(const char* data, std::size_t size)
+{
+	while (size != 0 && stdin_ != nullptr)
+	{
+		DWORD written = 0;
+
+		if (!WriteFile(stdin_, data, static_cast<DWORD>(size), &written, nullptr))
+			return false;
+
+		data += written;
+		size -= written;
+	}
+
+	return size == 0;
+}
+
+void solver_runner::close_input()
+{
+	if (stdin_ != nullptr)
+		CloseHandle(stdin_);
+
+	stdin_ = nullptr;
+}
+
+int solver_runner::wait()
+{
+	CloseHandle(stdout_);
+
+	if (process_ == nullptr)
+		return 127;
+
+	DWORD code = 0;
+	WaitForSingleObject(process_, INFINITE);
+	GetExitCodeProcess(process_, &code);
+	CloseHandle(process_);
+
+	return static_cast<int>(code);
+}
+
+#else
+
+namespace
+{
+	bool make_pipe(int fds[2])
+	{
+#if defined(__linux__)
+		return ::pipe2(fds, O_CLOEXEC) == 0;
+#else
+		if (::pipe(fds) != 0)
+			return false;
+
+		::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+		::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+		return true;
+#endif
+	}
+}
+
+solver_runner::solver_runner(const std::vector<std::string>& command, solver_dialect dialect)
+	: pid_(-1), stdin_(-1), stdout_(-1), parser_(dialect), buffer_(*this), input_(&buffer_), finished_(false)
+{
+	if (command.empty())
+		throw std::runtime_error("No solver command");
+
+	// A solver that exits early makes writes fail instead of killing us. Set
+	// once for the process; the solver gets the default back before exec.
+	static const bool ignored = (std::signal(SIGPIPE, SIG_IGN), true);
+	(void)ignored;
+
+	int to_child[2];
+	int from_child[2];
+
+	// Close-on-exec from the start, so that children started by other threads
+	// meanwhile do not hold on to our ends; dup2 clears it on the child's.
+	if (!make_pipe(to_child))
+		throw std::runtime_error("Cannot create solver pipes");
+
+	if (!make_pipe(from_child))
+	{
+		::close(to_child[0]);
+		::close(to_child[1]);
+		throw std::runtime_error("Cannot create solver pipes");
+	}
+
+	// Built before forking: the child only calls async-signal-safe functions.
+	std::vector<char*> argv;
+
+	for (const auto& arg : command)
+		argv.emplace_back(const_cast<char*>(arg.c_str()));
+
+	argv.emplace_back(nullptr);
+
+	pid_ = ::fork();
+
+	if (pid_ == 0)
+	{
+		std::signal(SIGPIPE, SIG_DFL);
+
+		::dup2(to_child[0], STDIN_FILENO);
+		::dup2(from_child[1], STDOUT_FILENO);
+
+		::close(to_child[0]);
+		::close(to_child[1]);
+		::close(from_child[0]);
+		::close(from_child[1]);
+
+		::execvp(argv[0], argv.data());
+		::_exit(127);
+	}
+
+	::close(to_child[0]);
+	::close(from_child[1]);
+
+	if (pid_ < 0)
+	{
+		::close(to_child[1]);
+		::close(from_child[0]);
+		throw std::runtime_error("Cannot start " + command[0]);
+	}
+
+	stdin_ = to_child[1];
+	stdout_ = from_child[0];
+
+	reader_ = std::thread(&solver_runner::read_output, this);
+}
+
+bool solver_runner::write_input(const char* data, std::size_t size)
+{
+	while (size != 0 && stdin_ >= 0)
+	{
+		const ssize_t written = ::write(stdin_, data, size);
+
+		if (written < 0 && errno == EINTR)
+			continue;
+
+		if (written <= 0)
+			return false;
+
+		data += written;
+		size -= written;
+	}
+
+	return size == 0;
+}
+
+void solver_runner::close_input()
+{
+	if (stdin_ >= 0)
+		::close(stdin_);
+
+	stdin_ = -1;
+}
+
+int solver_runner::wait()
+{
+	::close(stdout_);
+
+	int status = 0;
+
+	while (::waitpid(pid_, &status, 0) < 0)
+	{
+		if (errno != EINTR)
+			return -1;
+	}
+
+	if (WIFEXITED(status))
+		return WEXITSTATUS(status);
+
+	// Killed by a signal, reported as a shell would.
+	return 128 + WTERMSIG(status);
+}
+
+#endif
+
+temp_model_file::temp_model_file()
+{
+	std::random_device rd;
+	path_ = (std::filesystem::temp_directory_path() / ("model." + std::to_string(rd()) + ".tmp")).string();
+	stream_.open(path_, std::ios::binary);
+
+	if (!stream_)
+		throw std::runtime_error("Cannot create model file " + path_);
+}
+
+temp_model_file::~temp_model_file()
+{
+	stream_.close();
+
+	std::error_code ec;
+	std::filesystem::remove(path_, ec);
+}
+
+std::vector<std::string> temp_model_file::get_command(const std::vector<std::string>& command)
+{
+	stream_.close();
+
+	if (stream_.fail())
+		throw std::runtime_error("Cannot write model file " + path_);
+
+	std::vector<std::string> result(command);
+	result.emplace_back(path_);
+	return result;
+}
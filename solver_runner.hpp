@@ -0,0 +1,179 @@
+// solver_runner.hpp
+#ifndef SOLVER_RUNNER_HPP
+#define SOLVER_RUNNER_HPP
+
+#include "common.hpp"
+#include "rainbow_solver.hpp"
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class solver_dialect
+{
+	minion,
+	minizinc
+};
+
+// How a model reaches the solver: streamed into its standard input, which the
+// command names as /dev/stdin, or written to a temporary file first. Windows
+// has no /dev/stdin, so there the file is the default.
+enum class model_input
+{
+	stream,
+	file
+};
+
+inline model_input default_model_input()
+{
+#if defined(_MSC_VER)
+	return model_input::file;
+#else
+	return model_input::stream;
+#endif
+}
+
+// What a solver reported.
+struct solver_result
+{
+	solve_status status = solve_status::unknown;
+
+	// Solutions found so far, or as reported in the end.
+	index_t solutions = 0;
+
+	// The last solution: Minion "Sol:" values in print order, or MiniZinc
+	// "name = value;" lines.
+	std::vector<index_t> values;
+	std::map<std::string, index_t> assignment;
+
+	// -1 until the solver has exited; 127 if it could not be started.
+	int exit_code = -1;
+};
+
+// Reads solver output one line at a time. Minion reports "Sol:" lines, then
+// "Solution Number:", and at the end "Problem solvable?:" and "Solutions
+// Found:"; MiniZinc ends every solution with "----------" and the search with
+// "==========" or a "=====...=====" status.
+class solver_output_parser
+{
+public:
+	explicit solver_output_parser(solver_dialect dialect) : dialect_(dialect), fresh_(true), timed_out_(false) { }
+
+	void add_line(const std::string& line);
+
+	const solver_result& get_result() const { return result_; }
+	solver_result& get_result() { return result_; }
+
+private:
+	void add_minion_line(const std::string& line);
+	void add_minizinc_line(const std::string& line);
+
+	solver_dialect dialect_;
+	solver_result result_;
+
+	// The next solution line starts a new solution.
+	bool fresh_;
+	bool timed_out_;
+};
+
+// Runs a solver as a child process with the model streamed into its standard
+// input, so a writer given get_input_stream() sends the model while it is
+// still being generated and nothing goes to disk. The output is parsed on a
+// thread of its own as it arrives, which also keeps a solver that answers
+// early from blocking on a full pipe. For instance:
+//
+//   solver_runner runner({ "minion", "/dev/stdin" }, solver_dialect::minion);
+//   minion_model_writer writer(g, k, runner.get_input_stream());
+//   writer.write();
+//   const solver_result& result = runner.finish();
+//
+// The command must have the solver read its standard input; /dev/stdin works
+// on Linux for any solver that takes a file name, and elsewhere the model can
+// go through a temp_model_file instead. A solver that exits before
+// reading all of the model turns the rest of the writes into no-ops: on POSIX
+// systems the first runner makes the process ignore SIGPIPE for good, while
+// the solvers start with the default action.
+class solver_runner
+{
+public:
+	solver_runner(const std::vector<std::string>& command, solver_dialect dialect);
+
+	solver_runner(const solver_runner&) = delete;
+	solver_runner& operator=(const solver_runner&) = delete;
+
+	~solver_runner();
+
+	std::ostream& get_input_stream() { return input_; }
+
+	// Ends the input and waits for the solver to exit.
+	const solver_result& finish();
+
+private:
+	// Passes whole buffers of the model to the pipe.
+	class pipe_buffer : public std::streambuf
+	{
+	public:
+		explicit pipe_buffer(solver_runner& runner);
+
+	protected:
+		virtual int_type overflow(int_type c);
+		virtual int sync();
+
+	private:
+		bool drain();
+
+		solver_runner& runner_;
+		std::vector<char> buffer_;
+		bool broken_;
+	};
+
+	bool write_input(const char* data, std::size_t size);
+	void close_input();
+	void read_output();
+	int wait();
+
+#if defined(_MSC_VER)
+	void* process_;
+	void* stdin_;
+	void* stdout_;
+#else
+	int pid_;
+	int stdin_;
+	int stdout_;
+#endif
+
+	solver_output_parser parser_;
+	pipe_buffer buffer_;
+	std::ostream input_;
+	std::thread reader_;
+	bool finished_;
+};
+
+// A model written to a fresh file in the temporary directory, for solvers
+// that cannot be given their standard input by name. The file is removed
+// when this goes out of scope.
+class temp_model_file
+{
+public:
+	temp_model_file();
+
+	temp_model_file(const temp_model_file&) = delete;
+	temp_model_file& operator=(const temp_model_file&) = delete;
+
+	~temp_model_file();
+
+	std::ostream& get_stream() { return stream_; }
+	const std::string& get_path() const { return path_; }
+
+	// Closes the file and returns command with its name added at the end.
+	std::vector<std::string> get_command(const std::vector<std::string>& command);
+
+private:
+	std::string path_;
+	std::ofstream stream_;
+};
+
+#endif
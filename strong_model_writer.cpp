@@ -8,18 +8,30 @@ void strong_model_writer::impl_process_vertex_pair(index_t u, index_t v)
 {
 	auto& os = get_output_stream();
 	os << get_comment() << " Vertex pair " << u << " " << v << "\n";
+
+	// No path is shorter than a geodesic.
+	if (get_path_encoding() == path_encoding::zdd)
+	{
+		std::vector<index_t> dist(get_graph().num_vertices(), 0);
+		bfs(get_graph(), dist, u);
+		add_zdd_pair(u, v, dist[v]);
+		return;
+	}
+
 	std::vector<edge_path> paths;
-	list_shortest_paths<edge_path>(get_graph(), u, v, paths);
+	list_pair_shortest_paths(u, v, paths);
 
+	std::vector<index_t> created;
 	os << "constraint ( ";
 
 	for (index_t j = 0; j < paths.size(); ++j)
 	{
-		add_alldiff(paths[j], os);
+		add_path_term(paths[j], created);
 
 		if (j != paths.size() - 1)
 			os << "\\/ ";
 	}
 
 	os << ");\n";
+	add_disequality_literals(created);
 }
\ No newline at end of file
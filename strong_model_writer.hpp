@@ -15,6 +15,8 @@ public:
 
 private:
 	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual bool impl_shortest_paths() const { return true; }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+// symmetry.cpp
+#include "symmetry.hpp"
+
+#include "canonical.hpp"
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <queue>
+
+pair_orbits::pair_orbits(const graph& g, const std::vector<std::vector<index_t>>& generators)
+	: n_(g.num_vertices()), orbits_(0), rep_(n_ * n_, -1), perm_(n_ * n_)
+{
+	std::vector<index_t> identity(n_);
+	std::iota(identity.begin(), identity.end(), 0);
+
+	// Breadth-first search over the pairs of each orbit, composing the
+	// generators along the way.
+	index_t u = 0;
+	index_t v = 1;
+	const index_t pairs = nchoosek(n_, 2);
+
+	for (index_t i = 0; i < pairs; ++i, next_pair(u, v, n_))
+	{
+		if (rep_[u * n_ + v] != -1)
+			continue;
+
+		const index_t root = u * n_ + v;
+		rep_[root] = root;
+		perm_[root] = identity;
+		++orbits_;
+
+		std::queue<index_t> q;
+		q.push(root);
+
+		while (!q.empty())
+		{
+			const index_t p = q.front();
+			q.pop();
+
+			for (const auto& gen : generators)
+			{
+				auto image = std::minmax(gen[p / n_], gen[p % n_]);
+				const index_t next = image.first * n_ + image.second;
+
+				if (rep_[next] != -1)
+					continue;
+
+				rep_[next] = root;
+				perm_[next].resize(n_);
+
+				for (index_t w = 0; w < n_; ++w)
+					perm_[next][w] = gen[perm_[p][w]];
+
+				q.push(next);
+			}
+		}
+	}
+}
+
+std::pair<index_t, index_t> pair_orbits::representative(index_t u, index_t v) const
+{
+	const index_t rep = rep_[u * n_ + v];
+	return std::make_pair(rep / n_, rep % n_);
+}
+
+const std::vector<index_t>& pair_orbits::mapping(index_t u, index_t v) const
+{
+	return perm_[u * n_ + v];
+}
+
+orbit_path_source::orbit_path_source(const graph& g, path_source* inner)
+	: orbit_path_source(g, canonical_label(g).generators, inner)
+{
+
+}
+
+orbit_path_source::orbit_path_source(const graph& g, const std::vector<std::vector<index_t>>& generators, path_source* inner)
+	: orbits_(g, generators), inner_(inner), representatives_()
+{
+
+}
+
+void orbit_path_source::map_paths(const graph& g, index_t s, index_t t, bool shortest, index_t length, std::vector<edge_path>& paths)
+{
+	if (s > t)
+		std::swap(s, t);
+
+	const auto rep = orbits_.representative(s, t);
+	const key_type key(rep.first, rep.second, shortest, shortest ? 0 : length);
+
+	auto it = representatives_.find(key);
+
+	if (it == representatives_.end())
+	{
+		std::vector<edge_path> rep_paths;
+
+		if (inner_ != nullptr && shortest)
+			inner_->get_shortest_paths(g, rep.first, rep.second, rep_paths);
+		else if (inner_ != nullptr)
+			inner_->get_paths(g, rep.first, rep.second, rep_paths, length);
+		else if (shortest)
+			list_shortest_paths(g, rep.first, rep.second, rep_paths);
+		else
+			list_paths(g, rep.first, rep.second, rep_paths, length);
+
+		std::vector<std::vector<index_t>> stored;
+		stored.reserve(rep_paths.size());
+
+		for (const auto& p : rep_paths)
+			stored.emplace_back(p.cbegin(), p.cend());
+
+		it = representatives_.emplace(key, std::move(stored)).first;
+	}
+
+	const auto& perm = orbits_.mapping(s, t);
+
+	// The image of the representative may run from t to s.
+	const bool reversed = (perm[rep.first] != s);
+	assert(reversed ? (perm[rep.first] == t && perm[rep.second] == s) : (perm[rep.second] == t));
+
+	for (const auto& vertices : it->second)
+	{
+		edge_path p;
+
+		if (reversed)
+		{
+			for (auto w = vertices.crbegin(); w != vertices.crend(); ++w)
+				p.discover_vertex(perm[*w]);
+		}
+		else
+		{
+			for (auto w : vertices)
+				p.discover_vertex(perm[w]);
+		}
+
+		paths.emplace_back(p);
+	}
+}
+
+void orbit_path_source::get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length)
+{
+	map_paths(g, s, t, false, length, paths);
+}
+
+void orbit_path_source::get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths)
+{
+	map_paths(g, s, t, true, 0, paths);
+}
+
+std::vector<std::vector<index_t>> to_edge_permutations(const edge_index& edges, const std::vector<std::vector<index_t>>& generators)
+{
+	std::vector<std::vector<index_t>> perms;
+	perms.reserve(generators.size());
+
+	for (const auto& gen : generators)
+	{
+		std::vector<index_t> perm(edges.size());
+
+		for (index_t e = 0; e < edges.size(); ++e)
+		{
+			auto ends = edges.endpoints(e);
+			perm[e] = edges.id(gen[ends.first], gen[ends.second]);
+			assert(perm[e] != edge_index::NO_EDGE);
+		}
+
+		perms.emplace_back(perm);
+	}
+
+	return perms;
+}
@@ -0,0 +1,67 @@
+// symmetry.hpp
+#ifndef SYMMETRY_HPP
+#define SYMMETRY_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include "path_source.hpp"
+#include "edge_index.hpp"
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Orbits of vertex pairs {u,v}, u < v, under the group generated by the given
+// automorphisms. Each pair knows its orbit representative (the smallest pair
+// of the orbit) and a group element mapping the representative onto it.
+class pair_orbits
+{
+public:
+	pair_orbits(const graph& g, const std::vector<std::vector<index_t>>& generators);
+
+	index_t num_orbits() const { return orbits_; }
+
+	std::pair<index_t, index_t> representative(index_t u, index_t v) const;
+
+	// Maps representative(u, v) onto {u, v}, in some orientation.
+	const std::vector<index_t>& mapping(index_t u, index_t v) const;
+
+private:
+	index_t n_;
+	index_t orbits_;
+	std::vector<index_t> rep_;
+	std::vector<std::vector<index_t>> perm_;
+};
+
+// Enumerates the paths of one representative pair per orbit of Aut(G) and
+// maps them through the automorphism for the other pairs of the orbit.
+// Path sets of representatives are kept until the source is destroyed.
+class orbit_path_source : public path_source
+{
+public:
+	// Uses the generators found by canonical_label, and enumerates with
+	// list_paths unless another source is given.
+	explicit orbit_path_source(const graph& g, path_source* inner = nullptr);
+
+	orbit_path_source(const graph& g, const std::vector<std::vector<index_t>>& generators, path_source* inner = nullptr);
+
+	const pair_orbits& get_orbits() const { return orbits_; }
+
+	virtual void get_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths, index_t length);
+
+	virtual void get_shortest_paths(const graph& g, index_t s, index_t t, std::vector<edge_path>& paths);
+
+private:
+	typedef std::tuple<index_t, index_t, bool, index_t> key_type;
+
+	void map_paths(const graph& g, index_t s, index_t t, bool shortest, index_t length, std::vector<edge_path>& paths);
+
+	pair_orbits orbits_;
+	path_source* inner_;
+	std::map<key_type, std::vector<std::vector<index_t>>> representatives_;
+};
+
+// The permutations of edge ids induced by vertex automorphisms.
+std::vector<std::vector<index_t>> to_edge_permutations(const edge_index& edges, const std::vector<std::vector<index_t>>& generators);
+
+#endif
@@ -2,8 +2,179 @@
 #include "test.hpp"
 #include "graph.hpp"
 #include "common.hpp"
+#include "canonical.hpp"
+#include "result_memo.hpp"
+#include "path_estimate.hpp"
+#include "path.hpp"
+#include "rainbow_kernel.hpp"
+#include "verifier.hpp"
+#include "local_search.hpp"
+#include "path_index.hpp"
+#include "vertex_model_writer.hpp"
+#include "block_cut_tree.hpp"
+#include "total_model_writer.hpp"
+#include "rainbow_solver.hpp"
+#include "path_zdd.hpp"
+#include "binary_model.hpp"
+#include "single_source.hpp"
+#include "path_cache.hpp"
+#include "path_mitm.hpp"
+#include "path_spool.hpp"
+#include "lazy_solver.hpp"
+#include "forced_distinct.hpp"
+#include "graph_kernel.hpp"
+#include "minion_model_writer.hpp"
+#include "strong_model_writer.hpp"
+#include "cnf_model_writer.hpp"
+#include "flatzinc_model_writer.hpp"
+#include "xcsp_model_writer.hpp"
+#include "search_order.hpp"
+#include "solver_runner.hpp"
+#include "symmetry.hpp"
 
 #include <cassert>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	index_t count_occurrences(const std::string& text, const std::string& what)
+	{
+		index_t found = 0;
+
+		for (std::size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + 1))
+			++found;
+
+		return found;
+	}
+
+	// A file name in the temporary directory, unique to this process.
+	std::string get_temp_path(const std::string& name)
+	{
+		static std::random_device rd;
+		return (std::filesystem::temp_directory_path() / (std::to_string(rd()) + "." + name)).string();
+	}
+
+	// The exact solver given every pair of g, with the bridges distinct; the
+	// reduced and reordered variants are checked against it.
+	solve_status solve_all_pairs(const graph& g, index_t k, bool strong, std::vector<index_t>& colours)
+	{
+		const rainbow_checker checker(g, k, strong);
+		const edge_path_index paths(checker);
+		rainbow_solver solver(checker, paths, k);
+		solver.add_distinct(get_bridge_ids(g));
+		return solver.solve(colours);
+	}
+
+	bool propagate(const std::vector<std::vector<index_t>>& clauses, std::vector<signed char>& value)
+	{
+		for (bool changed = true; changed; )
+		{
+			changed = false;
+
+			for (const auto& clause : clauses)
+			{
+				index_t open = 0;
+				index_t last = 0;
+				bool satisfied = false;
+
+				for (auto lit : clause)
+				{
+					const signed char v = value[std::abs(lit)];
+
+					if (v == 0)
+					{
+						++open;
+						last = lit;
+					}
+					else if ((v > 0) == (lit > 0))
+					{
+						satisfied = true;
+						break;
+					}
+				}
+
+				if (satisfied)
+					continue;
+
+				if (open == 0)
+					return false;
+
+				if (open == 1)
+				{
+					value[std::abs(last)] = (last > 0) ? 1 : -1;
+					changed = true;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool search_cnf(const std::vector<std::vector<index_t>>& clauses, std::vector<signed char> value)
+	{
+		if (!propagate(clauses, value))
+			return false;
+
+		for (index_t x = 1; x < static_cast<index_t>(value.size()); ++x)
+		{
+			if (value[x] != 0)
+				continue;
+
+			for (signed char v : { 1, -1 })
+			{
+				std::vector<signed char> next(value);
+				next[x] = v;
+
+				if (search_cnf(clauses, next))
+					return true;
+			}
+
+			return false;
+		}
+
+		return true;
+	}
+
+	// Whether a DIMACS formula is satisfiable, by plain DPLL; only for the
+	// small formulas of the tests.
+	bool is_satisfiable_cnf(const std::string& text)
+	{
+		std::istringstream lines(text);
+		std::vector<std::vector<index_t>> clauses;
+		index_t variables = 0;
+
+		for (std::string line; std::getline(lines, line); )
+		{
+			std::istringstream fields(line);
+
+			if (line.empty() || line[0] == 'c')
+				continue;
+
+			if (line[0] == 'p')
+			{
+				std::string p, format;
+				fields >> p >> format >> variables;
+				continue;
+			}
+
+			clauses.emplace_back();
+			for (index_t lit; fields >> lit && lit != 0; )
+				clauses.back().emplace_back(lit);
+		}
+
+		return search_cnf(clauses, std::vector<signed char>(variables + 1, 0));
+	}
+}
 
 void run_tests()
 {
@@ -27,4 +198,2232 @@ void run_tests()
 
 		std::cout << "OK!\n";
 	}
-}
\ No newline at end of file
+
+	// Isomorphic graphs get the same canonical form, and the generators found
+	// are automorphisms.
+	{
+		std::cout << "Canonical form test ... ";
+
+		std::mt19937 gen(7);
+
+		const graph graphs[] = { build_random_graph(40, 0.3), build_clique(20), build_wheel(12), build_corona(6) };
+
+		for (const auto& g : graphs)
+		{
+			std::vector<index_t> perm(g.num_vertices());
+			std::iota(perm.begin(), perm.end(), 0);
+			std::shuffle(perm.begin(), perm.end(), gen);
+
+			auto c = canonical_label(g);
+			assert(c.form == canonical_label(relabel(g, perm)).form);
+
+			for (const auto& a : c.generators)
+				assert(is_automorphism(g, a));
+		}
+
+		assert(canonical_label(build_cycle(6)).form != canonical_label(build_path(6)).form);
+
+		std::cout << "OK!\n";
+	}
+
+	// Results are shared by isomorphic graphs and only by them.
+	{
+		std::cout << "Result memo test ... ";
+
+		std::mt19937 gen(11);
+
+		const graph cycle = build_cycle(6);
+		std::vector<index_t> perm(cycle.num_vertices());
+		std::iota(perm.begin(), perm.end(), 0);
+		std::shuffle(perm.begin(), perm.end(), gen);
+		const graph shuffled = relabel(cycle, perm);
+
+		result_memo memo;
+		assert(memo.find(cycle) == nullptr);
+
+		memo[cycle].rainbow_polynomial = { 0, 0, 42 };
+		assert(memo.find(shuffled) == &memo[cycle]);
+		assert(memo.find(shuffled)->rainbow_polynomial.size() == 3);
+		assert(memo.find(build_path(6)) == nullptr && memo.size() == 1);
+
+		// A stored value is returned without solving.
+		memo[cycle].rc = 42;
+		assert(rainbow_connection_number(shuffled, memo) == 42);
+
+		result_memo batch;
+		const std::vector<graph> graphs = { cycle, build_path(6), shuffled, build_wheel(7), relabel(build_path(6), perm) };
+		const auto rc = rainbow_connection_numbers(graphs, batch);
+		const auto src = rainbow_connection_numbers(graphs, batch, true);
+
+		assert(batch.size() == 3);
+		assert(rc[0] == 3 && rc[1] == 5 && rc[2] == 3 && rc[4] == 5);
+		assert(src[0] == 3 && src[1] == 5 && src[2] == 3 && src[4] == 5);
+		assert(rc[3] <= src[3] && batch.find(graphs[3])->src == src[3]);
+
+		std::cout << "OK!\n";
+	}
+
+	// Path counts by length agree with enumeration.
+	{
+		std::cout << "Path counting test ... ";
+
+		const graph graphs[] = { build_wheel(7), build_clique(7), build_random_graph(12, 0.4), build_corona(4) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+
+			for (index_t length : { 3, 5, 64 })
+			{
+				std::vector<edge_path> paths;
+				list_paths(g, 0, n - 1, paths, length);
+
+				std::vector<std::uint64_t> expected(std::min(length, n - 1) + 1, 0);
+				for (const auto& p : paths)
+					++expected[p.size()];
+
+				assert(count_paths(g, 0, n - 1, length) == expected);
+			}
+
+			std::vector<edge_path> shortest;
+			list_shortest_paths(g, 1, n - 2, shortest);
+			assert(count_shortest_paths(g, 1, n - 2) == shortest.size());
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// The probe estimates average out to the exact path counts, and pairs are
+	// scheduled most expensive first.
+	{
+		std::cout << "Path estimate test ... ";
+
+		const graph graphs[] = { build_wheel(7), build_clique(7), build_path(6) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+
+			for (index_t length : { 3, 64 })
+			{
+				const auto counts = count_paths(g, 0, n - 2, length);
+
+				double paths = 0.0;
+				double edges = 0.0;
+				for (std::size_t i = 0; i < counts.size(); ++i)
+				{
+					paths += counts[i];
+					edges += counts[i] * static_cast<double>(i);
+				}
+
+				const path_estimate e = estimate_paths(g, 0, n - 2, length, 20000, 5);
+				assert(std::abs(e.paths - paths) <= 0.1 * paths);
+				assert(std::abs(e.edges - edges) <= 0.1 * edges + 1e-9);
+				assert(e.nodes >= e.paths);
+			}
+		}
+
+		const graph g = build_wheel(8);
+		auto costs = estimate_pair_costs(g, 64);
+		assert(costs.size() == nchoosek(g.num_vertices(), 2) - g.num_edges());
+
+		auto sorted = costs;
+		sort_by_cost(sorted);
+
+		for (std::size_t i = 1; i < sorted.size(); ++i)
+			assert(sorted[i - 1].cost >= sorted[i].cost);
+
+		const auto most = std::max_element(costs.begin(), costs.end(), [](const pair_cost& a, const pair_cost& b) { return a.cost < b.cost; });
+		assert(sorted.front().u == most->u && sorted.front().v == most->v);
+
+		auto key = [](const pair_cost& c) { return std::make_pair(c.u, c.v); };
+		std::vector<std::pair<index_t, index_t>> before, after;
+		std::transform(costs.begin(), costs.end(), std::back_inserter(before), key);
+		std::transform(sorted.begin(), sorted.end(), std::back_inserter(after), key);
+		std::sort(after.begin(), after.end());
+		assert(before == after);
+
+		std::cout << "OK!\n";
+	}
+
+	// The rainbow kernels agree with a direct check of every path.
+	{
+		std::cout << "Rainbow kernel test ... ";
+
+		std::mt19937 gen(7);
+		const graph graphs[] = { build_random_graph(14, 0.3), build_wheel(9), build_cycle(9) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t m = g.num_edges();
+			const index_t k = 4;
+			rainbow_checker checker(g, k);
+			const edge_index& index = checker.get_edge_index();
+
+			for (index_t colours_used : { 4, 40 })
+			{
+				std::uniform_int_distribution<index_t> colour(1, colours_used);
+				const index_t batch_size = 37;
+				colouring_batch batch(m, batch_size);
+				std::vector<index_t> expected(batch_size, 0);
+
+				for (index_t b = 0; b < batch_size; ++b)
+				{
+					std::vector<index_t> colours(m);
+					for (auto& c : colours)
+						c = colour(gen);
+
+					batch.set(b, colours);
+					const packed_colouring packed(colours);
+
+					for (index_t i = 0; i < checker.num_pairs(); ++i)
+					{
+						const auto pair = checker.get_pair(i);
+						std::vector<edge_path> paths;
+						list_paths(g, pair.first, pair.second, paths, k);
+
+						bool rainbow = false;
+						for (const auto& p : paths)
+						{
+							std::vector<index_t> used;
+							for (auto e : index.to_ids(p))
+								used.emplace_back(colours[e]);
+
+							std::sort(used.begin(), used.end());
+							rainbow |= std::adjacent_find(used.begin(), used.end()) == used.end();
+						}
+
+						const path_matrix& matrix = checker.get_paths(i);
+						const index_t row = matrix.find_rainbow(packed);
+						assert((row != -1) == rainbow);
+
+						if (row != -1)
+						{
+							std::vector<index_t> used;
+							for (index_t j = 0; j < matrix.length(row); ++j)
+								used.emplace_back(colours[matrix.edge(row, j)]);
+
+							std::sort(used.begin(), used.end());
+							assert(std::adjacent_find(used.begin(), used.end()) == used.end());
+						}
+
+						expected[b] += !rainbow;
+					}
+
+					assert(checker.count_violations(packed) == expected[b]);
+				}
+
+				std::vector<index_t> violations;
+				checker.count_violations(batch, violations);
+				assert(violations == expected);
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// The verifier agrees with path enumeration and reads solver output.
+	{
+		std::cout << "Verifier test ... ";
+
+		std::mt19937 gen(11);
+		const graph graphs[] = { build_random_graph(10, 0.35), build_wheel(8), build_clique(8) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t m = g.num_edges();
+			const rainbow_checker any_path(g, g.num_vertices() - 1);
+			const rainbow_checker geodesic(g, 0, true);
+
+			for (index_t colours_used : { 3, 5, 30 })
+			{
+				std::uniform_int_distribution<index_t> colour(1, colours_used);
+
+				for (index_t trial = 0; trial < 20; ++trial)
+				{
+					std::vector<index_t> colours(m);
+					for (auto& c : colours)
+						c = colour(gen);
+
+					const packed_colouring packed(colours);
+
+					for (bool strong : { false, true })
+					{
+						const rainbow_checker& checker = strong ? geodesic : any_path;
+						std::vector<std::pair<index_t, index_t>> expected;
+
+						for (index_t i = 0; i < checker.num_pairs(); ++i)
+						{
+							if (!checker.get_paths(i).any_rainbow(packed))
+								expected.emplace_back(checker.get_pair(i));
+						}
+
+						assert(find_violations(g, colours, strong, 2) == expected);
+					}
+				}
+			}
+		}
+
+		// Path 0-1-2 coloured 1, 2 and the same again.
+		graph p = build_path(3);
+		std::istringstream minion("Sol: 1\nSol: 2\nSolution Number: 1\nSol: 2 2\n");
+		std::istringstream minizinc("x0_1 = 1;\nx1_2 = 2;\n----------\nx0_1 = 2; x1_2 = 2;\n----------\n==========\n");
+
+		const auto a = read_minion_solutions(p, minion);
+		const auto b = read_minizinc_solutions(p, minizinc);
+
+		assert(a == b && a.size() == 2);
+		assert(is_rainbow_colouring(p, a[0]) && !is_rainbow_colouring(p, a[1]));
+		assert(find_violations(p, a[1]) == (std::vector<std::pair<index_t, index_t>>{ { 0, 2 } }));
+
+		std::cout << "OK!\n";
+	}
+
+	// The edge-path index lists exactly the paths through each edge, and
+	// incremental rainbow states match a check from scratch.
+	{
+		std::cout << "Edge-path index test ... ";
+
+		std::mt19937 gen(5);
+		const graph graphs[] = { build_random_graph(14, 0.3), build_wheel(10) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t m = g.num_edges();
+			const index_t k = 4;
+			const rainbow_checker checker(g, k);
+			const edge_path_index index(checker);
+
+			std::vector<index_t> through(m, 0);
+			for (index_t i = 0; i < checker.num_pairs(); ++i)
+			{
+				const path_matrix& paths = checker.get_paths(i);
+				for (index_t p = 0; p < paths.num_paths(); ++p)
+				{
+					for (index_t j = 0; j < paths.length(p); ++j)
+						++through[paths.edge(p, j)];
+				}
+			}
+
+			for (index_t e = 0; e < m; ++e)
+			{
+				index_t count = 0;
+				index.for_each(e, [&](index_t pair, index_t row)
+				{
+					const path_matrix& paths = checker.get_paths(pair);
+
+					bool found = false;
+					for (index_t j = 0; j < paths.length(row); ++j)
+						found |= paths.edge(row, j) == e;
+
+					assert(found);
+					++count;
+				});
+
+				assert(count == through[e] && index.postings(e) == count);
+			}
+
+			std::uniform_int_distribution<index_t> colour(1, k);
+			std::uniform_int_distribution<index_t> edge(0, m - 1);
+
+			std::vector<index_t> colours(m);
+			for (auto& c : colours)
+				c = colour(gen);
+
+			rainbow_state state(checker, index, colours);
+
+			for (index_t step = 0; step < 200; ++step)
+			{
+				const index_t e = edge(gen);
+				const index_t c = colour(gen);
+				const index_t before = state.num_violations();
+				const index_t d = state.delta(e, c);
+
+				state.recolour(e, c);
+				colours[e] = c;
+
+				assert(state.num_violations() == before + d);
+				assert(state.num_violations() == checker.count_violations(packed_colouring(colours)));
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Local search finds rainbow colourings that the verifier accepts.
+	{
+		std::cout << "Local search test ... ";
+
+		// rc(C_n) = ceil(n / 2).
+		local_search search(build_cycle(8), 4);
+		std::vector<index_t> colours;
+		assert(search.solve(colours) && search.get_violations() == 0);
+		assert(is_rainbow_colouring(build_cycle(8), colours));
+
+		const graph graphs[] = { build_wheel(9), build_random_graph(16, 0.3) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			for (bool strong : { false, true })
+			{
+				const index_t k = local_search_upper_bound(g, colours, strong);
+
+				assert(k >= get_diameter(g));
+				assert(*std::max_element(colours.begin(), colours.end()) <= k);
+				assert(is_rainbow_colouring(g, colours, strong));
+			}
+		}
+
+		// Searching over path ZDDs finds rainbow colourings too.
+		for (bool strong : { false, true })
+		{
+			const graph g = build_wheel(9);
+			zdd_local_search zdd_search(g, 3, strong);
+			colours.clear();
+			assert(zdd_search.solve(colours) && zdd_search.get_violations() == 0);
+			assert(is_rainbow_colouring(g, colours, strong));
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Vertex rainbow connection: the minimal internal-vertex sets and the cut
+	// vertex constraint accept exactly the colourings found by brute force.
+	{
+		std::cout << "Vertex rainbow test ... ";
+
+		const graph graphs[] = { build_path(6), build_cycle(7), build_corona(3), build_wheel(5), build_random_graph(7, 0.4) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			const index_t n = g.num_vertices();
+			const std::uint64_t cuts = get_block_cut_tree(g).cut_vertices;
+
+			for (index_t k = 1; k <= 3; ++k)
+			{
+				std::vector<std::pair<index_t, index_t>> pairs;
+				std::vector<std::vector<std::uint64_t>> sets;
+				std::vector<std::vector<std::uint64_t>> all_paths;
+
+				for (index_t u = 0; u < n; ++u)
+				{
+					std::vector<index_t> dist(n, 0);
+					bfs(g, dist, u);
+
+					for (index_t v = u + 1; v < n; ++v)
+					{
+						std::vector<vertex_path> paths;
+						list_paths(g, u, v, paths, n);
+
+						pairs.emplace_back(u, v);
+						all_paths.emplace_back();
+						for (const auto& p : paths)
+							all_paths.back().emplace_back(p.get_internal_vertices());
+
+						if (dist[v] >= 3)
+							sets.emplace_back(get_internal_vertex_sets(g, u, v, k));
+						else
+							sets.emplace_back(1, 0);
+					}
+				}
+
+				std::vector<index_t> colours(n, 1);
+				auto rainbow = [&colours](std::uint64_t vertices)
+				{
+					std::uint64_t used = 0;
+					for (std::uint64_t x = vertices; x != 0; x &= x - 1)
+					{
+						if (used & (1ULL << colours[ctz64(x)]))
+							return false;
+
+						used |= (1ULL << colours[ctz64(x)]);
+					}
+
+					return true;
+				};
+
+				for (;;)
+				{
+					bool brute = true;
+					bool model = rainbow(cuts);
+
+					for (std::size_t i = 0; i < pairs.size(); ++i)
+					{
+						brute &= std::any_of(all_paths[i].begin(), all_paths[i].end(), rainbow);
+						model &= std::any_of(sets[i].begin(), sets[i].end(), rainbow);
+					}
+
+					assert(brute == model);
+
+					// Next colouring, as a base-k counter.
+					index_t i = 0;
+					while (i < n && colours[i] == k)
+						colours[i++] = 1;
+
+					if (i == n)
+						break;
+
+					++colours[i];
+				}
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Paths composed from block segments are the paths of the whole graph,
+	// for every pair and bound, on graphs of several blocks.
+	{
+		std::cout << "Block path source test ... ";
+
+		auto vertices = [](const std::vector<edge_path>& paths)
+		{
+			std::vector<std::vector<index_t>> lists;
+			for (const auto& p : paths)
+				lists.emplace_back(p.cbegin(), p.cend());
+
+			std::sort(lists.begin(), lists.end());
+			return lists;
+		};
+
+		// Two cycles sharing a vertex, with a clique hanging off a bridge.
+		graph chained(12);
+		for (index_t v = 0; v < 4; ++v)
+			chained.add_edge(v, (v + 1) % 4);
+		for (index_t v = 3; v < 8; ++v)
+			chained.add_edge(v, v == 7 ? 3 : v + 1);
+		chained.add_edge(7, 8);
+		for (index_t u = 8; u < 12; ++u)
+		{
+			for (index_t v = u + 1; v < 12; ++v)
+				chained.add_edge(u, v);
+		}
+
+		const graph graphs[] = { chained, build_corona(4), build_star(5), build_path(6), build_cycle(6), build_random_graph(12, 0.2) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			block_path_source source(g);
+			const index_t n = g.num_vertices();
+
+			for (index_t s = 0; s < n; ++s)
+			{
+				for (index_t t = s + 1; t < n; ++t)
+				{
+					for (index_t length : { 2, 4, 7 })
+					{
+						std::vector<edge_path> paths;
+						std::vector<edge_path> expected;
+						source.get_paths(g, s, t, paths, length);
+						list_paths(g, s, t, expected, length);
+						assert(vertices(paths) == vertices(expected));
+					}
+
+					std::vector<edge_path> paths;
+					std::vector<edge_path> expected;
+					source.get_shortest_paths(g, s, t, paths);
+					list_shortest_paths(g, s, t, expected);
+					assert(vertices(paths) == vertices(expected));
+				}
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Paths mapped from the orbit representatives are the paths list_paths
+	// finds for every pair.
+	{
+		std::cout << "Orbit path source test ... ";
+
+		auto vertices = [](const std::vector<edge_path>& paths)
+		{
+			std::vector<std::vector<index_t>> lists;
+			for (const auto& p : paths)
+				lists.emplace_back(p.cbegin(), p.cend());
+
+			std::sort(lists.begin(), lists.end());
+			return lists;
+		};
+
+		const graph graphs[] = { build_cycle(7), build_wheel(6), build_biclique(3, 4), build_corona(4), build_star(5), build_random_graph(9, 0.4) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+			orbit_path_source source(g);
+			const pair_orbits& orbits = source.get_orbits();
+			assert(orbits.num_orbits() <= nchoosek(n, 2));
+
+			for (index_t s = 0; s < n; ++s)
+			{
+				for (index_t t = s + 1; t < n; ++t)
+				{
+					const auto rep = orbits.representative(s, t);
+					const auto& perm = orbits.mapping(s, t);
+					assert(rep <= std::make_pair(s, t));
+					assert(std::min(perm[rep.first], perm[rep.second]) == s && std::max(perm[rep.first], perm[rep.second]) == t);
+
+					for (index_t length : { 2, 3, 5 })
+					{
+						std::vector<edge_path> paths;
+						std::vector<edge_path> expected;
+						source.get_paths(g, s, t, paths, length);
+						list_paths(g, s, t, expected, length);
+						assert(vertices(paths) == vertices(expected));
+					}
+
+					std::vector<edge_path> paths;
+					std::vector<edge_path> expected;
+					source.get_shortest_paths(g, s, t, paths);
+					list_shortest_paths(g, s, t, expected);
+					assert(vertices(paths) == vertices(expected));
+				}
+			}
+		}
+
+		// A vertex-transitive cycle has one orbit per distance.
+		assert(orbit_path_source(build_cycle(7)).get_orbits().num_orbits() == 3);
+
+		std::cout << "OK!\n";
+	}
+
+	// A spool gives back the paths it was handed, sorted by vertex sequence,
+	// whether it kept them in memory or spilled runs to disk.
+	{
+		std::cout << "Path spool test ... ";
+
+		const graph g = build_clique(8);
+		std::vector<edge_path> paths;
+		list_paths(g, 0, 7, paths, 5);
+
+		std::vector<std::vector<index_t>> expected;
+		for (const auto& p : paths)
+			expected.emplace_back(p.cbegin(), p.cend());
+		std::sort(expected.begin(), expected.end());
+
+		for (std::size_t budget : { 0, 1024 })
+		{
+			path_spool spool(budget);
+			for (const auto& p : paths)
+				spool.add(p);
+
+			assert(spool.size() == static_cast<index_t>(paths.size()));
+
+			std::vector<std::vector<index_t>> found;
+			spool.for_each([&found](const edge_path& p) { found.emplace_back(p.cbegin(), p.cend()); });
+			assert(found == expected);
+
+			if (budget == 0)
+			{
+				assert(spool.num_runs() == 0);
+			}
+			else
+			{
+				// One record past the budget triggers a spill.
+				assert(spool.num_runs() > 1);
+				assert(spool.peak_bytes() <= budget + 8 + sizeof(std::size_t));
+			}
+
+			spool.clear();
+			assert(spool.empty() && spool.num_runs() == 0);
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// The path cache builds its file once, reads it back in place on reopening,
+	// rebuilds a stale file, and gives the paths list_paths finds.
+	{
+		std::cout << "Path cache test ... ";
+
+		auto vertices = [](const std::vector<edge_path>& paths)
+		{
+			std::vector<std::vector<index_t>> lists;
+			for (const auto& p : paths)
+				lists.emplace_back(p.cbegin(), p.cend());
+
+			std::sort(lists.begin(), lists.end());
+			return lists;
+		};
+
+		const graph wheel = build_wheel(7);
+		const index_t n = wheel.num_vertices();
+		const std::string directory = get_temp_path("path_cache");
+
+		auto check = [&](path_cache& cache, const graph& g)
+		{
+			for (index_t s = 0; s < n; ++s)
+			{
+				for (index_t t = s + 1; t < n; ++t)
+				{
+					if (is_adjacent(g, s, t))
+						continue;
+
+					std::vector<edge_path> expected;
+					list_paths(g, s, t, expected, 4);
+
+					const cached_paths cached = cache.find(g, s, t, false, 4);
+					assert(cached.data != nullptr && cached.count == static_cast<index_t>(expected.size()));
+
+					std::vector<edge_path> paths;
+					cache.get_paths(g, s, t, paths, 4);
+					assert(vertices(paths) == vertices(expected));
+
+					paths.clear();
+					expected.clear();
+					cache.get_shortest_paths(g, s, t, paths);
+					list_shortest_paths(g, s, t, expected);
+					assert(vertices(paths) == vertices(expected));
+				}
+			}
+		};
+
+		auto files = [&directory]()
+		{
+			std::vector<std::string> names;
+			for (const auto& entry : std::filesystem::directory_iterator(directory))
+				names.emplace_back(entry.path().string());
+
+			std::sort(names.begin(), names.end());
+			return names;
+		};
+
+		{
+			path_cache cache(directory);
+			check(cache, wheel);
+		}
+
+		// One file for the bounded paths and one for the geodesics.
+		const auto built = files();
+		assert(built.size() == 2);
+
+		std::vector<std::filesystem::file_time_type> times;
+		for (const auto& name : built)
+			times.emplace_back(std::filesystem::last_write_time(name));
+
+		{
+			path_cache cache(directory);
+			check(cache, wheel);
+		}
+
+		assert(files() == built);
+		for (std::size_t i = 0; i < built.size(); ++i)
+			assert(std::filesystem::last_write_time(built[i]) == times[i]);
+
+		// An isomorphic copy reads the same files, through its own labels.
+		{
+			std::vector<index_t> perm(n);
+			std::iota(perm.begin(), perm.end(), 0);
+			std::shuffle(perm.begin(), perm.end(), std::mt19937(3));
+
+			path_cache cache(directory);
+			check(cache, relabel(wheel, perm));
+		}
+
+		assert(files() == built);
+
+		// Stale or truncated files are rebuilt.
+		std::ofstream(built[0], std::ios::binary) << "stale";
+		std::ofstream(built[1], std::ios::binary | std::ios::trunc);
+
+		{
+			path_cache cache(directory);
+			check(cache, wheel);
+		}
+
+		assert(files() == built);
+		for (const auto& name : built)
+			assert(std::filesystem::file_size(name) > 5);
+
+		std::filesystem::remove_all(directory);
+
+		std::cout << "OK!\n";
+	}
+
+	// Total rainbow connection: the exact solver against brute force over all
+	// colourings of edges and vertices, checked by the verifier.
+	{
+		std::cout << "Total rainbow test ... ";
+
+		const graph graphs[] = { build_path(4), build_star(3), build_cycle(4), build_cycle(5), build_wheel(3), build_corona(2) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+			const index_t elements = g.num_edges() + n;
+
+			// Smallest k with a total rainbow colouring, by trying them all.
+			index_t brute = 0;
+			for (index_t k = 1; brute == 0; ++k)
+			{
+				std::vector<index_t> colours(elements, 1);
+
+				for (;;)
+				{
+					if (find_total_violations(g, colours, 1).empty())
+					{
+						brute = k;
+						break;
+					}
+
+					index_t i = 0;
+					while (i < elements && colours[i] == k)
+						colours[i++] = 1;
+
+					if (i == elements)
+						break;
+
+					++colours[i];
+				}
+			}
+
+			// A tree needs distinct colours on all edges and internal vertices.
+			if (g.num_edges() == n - 1)
+				assert(brute == g.num_edges() + popcount64(get_block_cut_tree(g).cut_vertices));
+
+			std::vector<index_t> colours;
+
+			if (brute > 1)
+				assert(solve_total_rainbow(g, brute - 1, colours) == solve_status::unsatisfiable);
+
+			assert(solve_total_rainbow(g, brute, colours) == solve_status::satisfiable);
+			assert(static_cast<index_t>(colours.size()) == elements);
+			assert(find_total_violations(g, colours).empty());
+		}
+
+		const graph g = build_random_graph(14, 0.3);
+
+		if (is_connected(g))
+		{
+			std::vector<index_t> colours;
+			index_t k = 1;
+			while (solve_total_rainbow(g, k, colours, 10.0) != solve_status::satisfiable)
+				++k;
+
+			assert(find_total_violations(g, colours).empty());
+		}
+
+		std::ostringstream os;
+		total_model_writer(build_path(4), 5, os).write();
+		assert(os.str().find("var 1..k: x1_2;") != std::string::npos);
+		assert(os.str().find("var 1..k: x3;") != std::string::npos);
+		assert(os.str().find("alldifferent([x0_1,x1_2,x2_3,x1,x2])") != std::string::npos);
+
+		std::ostringstream short_os;
+		total_model_writer(build_path(4), 4, short_os).write();
+		assert(short_os.str().find("constraint false;") != std::string::npos);
+
+		// The hybrid mode keeps the palettes apart: only k edges and k internal
+		// vertices need distinct colours, each among themselves.
+		for (const auto& g : graphs)
+		{
+			const index_t elements = g.num_edges() + g.num_vertices();
+
+			index_t brute = 0;
+			for (index_t k = 1; brute == 0; ++k)
+			{
+				std::vector<index_t> colours(elements, 1);
+
+				for (;;)
+				{
+					if (find_hybrid_violations(g, colours, 1).empty())
+					{
+						brute = k;
+						break;
+					}
+
+					index_t i = 0;
+					while (i < elements && colours[i] == k)
+						colours[i++] = 1;
+
+					if (i == elements)
+						break;
+
+					++colours[i];
+				}
+			}
+
+			std::vector<index_t> colours;
+
+			if (brute > 1)
+				assert(solve_hybrid_rainbow(g, brute - 1, colours) == solve_status::unsatisfiable);
+
+			assert(solve_hybrid_rainbow(g, brute, colours) == solve_status::satisfiable);
+			assert(static_cast<index_t>(colours.size()) == elements);
+			assert(*std::max_element(colours.begin(), colours.end()) <= brute);
+			assert(find_hybrid_violations(g, colours).empty());
+
+			// The edges alone are rainbow connected.
+			const std::vector<index_t> edge_colours(colours.begin(), colours.begin() + g.num_edges());
+			assert(is_rainbow_colouring(g, edge_colours));
+		}
+
+		std::ostringstream hybrid_os;
+		hybrid_model_writer(build_path(4), 3, hybrid_os).write();
+		assert(hybrid_os.str().find("var 1..k: x3;") != std::string::npos);
+		assert(hybrid_os.str().find("alldifferent([x0_1,x1_2,x2_3,x1 + k,x2 + k])") != std::string::npos);
+		assert(hybrid_os.str().find("constraint false;") == std::string::npos);
+
+		std::cout << "OK!\n";
+	}
+
+	// A binary model written to a file and read back feeds a writer the paths
+	// it would have found itself, and refuses queries it cannot answer.
+	{
+		std::cout << "Binary model test ... ";
+
+		const graph g = build_corona(4);
+		const index_t k = 3;
+		const std::string filename = get_temp_path("model.rcbm");
+
+		for (bool strong : { false, true })
+		{
+			{
+				std::ofstream file(filename, std::ios::binary);
+				if (strong)
+					strong_binary_model_writer(g, k, file).write();
+				else
+					binary_model_writer(g, k, file).write();
+			}
+
+			std::ostringstream expected;
+			std::ostringstream replayed;
+
+			std::ifstream file(filename, std::ios::binary);
+			binary_model_reader reader(file);
+			assert(reader.header().k == k && reader.header().shortest == strong);
+			const graph h = build_graph(reader.header());
+			binary_path_source source(reader, h);
+
+			if (strong)
+			{
+				strong_model_writer(g, k, expected).write();
+				strong_model_writer writer(h, k, replayed);
+				writer.set_path_source(&source);
+				writer.write();
+			}
+			else
+			{
+				model_writer(g, k, expected).write();
+				model_writer writer(h, k, replayed);
+				writer.set_path_source(&source);
+				writer.write();
+			}
+
+			assert(replayed.str() == expected.str());
+
+			// The other kind of query, or longer paths than were stored.
+			std::vector<edge_path> paths;
+			bool thrown = false;
+			try
+			{
+				if (strong)
+					source.get_paths(h, 0, 2, paths, k);
+				else
+					source.get_shortest_paths(h, 0, 2, paths);
+			}
+			catch (const std::runtime_error&)
+			{
+				thrown = true;
+			}
+			assert(thrown && paths.empty());
+
+			if (!strong)
+			{
+				thrown = false;
+				try
+				{
+					source.get_paths(h, 0, 2, paths, k + 1);
+				}
+				catch (const std::runtime_error&)
+				{
+					thrown = true;
+				}
+				assert(thrown && paths.empty());
+			}
+
+			// Forced facts are found from the stored paths as from the graph;
+			// the writers themselves store every pair and refuse to leave any out.
+			file.clear();
+			file.seekg(0);
+			binary_model_reader forced_reader(file);
+			binary_path_source forced_source(forced_reader, h);
+
+			const forced_distinct direct(rainbow_checker(g, k, strong));
+			const forced_distinct stored(rainbow_checker(h, k, strong, &forced_source));
+			assert(direct.num_facts() > 0 && stored.num_facts() == direct.num_facts());
+			assert(stored.get_cliques() == direct.get_cliques() && stored.num_satisfied() == direct.num_satisfied());
+
+			std::ostringstream sink;
+			thrown = false;
+			try
+			{
+				if (strong)
+				{
+					strong_binary_model_writer writer(g, k, sink);
+					writer.set_forced_distinct(true);
+					writer.write();
+				}
+				else
+				{
+					binary_model_writer writer(g, k, sink);
+					writer.set_forced_distinct(true);
+					writer.write();
+				}
+			}
+			catch (const std::runtime_error&)
+			{
+				thrown = true;
+			}
+			assert(thrown);
+		}
+
+		std::remove(filename.c_str());
+
+		std::cout << "OK!\n";
+	}
+
+	// Path ZDDs hold exactly the paths list_paths finds; projected on the
+	// internal vertices and reduced to minimal sets they give the vertex
+	// rainbow sets.
+	{
+		std::cout << "Path ZDD test ... ";
+
+		const graph graphs[] = { build_wheel(6), build_biclique(3, 3), build_cycle(7), build_clique(6), build_random_graph(9, 0.4) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+			const index_t m = g.num_edges();
+			const edge_index index(g);
+
+			for (index_t s = 0; s < n; ++s)
+			{
+				for (index_t t = s + 1; t < n; ++t)
+				{
+					for (index_t length : { 2, 3, 5 })
+					{
+						std::vector<edge_path> paths;
+						list_paths(g, s, t, paths, length);
+
+						std::vector<std::vector<index_t>> expected;
+						std::vector<std::vector<index_t>> expected_total;
+						for (const auto& p : paths)
+						{
+							expected.emplace_back(index.to_ids(p));
+							std::sort(expected.back().begin(), expected.back().end());
+
+							expected_total.emplace_back(to_total_ids(index, p));
+							std::sort(expected_total.back().begin(), expected_total.back().end());
+						}
+
+						std::sort(expected.begin(), expected.end());
+						std::sort(expected_total.begin(), expected_total.end());
+
+						const zdd z = build_path_zdd(g, s, t, length);
+						assert(z.count() == paths.size());
+
+						std::vector<std::vector<index_t>> found;
+						z.for_each([&](const std::vector<index_t>& ids)
+						{
+							assert(to_edge_path(index, s, ids).size() == static_cast<index_t>(ids.size()));
+							found.emplace_back(ids);
+							std::sort(found.back().begin(), found.back().end());
+						});
+
+						std::sort(found.begin(), found.end());
+						assert(found == expected);
+
+						// Edge sets of s-t paths are never nested.
+						assert(z.minimal().count() == z.count());
+
+						const zdd total = build_path_zdd(g, s, t, length, true);
+						found.clear();
+						total.for_each([&](const std::vector<index_t>& ids)
+						{
+							found.emplace_back(ids);
+							std::sort(found.back().begin(), found.back().end());
+						});
+
+						std::sort(found.begin(), found.end());
+						assert(found == expected_total);
+
+						if (length < 3)
+							continue;
+
+						const zdd inner = total.project([m](index_t x) { return x >= m; }).minimal();
+						std::vector<std::uint64_t> sets;
+						inner.for_each([&](const std::vector<index_t>& ids)
+						{
+							std::uint64_t mask = 0;
+							for (auto x : ids)
+								mask |= (1ULL << (x - m));
+
+							sets.emplace_back(mask);
+						});
+
+						auto expected_sets = get_internal_vertex_sets(g, s, t, length - 1);
+						std::sort(sets.begin(), sets.end());
+						std::sort(expected_sets.begin(), expected_sets.end());
+						assert(sets == expected_sets);
+					}
+				}
+			}
+		}
+
+		// The ZDD as a path source gives the checker the same paths.
+		const graph g = build_random_graph(12, 0.35);
+		zdd_path_source source;
+		const rainbow_checker direct(g, 4);
+		const rainbow_checker from_zdd(g, 4, false, &source);
+		assert(direct.num_pairs() == from_zdd.num_pairs());
+
+		// Or decides rainbow connection on its nodes, without the paths, as
+		// the verifier does.
+		const zdd_checker zdds(g, 4);
+		const zdd_checker strong_zdds(g, 4, true);
+		const zdd_checker total_zdds(g, 4, false, true);
+		const rainbow_checker total = make_total_checker(g, 4);
+		assert(zdds.num_pairs() == direct.num_pairs() && total_zdds.num_elements() == total.num_elements());
+
+		std::mt19937_64 gen(11);
+		std::uniform_int_distribution<index_t> colour(1, 4);
+
+		for (int r = 0; r < 20; ++r)
+		{
+			std::vector<index_t> colours(total.num_elements());
+			for (auto& c : colours)
+				c = colour(gen);
+
+			const std::vector<index_t> edge_colours(colours.begin(), colours.begin() + g.num_edges());
+			const packed_colouring packed(edge_colours);
+			const packed_colouring total_packed(colours);
+			assert(direct.count_violations(packed) == from_zdd.count_violations(packed));
+			assert(zdds.count_violations(edge_colours) == direct.count_violations(packed));
+			assert(total_zdds.count_violations(colours) == total.count_violations(total_packed));
+
+			for (index_t i = 0; i < direct.num_pairs(); ++i)
+			{
+				assert(zdds.get_pair(i) == direct.get_pair(i));
+				assert(zdds.is_satisfied(i, edge_colours) == direct.get_paths(i).any_rainbow(packed));
+			}
+
+			auto sorted = [](std::vector<std::pair<index_t, index_t>> pairs)
+			{
+				std::sort(pairs.begin(), pairs.end());
+				return pairs;
+			};
+
+			// A rainbow path under 4 colours has at most 4 elements anyway.
+			if (is_connected(g))
+			{
+				assert(sorted(zdds.find_violations(edge_colours)) == sorted(find_violations(g, edge_colours)));
+				assert(sorted(strong_zdds.find_violations(edge_colours)) == sorted(find_violations(g, edge_colours, true)));
+				assert(sorted(total_zdds.find_violations(colours)) == sorted(find_total_violations(g, colours)));
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// One DFS per source finds the same paths as one DFS per pair.
+	{
+		std::cout << "Single-source paths test ... ";
+
+		auto vertices = [](const std::vector<edge_path>& paths)
+		{
+			std::vector<std::vector<index_t>> lists;
+			for (const auto& p : paths)
+				lists.emplace_back(p.cbegin(), p.cend());
+
+			std::sort(lists.begin(), lists.end());
+			return lists;
+		};
+
+		const graph graphs[] = { build_wheel(7), build_biclique(3, 4), build_corona(3), build_random_graph(10, 0.35) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+
+			// Per-target bounds.
+			for (index_t s = 0; s < n; ++s)
+			{
+				std::vector<index_t> lengths(n);
+				for (index_t t = 0; t < n; ++t)
+					lengths[t] = 2 + (s + t) % 3;
+
+				const index_t targets = ((1ULL << n) - 1) & ~(1ULL << s);
+				std::vector<std::vector<edge_path>> found(n);
+				auto add = [&found](index_t t, const edge_path& p) { found[t].emplace_back(p); };
+				visit_paths_from<edge_path>(g, s, targets, lengths, add);
+
+				for (index_t t = 0; t < n; ++t)
+				{
+					if (t == s)
+						continue;
+
+					std::vector<edge_path> expected;
+					list_paths(g, s, t, expected, lengths[t]);
+					assert(vertices(found[t]) == vertices(expected));
+				}
+			}
+
+			// A small budget sends the sources pair by pair.
+			for (std::size_t budget : { 0, 256 })
+			{
+				for (bool shortest : { false, true })
+				{
+					single_source_path_source source;
+					source.set_memory_budget(budget);
+					index_t u = 0;
+					index_t v = 1;
+					index_t sources = 0;
+
+					for (index_t i = 0; i < nchoosek(n, 2); ++i)
+					{
+						if (!is_adjacent(g, u, v))
+						{
+							std::vector<edge_path> paths;
+							std::vector<edge_path> expected;
+
+							if (shortest)
+							{
+								source.get_shortest_paths(g, u, v, paths);
+								list_shortest_paths(g, u, v, expected);
+							}
+							else
+							{
+								source.get_paths(g, u, v, paths, 4);
+								list_paths(g, u, v, expected, 4);
+							}
+
+							assert(vertices(paths) == vertices(expected));
+							sources = u + 1;
+						}
+
+						next_pair(u, v, n);
+					}
+
+					if (budget == 0)
+						assert(source.get_searches() <= sources);
+				}
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Meet-in-the-middle enumeration against plain DFS.
+	{
+		std::cout << "Meet-in-the-middle paths test ... ";
+
+		const graph graphs[] = { build_clique(7), build_wheel(8), build_biclique(3, 4), build_path(5), build_random_graph(10, 0.4) };
+
+		for (const auto& g : graphs)
+		{
+			const index_t n = g.num_vertices();
+
+			for (index_t s = 0; s < n; ++s)
+			{
+				for (index_t t = s + 1; t < n; ++t)
+				{
+					for (index_t length = 1; length <= 6; ++length)
+					{
+						std::vector<edge_path> paths;
+						std::vector<edge_path> expected;
+						list_paths_mitm(g, s, t, paths, length);
+						list_paths(g, s, t, expected, length);
+
+						std::vector<std::vector<index_t>> found;
+						for (const auto& p : paths)
+							found.emplace_back(p.cbegin(), p.cend());
+
+						std::vector<std::vector<index_t>> lists;
+						for (const auto& p : expected)
+							lists.emplace_back(p.cbegin(), p.cend());
+
+						std::sort(found.begin(), found.end());
+						std::sort(lists.begin(), lists.end());
+						assert(found == lists);
+					}
+				}
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// The lazy loop decides the same k as the solver given every pair.
+	{
+		std::cout << "Lazy solver test ... ";
+
+		const graph graphs[] = { build_cycle(9), build_wheel(8), build_corona(3), build_biclique(2, 5), build_random_graph(12, 0.3) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			for (bool strong : { false, true })
+			{
+				for (index_t k = 1; k <= 6; ++k)
+				{
+					std::vector<index_t> expected;
+					std::vector<index_t> colours;
+					lazy_statistics stats;
+
+					const solve_status status = solve_rainbow_lazy(g, k, colours, strong, 0, nullptr, &stats);
+					assert(status == solve_all_pairs(g, k, strong, expected));
+					assert(stats.pairs <= stats.total_pairs);
+
+					// Every pair is searched for once, so no more paths are found
+					// than all pairs have, and each round runs at most one DFS per
+					// vertex.
+					const rainbow_checker checker(g, k, strong);
+					index_t all_paths = 0;
+					for (index_t i = 0; i < checker.num_pairs(); ++i)
+						all_paths += checker.get_paths(i).num_paths();
+
+					assert(stats.paths <= all_paths);
+					assert(stats.searches <= stats.rounds * g.num_vertices());
+
+					// A source is asked once per pair.
+					single_source_path_source source;
+					lazy_statistics source_stats;
+					std::vector<index_t> source_colours;
+					assert(solve_rainbow_lazy(g, k, source_colours, strong, 0, &source, &source_stats) == status);
+					assert(source_stats.searches == source_stats.pairs && source_stats.paths == stats.paths);
+
+					if (status == solve_status::satisfiable)
+					{
+						assert(is_rainbow_colouring(g, colours, strong));
+						break;
+					}
+				}
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Forced facts hold in every solution, and the cliques with the pairs they
+	// leave over decide the same k as all pairs.
+	{
+		std::cout << "Forced distinctness test ... ";
+
+		// On a tree every pair has one path, so all edges differ.
+		const graph tree = build_path(6);
+		const forced_distinct path_facts(rainbow_checker(tree, 5));
+		assert(path_facts.num_facts() == nchoosek(5, 2));
+		assert(path_facts.get_cliques().size() == 1 && path_facts.get_cliques()[0].size() == 5);
+		assert(path_facts.num_satisfied() == nchoosek(6, 2) - 5);
+
+		const graph graphs[] = { build_cycle(8), build_corona(4), build_wheel(6), build_random_graph(12, 0.3) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			const edge_index index(g);
+			const auto distinct = get_bridge_ids(g);
+
+			for (bool strong : { false, true })
+			{
+				for (index_t k = 1; k <= 6; ++k)
+				{
+					const rainbow_checker checker(g, k, strong);
+					const forced_distinct facts(checker, distinct);
+
+					// Every fact lies in a clique.
+					std::vector<char> covered(index.size() * index.size(), 0);
+					for (const auto& clique : facts.get_cliques())
+					{
+						for (auto e : clique)
+						{
+							for (auto f : clique)
+							{
+								assert(e == f || facts.differ(e, f));
+								covered[e * index.size() + f] = 1;
+							}
+						}
+					}
+
+					for (index_t e = 0; e < index.size(); ++e)
+					{
+						for (index_t f = 0; f < index.size(); ++f)
+							assert(!facts.differ(e, f) || covered[e * index.size() + f]);
+					}
+
+					std::vector<std::pair<index_t, index_t>> open;
+					for (index_t i = 0; i < checker.num_pairs(); ++i)
+					{
+						if (!facts.is_satisfied(i))
+							open.emplace_back(checker.get_pair(i));
+					}
+
+					const rainbow_checker reduced_checker(g, k, open, strong);
+					const edge_path_index reduced_index(reduced_checker);
+					rainbow_solver reduced(reduced_checker, reduced_index, k);
+					for (const auto& clique : facts.get_cliques())
+						reduced.add_distinct(clique);
+
+					std::vector<index_t> colours;
+					std::vector<index_t> reduced_colours;
+					const solve_status status = solve_all_pairs(g, k, strong, colours);
+					assert(status == reduced.solve(reduced_colours));
+
+					if (status == solve_status::satisfiable)
+					{
+						assert(is_rainbow_colouring(g, reduced_colours, strong));
+
+						for (index_t e = 0; e < index.size(); ++e)
+						{
+							for (index_t f = 0; f < index.size(); ++f)
+								assert(!facts.differ(e, f) || colours[e] != colours[f]);
+						}
+
+						// The writer leaves out the satisfied pairs.
+						if (!strong)
+						{
+							std::ostringstream plain;
+							std::ostringstream forced;
+							model_writer plain_writer(g, k, plain);
+							model_writer forced_writer(g, k, forced);
+							forced_writer.set_forced_distinct(true);
+							plain_writer.write();
+							forced_writer.write();
+
+							assert(count_occurrences(forced.str(), "Forced distinct edges") == 1);
+							assert(count_occurrences(forced.str(), "satisfied by forced alldiffs") == facts.num_satisfied());
+							assert(count_occurrences(forced.str(), "\\/") <= count_occurrences(plain.str(), "\\/"));
+						}
+
+						break;
+					}
+				}
+			}
+		}
+
+		// Every edge writer writes the cliques, so leaving out the pairs they
+		// satisfy keeps the verdict (rc(C7) = src(C7) = 4).
+		const graph small[] = { build_cycle(7), build_corona(3), build_wheel(5) };
+
+		for (const auto& g : small)
+		{
+			for (bool strong : { false, true })
+			{
+				for (index_t k = 2; k <= 4; ++k)
+				{
+					std::vector<index_t> colours;
+					const bool expected = solve_rainbow_lazy(g, k, colours, strong) == solve_status::satisfiable;
+
+					std::ostringstream cnf;
+					std::unique_ptr<cnf_model_writer> cnf_writer(strong ? new strong_cnf_model_writer(g, k, cnf) : new cnf_model_writer(g, k, cnf));
+					cnf_writer->set_forced_distinct(true);
+					cnf_writer->write();
+					assert(is_satisfiable_cnf(cnf.str()) == expected);
+
+					const forced_distinct& facts = *cnf_writer->get_forced_distinct();
+					index_t facts_written = 0;
+					for (const auto& clique : facts.get_cliques())
+						facts_written += nchoosek(clique.size(), 2);
+
+					std::ostringstream fzn;
+					std::unique_ptr<flatzinc_model_writer> fzn_writer(strong ? new strong_flatzinc_model_writer(g, k, fzn) : new flatzinc_model_writer(g, k, fzn));
+					fzn_writer->set_forced_distinct(true);
+					fzn_writer->write();
+					assert(count_occurrences(fzn.str(), "constraint int_ne(") == facts_written);
+					assert(count_occurrences(fzn.str(), "constraint bool_clause(") + facts.num_satisfied() == rainbow_checker(g, k, strong).num_pairs());
+
+					std::ostringstream xml;
+					std::unique_ptr<xcsp_model_writer> xcsp_writer(strong ? new strong_xcsp_model_writer(g, k, xml) : new xcsp_model_writer(g, k, xml));
+					xcsp_writer->set_forced_distinct(true);
+					xcsp_writer->write();
+					assert(count_occurrences(xml.str(), "<allDifferent>") == static_cast<index_t>(facts.get_cliques().size()));
+				}
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// Kernel paths are the paths of the graph, and the pairs the kernel does
+	// not imply decide the same k as all pairs.
+	{
+		std::cout << "Graph kernel test ... ";
+
+		// A cycle with a pendant tree, a chord making two chains, and a
+		// pendant path.
+		graph g(14);
+		for (index_t v = 0; v < 8; ++v)
+			g.add_edge(v, (v + 1) % 8);
+		g.add_edge(0, 4);
+		g.add_edge(2, 8);
+		g.add_edge(8, 9);
+		g.add_edge(8, 10);
+		g.add_edge(10, 11);
+		g.add_edge(6, 12);
+		g.add_edge(12, 13);
+
+		const graph_kernel kernel(g);
+		assert(kernel.num_core_vertices() == 8 && kernel.num_kernel_vertices() == 2);
+		assert(kernel.get_chains().size() == 3);
+		assert(kernel.get_root(11) == 2 && kernel.get_depth(11) == 3);
+		assert(kernel.is_leaf(9) && kernel.is_leaf(11) && !kernel.is_leaf(8) && !kernel.is_leaf(2));
+		assert(kernel.is_implied(8, 5) && kernel.is_implied(9, 11) && !kernel.is_implied(9, 13));
+
+		// A tree is one pendant tree, whose pairs the bridges satisfy.
+		const graph_kernel star_kernel(build_star(5));
+		assert(star_kernel.num_core_vertices() == 1 && star_kernel.num_kernel_pairs() == 0);
+
+		// Chains leave every pair in: a cycle keeps all of its non-adjacent
+		// pairs, and a cycle with a pendant path loses only the pendant ones.
+		const graph cycle = build_cycle(7);
+		const graph_kernel cycle_kernel(cycle);
+		assert(cycle_kernel.num_kernel_vertices() == 1 && cycle_kernel.get_chains().size() == 1);
+		assert(cycle_kernel.num_kernel_pairs() == nchoosek(7, 2) - 7);
+
+		graph tailed(9);
+		for (index_t v = 0; v < 7; ++v)
+			tailed.add_edge(v, (v + 1) % 7);
+		tailed.add_edge(0, 7);
+		tailed.add_edge(7, 8);
+
+		// Pairs with the inner vertex 7 are implied, and so is 0-8.
+		const graph_kernel tailed_kernel(tailed);
+		assert(tailed_kernel.num_kernel_pairs() == nchoosek(9, 2) - 9 - 6 - 1);
+
+		const graph graphs[] = { build_corona(4), build_path(7), cycle, build_wheel(6), build_random_graph(14, 0.18) };
+
+		auto check = [](const graph& h)
+		{
+			if (!is_connected(h))
+				return;
+
+			kernel_path_source source;
+			const graph_kernel& h_kernel = source.get_kernel(h);
+			const index_t n = h.num_vertices();
+
+			for (index_t length : { 2, 4, 7, 64 })
+			{
+				for (index_t u = 0; u < n; ++u)
+				{
+					for (index_t v = u + 1; v < n; ++v)
+					{
+						std::vector<edge_path> expected;
+						std::vector<edge_path> found;
+						list_paths(h, u, v, expected, length);
+						source.get_paths(h, u, v, found, length);
+
+						std::vector<std::vector<index_t>> a;
+						std::vector<std::vector<index_t>> b;
+						for (const auto& p : expected)
+							a.emplace_back(p.cbegin(), p.cend());
+						for (const auto& p : found)
+							b.emplace_back(p.cbegin(), p.cend());
+
+						std::sort(a.begin(), a.end());
+						std::sort(b.begin(), b.end());
+						assert(a == b);
+
+						if (length == 2)
+						{
+							std::vector<edge_path> shortest;
+							std::vector<edge_path> kernel_shortest;
+							list_shortest_paths(h, u, v, shortest);
+							source.get_shortest_paths(h, u, v, kernel_shortest);
+							assert(shortest.size() == kernel_shortest.size());
+						}
+					}
+				}
+			}
+
+			for (bool strong : { false, true })
+			{
+				for (index_t k = 1; k <= 7; ++k)
+				{
+					const rainbow_checker checker(h, k, strong);
+
+					std::vector<std::pair<index_t, index_t>> pairs;
+					for (index_t i = 0; i < checker.num_pairs(); ++i)
+					{
+						if (!h_kernel.is_implied(checker.get_pair(i).first, checker.get_pair(i).second))
+							pairs.emplace_back(checker.get_pair(i));
+					}
+
+					const rainbow_checker kernel_checker(h, k, pairs, strong, &source);
+					const edge_path_index kernel_index(kernel_checker);
+					rainbow_solver kernel_solver(kernel_checker, kernel_index, k);
+					kernel_solver.add_distinct(get_bridge_ids(h));
+
+					std::vector<index_t> expected;
+					std::vector<index_t> colours;
+					const solve_status status = kernel_solver.solve(colours);
+					assert(status == solve_all_pairs(h, k, strong, expected));
+
+					if (status == solve_status::satisfiable)
+					{
+						assert(is_rainbow_colouring(h, colours, strong));
+						break;
+					}
+				}
+			}
+		};
+
+		check(g);
+		for (const auto& h : graphs)
+			check(h);
+
+		// The writer leaves out the implied pairs.
+		std::ostringstream os;
+		model_writer writer(g, 6, os);
+		writer.set_kernel(true);
+		writer.write();
+
+		index_t implied = 0;
+		for (std::size_t at = os.str().find("implied by the kernel"); at != std::string::npos; at = os.str().find("implied by the kernel", at + 1))
+			++implied;
+
+		index_t pairs = 0;
+		for (index_t u = 0; u < g.num_vertices(); ++u)
+		{
+			for (index_t v = u + 1; v < g.num_vertices(); ++v)
+				pairs += !is_adjacent(g, u, v);
+		}
+
+		assert(implied == pairs - kernel.num_kernel_pairs());
+
+		std::cout << "OK!\n";
+	}
+
+	// The FlatZinc and XCSP writers declare one variable per edge and write
+	// one constraint per vertex pair (and per path for FlatZinc), plus the
+	// bridges pairwise distinct.
+	{
+		std::cout << "FlatZinc and XCSP writer test ... ";
+
+		const graph graphs[] = { build_wheel(6), build_corona(3), build_biclique(2, 4) };
+		const index_t k = 4;
+
+		for (const auto& g : graphs)
+		{
+			const index_t m = g.num_edges();
+			const index_t bridges = get_bridge_ids(g).size();
+			const index_t bridge_pairs = (bridges >= 2) ? nchoosek(bridges, 2) : 0;
+
+			for (bool strong : { false, true })
+			{
+				// Paths, literals over edge pairs sharing a path, and disequalities
+				// in the XCSP expressions.
+				const rainbow_checker checker(g, k, strong);
+				index_t paths = 0;
+				index_t disequalities = 0;
+				std::vector<std::pair<index_t, index_t>> shared;
+				for (index_t i = 0; i < checker.num_pairs(); ++i)
+				{
+					const path_matrix& matrix = checker.get_paths(i);
+					assert(matrix.num_paths() > 0);
+					paths += matrix.num_paths();
+
+					for (index_t p = 0; p < matrix.num_paths(); ++p)
+					{
+						disequalities += nchoosek(matrix.length(p), 2);
+
+						for (index_t a = 0; a < matrix.length(p); ++a)
+						{
+							for (index_t b = a + 1; b < matrix.length(p); ++b)
+								shared.emplace_back(std::minmax(matrix.edge(p, a), matrix.edge(p, b)));
+						}
+					}
+				}
+				std::sort(shared.begin(), shared.end());
+				shared.erase(std::unique(shared.begin(), shared.end()), shared.end());
+
+				std::ostringstream fzn;
+				if (strong)
+					strong_flatzinc_model_writer(g, k, fzn).write();
+				else
+					flatzinc_model_writer(g, k, fzn).write();
+
+				const std::string fzn_text = fzn.str();
+				assert(count_occurrences(fzn_text, "var 1..4: x") == m);
+				assert(count_occurrences(fzn_text, ":: output_var;") == m);
+				assert(count_occurrences(fzn_text, "var bool: p") == paths);
+				assert(count_occurrences(fzn_text, "constraint array_bool_and(") == paths);
+				assert(count_occurrences(fzn_text, "constraint bool_clause(") == checker.num_pairs());
+				assert(count_occurrences(fzn_text, "var bool: d") == static_cast<index_t>(shared.size()));
+				assert(count_occurrences(fzn_text, "constraint int_ne_reif(") == static_cast<index_t>(shared.size()));
+				assert(count_occurrences(fzn_text, "constraint int_ne(") == bridge_pairs);
+				assert(count_occurrences(fzn_text, "solve satisfy;") == 1);
+				assert(fzn_text.rfind("var ") < fzn_text.find("constraint "));
+
+				std::ostringstream xml;
+				if (strong)
+					strong_xcsp_model_writer(g, k, xml).write();
+				else
+					xcsp_model_writer(g, k, xml).write();
+
+				const std::string xml_text = xml.str();
+				assert(count_occurrences(xml_text, "<var id=\"x") == m);
+				assert(count_occurrences(xml_text, "<intension>") == checker.num_pairs());
+				assert(count_occurrences(xml_text, "ne(") == disequalities);
+				assert(count_occurrences(xml_text, "<allDifferent>") == (bridges >= 2 ? 1 : 0));
+				assert(count_occurrences(xml_text, "<instance") == 1 && count_occurrences(xml_text, "</instance>") == 1);
+				assert(xml_text.find("</variables>") < xml_text.find("<constraints>"));
+			}
+		}
+
+		// Pairs without a path get a constant false constraint, even when the
+		// graph has no edge to write it over.
+		for (bool strong : { false, true })
+		{
+			const graph g(3);
+			std::ostringstream xml;
+			if (strong)
+				strong_xcsp_model_writer(g, k, xml).write();
+			else
+				xcsp_model_writer(g, k, xml).write();
+
+			const std::string xml_text = xml.str();
+			assert(count_occurrences(xml_text, "<var id=") == 0);
+			assert(count_occurrences(xml_text, "<intension> eq(0,1) </intension>") == 3);
+		}
+
+		// A small budget moves the clauses and constraints held back for the
+		// header to a file without changing the model.
+		for (bool cnf : { false, true })
+		{
+			const graph g = build_wheel(6);
+			std::string budgeted;
+
+			for (std::size_t budget : { 1 << 20, 256 })
+			{
+				std::ostringstream os;
+				std::unique_ptr<model_writer> writer;
+				if (cnf)
+					writer.reset(new cnf_model_writer(g, k, os));
+				else
+					writer.reset(new flatzinc_model_writer(g, k, os));
+
+				writer->set_memory_budget(budget);
+				writer->write();
+
+				if (budget == 1 << 20)
+					budgeted = os.str();
+				else
+					assert(os.str() == budgeted && budgeted.size() > 4 * budget);
+			}
+		}
+
+		std::cout << "OK!\n";
+	}
+
+	// The disequality encoding declares one literal per edge pair on a path and
+	// writes every pair as a disjunction of literal conjunctions.
+	{
+		std::cout << "Disequality encoding test ... ";
+
+		const graph g = build_wheel(6);
+		const index_t k = 3;
+
+		// The edge pairs that share a path, and the number of pairs.
+		const rainbow_checker checker(g, k);
+		std::vector<std::pair<index_t, index_t>> shared;
+		for (index_t i = 0; i < checker.num_pairs(); ++i)
+		{
+			const path_matrix& paths = checker.get_paths(i);
+			for (index_t p = 0; p < paths.num_paths(); ++p)
+			{
+				for (index_t a = 0; a < paths.length(p); ++a)
+				{
+					for (index_t b = a + 1; b < paths.length(p); ++b)
+						shared.emplace_back(std::minmax(paths.edge(p, a), paths.edge(p, b)));
+				}
+			}
+		}
+		std::sort(shared.begin(), shared.end());
+		shared.erase(std::unique(shared.begin(), shared.end()), shared.end());
+
+		std::ostringstream mzn;
+		model_writer mzn_writer(g, k, mzn);
+		mzn_writer.set_path_encoding(path_encoding::disequality);
+		mzn_writer.write();
+
+		assert(count_occurrences(mzn.str(), "var bool: d") == static_cast<index_t>(shared.size()));
+		assert(count_occurrences(mzn.str(), "Vertex pair") == checker.num_pairs());
+		assert(count_occurrences(mzn.str(), "alldifferent([x") == 0);
+
+		// Minion gets the same literals, declared before any constraint, and
+		// prints only the edges. A small budget moves the held constraints to
+		// a file without changing the model.
+		std::string budgeted;
+		for (std::size_t budget : { 0, 1 << 20, 256 })
+		{
+			std::ostringstream minion;
+			minion_model_writer minion_writer(g, k, minion);
+			minion_writer.set_path_encoding(path_encoding::disequality);
+			minion_writer.set_memory_budget(budget);
+			minion_writer.write();
+
+			const std::string text = minion.str();
+			assert(count_occurrences(text, "BOOL d") == count_occurrences(text, "reifyimply(diseq(") && count_occurrences(text, "BOOL d") > 0);
+			assert(count_occurrences(text, "**CONSTRAINTS**") == 1);
+			assert(text.rfind("BOOL d") < text.find("**CONSTRAINTS**"));
+			assert(text.find("watched-or") > text.find("**CONSTRAINTS**"));
+			assert(count_occurrences(text, "watched-or") == checker.num_pairs());
+			assert(count_occurrences(text, "PRINT [[x") == 1 && count_occurrences(text, "PRINT [[") == 1);
+			assert(count_occurrences(text.substr(text.find("PRINT")), "_") == g.num_edges());
+
+			if (budget == 1 << 20)
+				budgeted = text;
+			else if (budget != 0)
+				assert(text == budgeted && text.size() > 4 * budget);
+		}
+
+		// Repeated writes start from fresh literals.
+		std::ostringstream strong_once;
+		std::ostringstream strong_twice;
+		strong_model_writer strong_writer(g, k, strong_once);
+		strong_writer.set_path_encoding(path_encoding::disequality);
+		strong_writer.write();
+		strong_model_writer strong_again(g, k, strong_twice);
+		strong_again.set_path_encoding(path_encoding::disequality);
+		strong_again.write();
+		strong_again.write();
+		assert(strong_twice.str() == strong_once.str() + strong_once.str());
+
+		std::cout << "OK!\n";
+	}
+
+	// The zdd encoding writes every pair as the nodes of its path ZDD, one
+	// constraint per node, and one alldiff over the edges taken.
+	{
+		std::cout << "ZDD encoding test ... ";
+
+		const graph g = build_wheel(6);
+		const index_t k = 3;
+
+		for (bool strong : { false, true })
+		{
+			const zdd_checker checker(g, k, strong);
+			index_t nodes = 0;
+			for (index_t i = 0; i < checker.num_pairs(); ++i)
+				nodes += checker.get_zdd(i).size();
+
+			std::ostringstream mzn;
+			std::unique_ptr<model_writer> writer;
+			if (strong)
+				writer.reset(new strong_model_writer(g, k, mzn));
+			else
+				writer.reset(new model_writer(g, k, mzn));
+			writer->set_path_encoding(path_encoding::zdd);
+			writer->write();
+
+			const std::string text = mzn.str();
+			assert(count_occurrences(text, "include \"alldifferent_except_0.mzn\";") == 1);
+			assert(count_occurrences(text, "of var bool: z") == checker.num_pairs());
+			assert(count_occurrences(text, "of var bool: h") == checker.num_pairs());
+			assert(count_occurrences(text, "constraint (h") == nodes);
+			assert(count_occurrences(text, "alldifferent_except_0([bool2int(") == checker.num_pairs());
+			assert(count_occurrences(text, "alldifferent([x") == 0);
+		}
+
+		// Pairs without a path are false.
+		const graph path = build_path(4);
+		std::ostringstream mzn;
+		model_writer path_writer(path, 2, mzn);
+		path_writer.set_path_encoding(path_encoding::zdd);
+		path_writer.write();
+		assert(count_occurrences(mzn.str(), "constraint false;") == 1);
+
+		std::ostringstream minion;
+		minion_model_writer minion_writer(g, k, minion);
+		minion_writer.set_path_encoding(path_encoding::zdd);
+		bool thrown = false;
+		try
+		{
+			minion_writer.write();
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+		assert(thrown);
+
+		std::cout << "OK!\n";
+	}
+
+	// Renaming the colours of any solution by first use along the value order
+	// meets the pins and the precedence, so breaking value symmetry keeps a
+	// representative of every solution.
+	{
+		std::cout << "Value symmetry test ... ";
+
+		const graph graphs[] = { build_corona(3), build_wheel(7), build_biclique(2, 4), build_random_graph(10, 0.35) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			for (bool strong : { false, true })
+			{
+				std::vector<index_t> colours;
+				index_t k = 1;
+
+				while (solve_rainbow_lazy(g, k, colours, strong) != solve_status::satisfiable)
+					++k;
+
+				std::ostringstream os;
+				std::unique_ptr<model_writer> writer;
+				if (strong)
+					writer.reset(new strong_model_writer(g, k, os));
+				else
+					writer.reset(new model_writer(g, k, os));
+				writer->set_value_symmetry(value_symmetry::pin);
+
+				index_t pinned = 0;
+				const auto order = writer->get_value_order(pinned);
+
+				std::vector<index_t> sorted(order);
+				std::sort(sorted.begin(), sorted.end());
+				for (index_t e = 0; e < g.num_edges(); ++e)
+					assert(sorted[e] == e);
+
+				std::vector<index_t> renamed(k + 1, 0);
+				index_t used = 0;
+				for (auto e : order)
+				{
+					if (renamed[colours[e]] == 0)
+						renamed[colours[e]] = ++used;
+				}
+
+				std::vector<index_t> representative(colours.size());
+				for (index_t e = 0; e < g.num_edges(); ++e)
+					representative[e] = renamed[colours[e]];
+
+				assert(is_rainbow_colouring(g, representative, strong));
+
+				index_t most = 0;
+				for (std::size_t i = 0; i < order.size(); ++i)
+				{
+					const index_t c = representative[order[i]];
+					assert(i >= static_cast<std::size_t>(pinned) || c == static_cast<index_t>(i) + 1);
+					assert(c <= most + 1);
+					most = std::max(most, c);
+				}
+
+				writer->write();
+				assert(count_occurrences(os.str(), "value_precede_chain([c | c in 1..k]") == 1);
+				assert(count_occurrences(os.str(), " = ") == pinned);
+			}
+		}
+
+		// Pinning gives way to the lex-leader constraints.
+		const graph g = build_corona(3);
+		std::ostringstream lex;
+		model_writer lex_writer(g, 4, lex);
+		lex_writer.set_value_symmetry(value_symmetry::pin);
+		lex_writer.set_edge_symmetries(canonical_label(g).generators);
+		index_t pinned = -1;
+		lex_writer.get_value_order(pinned);
+		assert(pinned == 0);
+
+		// Edges past vertex 31 are declared too, so the names in the chain
+		// refer to variables.
+		{
+			const graph path = build_path(40);
+			std::ostringstream mzn;
+			model_writer path_writer(path, 39, mzn);
+			path_writer.set_value_symmetry(value_symmetry::precedence);
+			path_writer.write();
+			assert(count_occurrences(mzn.str(), "var 1..k: x") == path.num_edges());
+			assert(count_occurrences(mzn.str(), "var 1..k: x35_36;") == 1);
+			assert(count_occurrences(mzn.str(), "x35_36") > 1);
+		}
+
+		// Minion and CNF declare what they use.
+		std::ostringstream minion;
+		minion_model_writer minion_writer(g, 4, minion);
+		minion_writer.set_value_symmetry(value_symmetry::precedence);
+		minion_writer.write();
+		assert(count_occurrences(minion.str(), "DISCRETE m") == g.num_edges() - 2);
+		assert(count_occurrences(minion.str(), "ineq(") == g.num_edges() - 1);
+
+		// Only the edges are printed, in declaration order, so a solution
+		// reads back as the colouring it was made from.
+		{
+			const edge_index index(g);
+			std::istringstream model(minion.str());
+			std::string line;
+			std::vector<std::string> declared;
+			std::string print;
+			while (std::getline(model, line))
+			{
+				if (line.compare(0, 10, "DISCRETE x") == 0)
+					declared.emplace_back(line.substr(9, line.find(' ', 9) - 9));
+				else if (line.compare(0, 8, "PRINT [[") == 0)
+					print = line.substr(8, line.size() - 10);
+			}
+
+			std::string names;
+			for (const auto& name : declared)
+				names += (names.empty() ? "" : ",") + name;
+			assert(print == names);
+
+			std::ostringstream output;
+			std::vector<index_t> colouring(index.size());
+			output << "Sol:";
+			for (const auto& name : declared)
+			{
+				const index_t u = std::stoll(name.substr(1));
+				const index_t v = std::stoll(name.substr(name.find('_') + 1));
+				const index_t e = index.id(u, v);
+				colouring[e] = e % 4 + 1;
+				output << " " << colouring[e];
+			}
+			output << "\nSolution Number: 1\n";
+
+			std::istringstream solutions(output.str());
+			const auto read = read_minion_solutions(g, solutions);
+			assert(read.size() == 1 && read[0] == colouring);
+		}
+
+		std::ostringstream cnf;
+		cnf_model_writer cnf_writer(g, 4, cnf);
+		cnf_writer.set_value_symmetry(value_symmetry::pin);
+		cnf_writer.write();
+
+		std::istringstream lines(cnf.str());
+		std::string line;
+		index_t variables = 0;
+		index_t clauses = -1;
+		index_t largest = 0;
+		index_t seen = 0;
+		while (std::getline(lines, line))
+		{
+			std::istringstream fields(line);
+			if (line.compare(0, 5, "p cnf") == 0)
+			{
+				std::string p, format;
+				fields >> p >> format >> variables >> clauses;
+				continue;
+			}
+			if (clauses == -1)
+				continue;
+			for (index_t lit; fields >> lit && lit != 0; )
+				largest = std::max(largest, std::abs(lit));
+			++seen;
+		}
+		assert(seen == clauses && largest == variables);
+
+		std::cout << "OK!\n";
+	}
+
+	// The search order puts the bridges first and leaves the solver's answers
+	// alone; the writers hand it to the solver.
+	{
+		std::cout << "Search order test ... ";
+
+		// On a tree every pair has one path, through every edge between.
+		const graph tree = build_path(5);
+		const rainbow_checker tree_checker(tree, 4);
+		const element_statistics tree_stats = get_element_statistics(tree_checker);
+		const index_t expected[] = { 3, 5, 5, 3 };
+		for (index_t e = 0; e < 4; ++e)
+		{
+			assert(tree_stats.pairs[e] == expected[e]);
+			assert(tree_stats.single_path_pairs[e] == tree_stats.pairs[e]);
+		}
+
+		const graph graphs[] = { build_corona(4), build_wheel(7), build_biclique(3, 4), build_random_graph(11, 0.35) };
+
+		for (const auto& g : graphs)
+		{
+			if (!is_connected(g))
+				continue;
+
+			const auto distinct = get_bridge_ids(g);
+
+			for (bool strong : { false, true })
+			{
+				for (index_t k = 1; k <= 6; ++k)
+				{
+					const rainbow_checker checker(g, k, strong);
+					const auto order = get_search_order(checker, distinct);
+
+					std::vector<index_t> sorted(order);
+					std::sort(sorted.begin(), sorted.end());
+					for (index_t e = 0; e < checker.num_elements(); ++e)
+						assert(sorted[e] == e);
+
+					for (std::size_t i = 0; i < distinct.size(); ++i)
+						assert(std::find(distinct.begin(), distinct.end(), order[i]) != distinct.end());
+
+					const edge_path_index paths(checker);
+					rainbow_solver ordered(checker, paths, k);
+					ordered.add_distinct(distinct);
+					ordered.set_search_order(order);
+
+					std::vector<index_t> colours;
+					std::vector<index_t> expected;
+					const solve_status status = ordered.solve(colours);
+					assert(status == solve_all_pairs(g, k, strong, expected));
+
+					if (status == solve_status::satisfiable)
+					{
+						assert(is_rainbow_colouring(g, colours, strong));
+						break;
+					}
+				}
+			}
+		}
+
+		const graph g = build_corona(3);
+		const index_t m = g.num_edges();
+
+		std::ostringstream mzn;
+		model_writer mzn_writer(g, 4, mzn);
+		mzn_writer.set_search_order(true);
+		mzn_writer.write();
+		const std::string mzn_text = mzn.str();
+		assert(mzn_text.find("solve :: int_search([") != std::string::npos);
+		assert(mzn_text.find("], input_order, indomain_min) satisfy;") != std::string::npos);
+
+		std::ostringstream minion;
+		minion_model_writer minion_writer(g, 4, minion);
+		minion_writer.set_search_order(true);
+		minion_writer.set_path_encoding(path_encoding::disequality);
+		minion_writer.write();
+		const std::string minion_text = minion.str();
+		const std::size_t varorder = minion_text.find("VARORDER [");
+		assert(minion_text.find("**SEARCH**") < varorder && varorder < minion_text.find("**EOF**"));
+
+		// Every edge and every literal, once.
+		const std::string list = minion_text.substr(varorder + 10, minion_text.find("]", varorder) - varorder - 10);
+		std::istringstream names(list);
+		std::vector<std::string> listed;
+		for (std::string name; std::getline(names, name, ','); )
+			listed.emplace_back(name);
+
+		index_t literals = 0;
+		for (std::size_t at = minion_text.find("BOOL d"); at != std::string::npos; at = minion_text.find("BOOL d", at + 1))
+			++literals;
+
+		assert(static_cast<index_t>(listed.size()) == m + literals && literals > 0);
+		std::sort(listed.begin(), listed.end());
+		assert(std::unique(listed.begin(), listed.end()) == listed.end());
+
+		std::cout << "OK!\n";
+	}
+
+	// Models stream into a child process and its answers are parsed as they
+	// come; mock solvers written as shell scripts stand in for the real ones.
+#if !defined(_MSC_VER)
+	{
+		std::cout << "Solver runner test ... ";
+
+		const std::string script = get_temp_path("mock_solver.sh");
+		auto mock = [&script](const std::string& body)
+		{
+			std::ofstream(script) << body;
+			return std::vector<std::string>{ "sh", script };
+		};
+
+		// Minion: reports the number of model lines it read as its solutions.
+		const graph g = build_wheel(6);
+		std::ostringstream expected;
+		minion_model_writer(g, 3, expected).write();
+		const std::string text = expected.str();
+		const index_t lines = std::count(text.begin(), text.end(), '\n');
+
+		{
+			solver_runner runner(mock("n=$(wc -l)\necho 'Sol: 1 2 3'\necho 'Solution Number: 1'\n"
+				"echo 'Problem solvable?: yes'\necho \"Solutions Found: $n\"\n"), solver_dialect::minion);
+			minion_model_writer writer(g, 3, runner.get_input_stream());
+			writer.write();
+
+			const solver_result& result = runner.finish();
+			assert(result.status == solve_status::satisfiable && result.exit_code == 0);
+			assert(result.solutions == lines);
+			assert((result.values == std::vector<index_t>{ 1, 2, 3 }));
+		}
+
+		// MiniZinc: the last solution counts, and the status lines are read.
+		{
+			solver_runner runner(mock("cat > /dev/null\nprintf 'x0_1 = 2;\\nx0_2 = 1;\\n----------\\n"
+				"x0_1 = 1;\\nx0_2 = 3;\\n----------\\n==========\\n'\n"), solver_dialect::minizinc);
+			model_writer(g, 3, runner.get_input_stream()).write();
+
+			const solver_result& result = runner.finish();
+			assert(result.status == solve_status::satisfiable && result.solutions == 2);
+			assert(result.assignment.size() == 2 && result.assignment.at("x0_1") == 1 && result.assignment.at("x0_2") == 3);
+		}
+
+		{
+			solver_runner runner(mock("cat > /dev/null\necho =====UNSATISFIABLE=====\nexit 3\n"), solver_dialect::minizinc);
+			const solver_result& result = runner.finish();
+			assert(result.status == solve_status::unsatisfiable && result.exit_code == 3);
+		}
+
+		// A solver that answers without reading the model does not stop the
+		// writer.
+		{
+			// About 180 KB, more than a pipe holds.
+			const graph biclique = build_biclique(4, 5);
+			solver_runner runner(mock("echo 'Problem solvable?: no'\n"), solver_dialect::minion);
+			minion_model_writer writer(biclique, 3, runner.get_input_stream());
+			writer.write();
+
+			const solver_result& result = runner.finish();
+			assert(result.status == solve_status::unsatisfiable && result.exit_code == 0);
+		}
+
+		{
+			solver_runner runner({ "no-such-solver-binary" }, solver_dialect::minion);
+			runner.get_input_stream() << "MINION 3\n";
+			assert(runner.finish().exit_code == 127 && runner.finish().status == solve_status::unknown);
+		}
+
+		// Every point gets the model with its own domains.
+		const auto points = polynomial_points<minion_model_writer>(build_cycle(5),
+			mock("awk '/^DISCRETE/ { split($3, d, \".\"); k = d[3] + 0 } END { print \"Solutions Found: \" k }'\n"));
+		assert(points.size() == 5);
+		for (index_t i = 0; i < 5; ++i)
+			assert(points[i] == i + 1);
+
+		// As on Windows: the model is read from a file named last.
+		const auto from_file = polynomial_points<minion_model_writer>(build_cycle(5),
+			mock("awk '/^DISCRETE/ { split($3, d, \".\"); k = d[3] + 0 } END { print \"Solutions Found: \" k }' \"$1\"\n"),
+			model_input::file);
+		assert(from_file == points);
+
+		std::string model_path;
+		{
+			temp_model_file file;
+			model_path = file.get_path();
+			file.get_stream() << "MINION 3\n";
+
+			const auto command = file.get_command({ "minion" });
+			assert(command.size() == 2 && command[1] == model_path && std::filesystem::file_size(model_path) == 9);
+		}
+		assert(!std::filesystem::exists(model_path));
+
+		std::remove(script.c_str());
+
+		std::cout << "OK!\n";
+	}
+#endif
+}
@@ -0,0 +1,174 @@
+// total_model_writer.cpp
+#include "total_model_writer.hpp"
+#include "rainbow_kernel.hpp"
+#include "block_cut_tree.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+namespace
+{
+	const std::string VAR_PREFIX = "x";
+	const std::string VAR_TYPE = "var 1..k: ";
+
+	void add_element_name(const edge_index& index, index_t x, std::ostream& os)
+	{
+		if (x < index.size())
+		{
+			const auto ends = index.endpoints(x);
+			os << VAR_PREFIX << ends.first << "_" << ends.second;
+		}
+		else
+		{
+			os << VAR_PREFIX << x - index.size();
+		}
+	}
+}
+
+std::vector<index_t> get_total_distinct_elements(const graph& g)
+{
+	const edge_index index(g);
+	std::vector<index_t> elements = get_bridge_ids(g);
+
+	for (std::uint64_t x = get_block_cut_tree(g).cut_vertices; x != 0; x &= x - 1)
+		elements.emplace_back(index.size() + ctz64(x));
+
+	return elements;
+}
+
+void total_model_writer::add_element_alldiff(const std::vector<index_t>& elements)
+{
+	auto& os = get_output_stream();
+
+	os << "alldifferent([";
+
+	for (std::size_t j = 0; j < elements.size(); ++j)
+	{
+		if (j != 0)
+			os << ",";
+
+		add_element_name(index_, elements[j], os);
+
+		if (hybrid_ && elements[j] >= index_.size())
+			os << " + k";
+	}
+
+	os << "]) ";
+}
+
+void total_model_writer::impl_preprocess()
+{
+	auto& os = get_output_stream();
+	prepare_model(get_solution_size(), os);
+
+	const index_t elements = index_.size() + get_graph().num_vertices();
+
+	for (index_t x = 0; x < elements; ++x)
+	{
+		os << VAR_TYPE;
+		add_element_name(index_, x, os);
+		os << ";\n";
+	}
+}
+
+void total_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	auto& os = get_output_stream();
+
+	std::vector<edge_path> paths;
+	list_pair_paths(u, v, paths, hybrid_ ? get_solution_size() : (get_solution_size() + 1) / 2);
+
+	os << get_comment() << " Vertex pair " << u << " " << v << "\n";
+
+	// No path is short enough for its edges and internal vertices to fit in
+	// the colours.
+	if (paths.empty())
+	{
+		os << "constraint false;\n";
+		return;
+	}
+
+	os << "constraint ( ";
+
+	for (std::size_t j = 0; j < paths.size(); ++j)
+	{
+		add_element_alldiff(to_total_ids(index_, paths[j]));
+
+		if (j != paths.size() - 1)
+			os << "\\/ ";
+	}
+
+	os << ");\n";
+}
+
+forced_distinct total_model_writer::impl_find_forced_distinct() const
+{
+	const graph& g = get_graph();
+	const rainbow_checker checker = hybrid_ ? make_hybrid_checker(g, get_solution_size(), get_path_source()) : make_total_checker(g, get_solution_size(), get_path_source());
+	return forced_distinct(checker, get_total_distinct_elements(g));
+}
+
+std::vector<index_t> total_model_writer::impl_find_pinned() const
+{
+	std::vector<index_t> clique;
+
+	if (get_forced_distinct() != nullptr)
+	{
+		if (!get_forced_distinct()->get_cliques().empty())
+			clique = get_forced_distinct()->get_cliques().front();
+	}
+	else
+	{
+		const forced_distinct facts = impl_find_forced_distinct();
+
+		if (!facts.get_cliques().empty())
+			clique = facts.get_cliques().front();
+	}
+
+	// An edge and a vertex of the clique may share a raw colour in the hybrid
+	// model, so only the edges can be pinned to 1, 2, ...
+	if (hybrid_)
+		clique.erase(std::remove_if(clique.begin(), clique.end(), [this](index_t x) { return x >= index_.size(); }), clique.end());
+
+	return clique;
+}
+
+void total_model_writer::impl_postprocess()
+{
+	auto& os = get_output_stream();
+	const auto distinct = get_total_distinct_elements(get_graph());
+
+	if (get_forced_distinct() != nullptr)
+	{
+		// The bridges and cut vertices are among the forced elements.
+		os << get_comment() << " Forced distinct elements\n";
+
+		for (const auto& clique : get_forced_distinct()->get_cliques())
+		{
+			os << "constraint ( ";
+			add_element_alldiff(clique);
+			os << ");\n";
+		}
+	}
+	else if (distinct.size() >= 2)
+	{
+		os << get_comment() << " Bridges and cut vertices\n";
+		os << "constraint ( ";
+		add_element_alldiff(distinct);
+		os << ");\n";
+	}
+
+	std::vector<std::string> names;
+
+	for (index_t x = 0; x < impl_num_elements(); ++x)
+	{
+		std::ostringstream name;
+		add_element_name(index_, x, name);
+		names.emplace_back(name.str());
+	}
+
+	add_value_symmetry(names);
+
+	os << "solve satisfy;\n";
+}
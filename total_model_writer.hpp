@@ -0,0 +1,72 @@
+// total_model_writer.hpp
+#ifndef TOTAL_MODEL_WRITER_HPP
+#define TOTAL_MODEL_WRITER_HPP
+
+#include "model_writer.hpp"
+#include "edge_index.hpp"
+#include <string>
+#include <vector>
+
+// Writes a MiniZinc model of total rainbow connection: edges and vertices
+// share the colours 1..k, and every non-adjacent pair needs a path whose edges
+// and internal vertices all have distinct colours. Such a path has at most
+// (k + 1) / 2 edges. Variables are x<u>_<v> for edges and x<v> for vertices;
+// the constraints are written over the element ids of rainbow_checker
+// (make_total_checker), edge ids first and then m + v for vertex v.
+class total_model_writer : public model_writer
+{
+public:
+	total_model_writer(const graph& g, index_t k, std::ostream& os, const std::string& comment = "%")
+		: total_model_writer(g, k, os, comment, false)
+	{
+
+	}
+
+protected:
+	// With hybrid set, the model of hybrid_model_writer.
+	total_model_writer(const graph& g, index_t k, std::ostream& os, const std::string& comment, bool hybrid)
+		: model_writer(g, k, os, comment), index_(g), hybrid_(hybrid)
+	{
+
+	}
+
+private:
+	virtual void impl_preprocess();
+	virtual void impl_postprocess();
+
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual forced_distinct impl_find_forced_distinct() const;
+
+	virtual index_t impl_num_elements() const { return index_.size() + get_graph().num_vertices(); }
+
+	virtual std::vector<index_t> impl_find_pinned() const;
+
+	void add_element_alldiff(const std::vector<index_t>& elements);
+
+	edge_index index_;
+	bool hybrid_;
+};
+
+// Writes a MiniZinc model of rainbow vertex-edge connection: edges and
+// vertices take colours 1..k from separate palettes, and every non-adjacent
+// pair needs a path with rainbow edges and rainbow internal vertices, so of
+// at most k edges. The variables are those of total_model_writer; in the
+// alldiffs a vertex appears as x<v> + k, which keeps the palettes apart.
+// Value symmetry renames both palettes at once and pins edges only.
+class hybrid_model_writer : public total_model_writer
+{
+public:
+	hybrid_model_writer(const graph& g, index_t k, std::ostream& os, const std::string& comment = "%")
+		: total_model_writer(g, k, os, comment, true)
+	{
+
+	}
+};
+
+// Element ids that must get pairwise distinct colours in a total rainbow
+// colouring: the bridges and the cut vertices. For any two of them some pair
+// has all of its paths through both, the cut vertices as internal vertices.
+std::vector<index_t> get_total_distinct_elements(const graph& g);
+
+#endif
@@ -0,0 +1,518 @@
+// verifier.cpp
+#include "verifier.hpp"
+
+#include "edge_index.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// The colour-set DP keeps 2^q words per source; beyond this many distinct
+	// colours the search falls back to a DFS over rainbow paths.
+	const index_t MAX_LAYERED_COLOURS = 20;
+
+	void check_complete(const std::vector<index_t>& colours)
+	{
+		if (std::find(colours.cbegin(), colours.cend(), 0) != colours.cend())
+			throw std::runtime_error("solution does not colour every edge");
+	}
+
+	// Parses "<u>_<v>" at pos; false if the text there is not of that form.
+	bool parse_edge_name(const std::string& line, std::size_t& pos, index_t& u, index_t& v)
+	{
+		std::size_t end = pos;
+		while (end < line.size() && std::isdigit(static_cast<unsigned char>(line[end])))
+			++end;
+
+		if (end == pos || end >= line.size() || line[end] != '_')
+			return false;
+
+		u = std::stoll(line.substr(pos, end - pos));
+		pos = ++end;
+
+		while (end < line.size() && std::isdigit(static_cast<unsigned char>(line[end])))
+			++end;
+
+		if (end == pos)
+			return false;
+
+		v = std::stoll(line.substr(pos, end - pos));
+		pos = end;
+		return true;
+	}
+
+	// Colours mapped to 0..q-1, per edge id.
+	index_t compact_colours(const std::vector<index_t>& colours, std::vector<index_t>& compact)
+	{
+		std::map<index_t, index_t> ids;
+
+		compact.resize(colours.size());
+		for (std::size_t e = 0; e < colours.size(); ++e)
+		{
+			auto it = ids.emplace(colours[e], ids.size()).first;
+			compact[e] = it->second;
+		}
+
+		return ids.size();
+	}
+
+	// by_colour[c * n + v] is the set of neighbours of v over edges of colour c.
+	// For geodesics only edges leading one step away from the source are kept.
+	std::vector<std::uint64_t> colour_adjacency(const graph& g, const edge_index& index, const std::vector<index_t>& colours, index_t q, const std::vector<index_t>* dist)
+	{
+		const index_t n = g.num_vertices();
+		std::vector<std::uint64_t> by_colour(q * n, 0);
+
+		for (index_t e = 0; e < index.size(); ++e)
+		{
+			const auto ends = index.endpoints(e);
+			const index_t a = ends.first;
+			const index_t b = ends.second;
+
+			if (dist == nullptr || (*dist)[b] == (*dist)[a] + 1)
+				by_colour[colours[e] * n + a] |= (1ULL << b);
+
+			if (dist == nullptr || (*dist)[a] == (*dist)[b] + 1)
+				by_colour[colours[e] * n + b] |= (1ULL << a);
+		}
+
+		return by_colour;
+	}
+
+	// Vertices reachable from s over a walk with distinct colours. Such a walk
+	// contains a rainbow path with the same ends, so these are exactly the
+	// vertices joined to s by a rainbow path. Stops once targets are covered.
+	std::uint64_t layered_reach(const std::vector<std::uint64_t>& by_colour, index_t n, index_t q, index_t s, std::uint64_t targets)
+	{
+		std::vector<std::uint64_t> reach(1ULL << q, 0);
+		reach[0] = (1ULL << s);
+
+		std::uint64_t all = 0;
+
+		// Supersets come after their subsets in numeric order.
+		for (std::uint64_t set = 0; set < reach.size(); ++set)
+		{
+			const std::uint64_t from = reach[set];
+
+			if (from == 0)
+				continue;
+
+			all |= from;
+
+			if ((all & targets) == targets)
+				break;
+
+			for (index_t c = 0; c < q; ++c)
+			{
+				if (set & (1ULL << c))
+					continue;
+
+				std::uint64_t to = 0;
+				for (std::uint64_t x = from; x != 0; x &= x - 1)
+					to |= by_colour[c * n + ctz64(x)];
+
+				reach[set | (1ULL << c)] |= to;
+			}
+		}
+
+		return all;
+	}
+
+	void rainbow_dfs(const std::vector<std::uint64_t>& by_colour, index_t n, index_t q, index_t v, std::uint64_t visited, std::vector<bool>& used, std::uint64_t targets, std::uint64_t& found)
+	{
+		found |= (1ULL << v);
+
+		for (index_t c = 0; c < q && (found & targets) != targets; ++c)
+		{
+			if (used[c])
+				continue;
+
+			used[c] = true;
+
+			for (std::uint64_t x = by_colour[c * n + v] & ~visited; x != 0; x &= x - 1)
+			{
+				const index_t w = ctz64(x);
+				rainbow_dfs(by_colour, n, q, w, visited | (1ULL << w), used, targets, found);
+			}
+
+			used[c] = false;
+		}
+	}
+
+	std::uint64_t rainbow_reach(const graph& g, const edge_index& index, const std::vector<index_t>& colours, index_t q, index_t s, std::uint64_t targets, bool strong)
+	{
+		const index_t n = g.num_vertices();
+		std::vector<index_t> dist(n, 0);
+
+		if (strong)
+			bfs(g, dist, s);
+
+		const auto by_colour = colour_adjacency(g, index, colours, q, strong ? &dist : nullptr);
+
+		if (q <= MAX_LAYERED_COLOURS)
+			return layered_reach(by_colour, n, q, s, targets);
+
+		std::uint64_t found = 0;
+		std::vector<bool> used(q, false);
+		rainbow_dfs(by_colour, n, q, s, (1ULL << s), used, targets, found);
+		return found;
+	}
+
+	// Total rainbow reachability: reach[S] are the vertices where a walk from
+	// s ends whose edges and internal vertices use the colour set S, and
+	// through[S] those it can leave again, their own colour included in S.
+	// Repeating an internal vertex would repeat its colour, so the walks are
+	// paths up to returns to s, which can be cut out.
+	std::uint64_t total_layered_reach(const std::vector<std::uint64_t>& by_colour, const std::vector<std::uint64_t>& vertex_colour, index_t n, index_t q, index_t s, std::uint64_t targets)
+	{
+		std::vector<std::uint64_t> reach(1ULL << q, 0);
+		std::vector<std::uint64_t> through(1ULL << q, 0);
+		through[0] = (1ULL << s);
+
+		std::uint64_t all = (1ULL << s);
+
+		for (std::uint64_t set = 0; set < reach.size(); ++set)
+		{
+			all |= reach[set];
+
+			if ((all & targets) == targets)
+				break;
+
+			for (index_t c = 0; c < q; ++c)
+			{
+				if (set & (1ULL << c))
+					continue;
+
+				std::uint64_t to = 0;
+				for (std::uint64_t x = through[set]; x != 0; x &= x - 1)
+					to |= by_colour[c * n + ctz64(x)];
+
+				reach[set | (1ULL << c)] |= to;
+				through[set | (1ULL << c)] |= reach[set] & vertex_colour[c];
+			}
+		}
+
+		return all;
+	}
+
+	void total_rainbow_dfs(const std::vector<std::uint64_t>& by_colour, const std::vector<index_t>& colour_of, index_t n, index_t q, index_t v, std::uint64_t visited, std::vector<bool>& used, std::uint64_t targets, std::uint64_t& found)
+	{
+		found |= (1ULL << v);
+
+		for (index_t c = 0; c < q && (found & targets) != targets; ++c)
+		{
+			if (used[c])
+				continue;
+
+			used[c] = true;
+
+			for (std::uint64_t x = by_colour[c * n + v] & ~visited; x != 0; x &= x - 1)
+			{
+				const index_t w = ctz64(x);
+				found |= (1ULL << w);
+
+				// Go on through w only if its colour is still free.
+				if (!used[colour_of[w]])
+				{
+					used[colour_of[w]] = true;
+					total_rainbow_dfs(by_colour, colour_of, n, q, w, visited | (1ULL << w), used, targets, found);
+					used[colour_of[w]] = false;
+				}
+			}
+
+			used[c] = false;
+		}
+	}
+
+	// Pairs u < v are checked from u, with reach(u, targets) giving the
+	// vertices joined to u by a rainbow path. Sources are handed out to the
+	// threads one at a time.
+	template <typename Reach>
+	std::vector<std::pair<index_t, index_t>> collect_violations(const graph& g, index_t threads, Reach reach)
+	{
+		const index_t n = g.num_vertices();
+
+		// missed[u] are the v not reached.
+		std::vector<std::uint64_t> missed(n, 0);
+		std::atomic<index_t> next(0);
+
+		auto worker = [&]()
+		{
+			for (index_t u = next++; u < n; u = next++)
+			{
+				std::uint64_t targets = 0;
+				for (index_t v = u + 1; v < n; ++v)
+				{
+					if (!is_adjacent(g, u, v))
+						targets |= (1ULL << v);
+				}
+
+				if (targets != 0)
+					missed[u] = targets & ~reach(u, targets);
+			}
+		};
+
+		if (threads <= 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		threads = std::min(threads, n);
+
+		std::vector<std::thread> pool;
+		for (index_t i = 1; i < threads; ++i)
+			pool.emplace_back(worker);
+
+		worker();
+
+		for (auto& t : pool)
+			t.join();
+
+		std::vector<std::pair<index_t, index_t>> violations;
+		for (index_t u = 0; u < n; ++u)
+		{
+			for (std::uint64_t x = missed[u]; x != 0; x &= x - 1)
+				violations.emplace_back(u, ctz64(x));
+		}
+
+		return violations;
+	}
+}
+
+std::vector<std::vector<index_t>> read_minion_solutions(const graph& g, std::istream& is)
+{
+	const edge_index index(g);
+	const index_t n = g.num_vertices();
+
+	// Declaration order of the Minion variables.
+	std::vector<index_t> order;
+	for (index_t i = 0; i < n; ++i)
+	{
+		for (index_t j = i + 1; j < n; ++j)
+		{
+			if (is_adjacent(g, i, j))
+				order.emplace_back(index.id(i, j));
+		}
+	}
+
+	std::vector<std::vector<index_t>> solutions;
+	std::vector<index_t> values;
+	std::string line;
+
+	while (std::getline(is, line))
+	{
+		if (line.compare(0, 4, "Sol:") != 0)
+			continue;
+
+		std::istringstream ss(line.substr(4));
+		for (index_t c; ss >> c; )
+			values.emplace_back(c);
+
+		if (values.size() >= order.size())
+		{
+			if (values.size() > order.size())
+				throw std::runtime_error("Minion solution has more values than edges");
+
+			std::vector<index_t> colours(order.size());
+			for (std::size_t i = 0; i < order.size(); ++i)
+				colours[order[i]] = values[i];
+
+			solutions.emplace_back(colours);
+			values.clear();
+		}
+	}
+
+	if (!values.empty())
+		throw std::runtime_error("truncated Minion solution");
+
+	return solutions;
+}
+
+std::vector<std::vector<index_t>> read_minizinc_solutions(const graph& g, std::istream& is)
+{
+	const edge_index index(g);
+	const index_t n = g.num_vertices();
+
+	std::vector<std::vector<index_t>> solutions;
+	std::vector<index_t> colours(index.size(), 0);
+	bool any = false;
+	std::string line;
+
+	while (std::getline(is, line))
+	{
+		if (line.compare(0, 10, "----------") == 0)
+		{
+			check_complete(colours);
+			solutions.emplace_back(colours);
+			std::fill(colours.begin(), colours.end(), 0);
+			any = false;
+			continue;
+		}
+
+		for (std::size_t pos = line.find('x'); pos != std::string::npos; pos = line.find('x', pos))
+		{
+			index_t u, v;
+			++pos;
+
+			if (pos > 1 && (std::isalnum(static_cast<unsigned char>(line[pos - 2])) || line[pos - 2] == '_'))
+				continue;
+
+			if (!parse_edge_name(line, pos, u, v))
+				continue;
+
+			const std::size_t eq = line.find_first_not_of(" \t", pos);
+			if (eq == std::string::npos || line[eq] != '=')
+				continue;
+
+			const std::size_t value = line.find_first_not_of(" \t", eq + 1);
+			if (value == std::string::npos || !std::isdigit(static_cast<unsigned char>(line[value])))
+				continue;
+
+			if (u >= n || v >= n || index.id(u, v) == edge_index::NO_EDGE)
+				throw std::runtime_error("solution colours a non-edge x" + std::to_string(u) + "_" + std::to_string(v));
+
+			std::size_t end;
+			colours[index.id(u, v)] = std::stoll(line.substr(value), &end);
+			pos = value + end;
+			any = true;
+		}
+	}
+
+	// Some solvers omit the separator after the last solution.
+	if (any)
+	{
+		check_complete(colours);
+		solutions.emplace_back(colours);
+	}
+
+	return solutions;
+}
+
+std::vector<std::vector<index_t>> read_dimacs_solutions(const graph& g, index_t k, std::istream& is)
+{
+	const edge_index index(g);
+	const index_t m = index.size();
+
+	std::vector<std::vector<index_t>> solutions;
+	std::vector<index_t> colours(m, 0);
+	bool any = false;
+	std::string line;
+
+	while (std::getline(is, line))
+	{
+		if (line.compare(0, 2, "v ") != 0)
+			continue;
+
+		std::istringstream ss(line.substr(2));
+		for (index_t lit; ss >> lit; )
+		{
+			if (lit == 0)
+			{
+				check_complete(colours);
+				solutions.emplace_back(colours);
+				std::fill(colours.begin(), colours.end(), 0);
+				any = false;
+			}
+			else if (lit > 0 && lit <= m * k)
+			{
+				// Same numbering as cnf_model_writer::color_variable.
+				const index_t e = (lit - 1) / k;
+				const index_t c = (lit - 1) % k + 1;
+
+				if (colours[e] != 0)
+					throw std::runtime_error("edge " + std::to_string(e) + " has more than one colour");
+
+				colours[e] = c;
+				any = true;
+			}
+		}
+	}
+
+	if (any)
+		throw std::runtime_error("DIMACS model not terminated by 0");
+
+	return solutions;
+}
+
+std::vector<std::pair<index_t, index_t>> find_violations(const graph& g, const std::vector<index_t>& colours, bool strong, index_t threads)
+{
+	const edge_index index(g);
+	assert(static_cast<index_t>(colours.size()) == index.size());
+
+	std::vector<index_t> compact;
+	const index_t q = compact_colours(colours, compact);
+
+	return collect_violations(g, threads, [&](index_t u, std::uint64_t targets)
+	{
+		return rainbow_reach(g, index, compact, q, u, targets, strong);
+	});
+}
+
+std::vector<std::pair<index_t, index_t>> find_total_violations(const graph& g, const std::vector<index_t>& colours, index_t threads)
+{
+	const edge_index index(g);
+	const index_t n = g.num_vertices();
+	const index_t m = index.size();
+	assert(static_cast<index_t>(colours.size()) == m + n);
+
+	// Edges and vertices share the colours.
+	std::vector<index_t> compact;
+	const index_t q = compact_colours(colours, compact);
+
+	const std::vector<index_t> edge_colours(compact.cbegin(), compact.cbegin() + m);
+	const std::vector<index_t> colour_of(compact.cbegin() + m, compact.cend());
+	const auto by_colour = colour_adjacency(g, index, edge_colours, q, nullptr);
+
+	std::vector<std::uint64_t> vertex_colour(q, 0);
+	for (index_t v = 0; v < n; ++v)
+		vertex_colour[colour_of[v]] |= (1ULL << v);
+
+	return collect_violations(g, threads, [&](index_t u, std::uint64_t targets)
+	{
+		if (q <= MAX_LAYERED_COLOURS)
+			return total_layered_reach(by_colour, vertex_colour, n, q, u, targets);
+
+		std::uint64_t found = 0;
+		std::vector<bool> used(q, false);
+		total_rainbow_dfs(by_colour, colour_of, n, q, u, (1ULL << u), used, targets, found);
+		return found;
+	});
+}
+
+std::vector<std::pair<index_t, index_t>> find_hybrid_violations(const graph& g, const std::vector<index_t>& colours, index_t threads)
+{
+	const index_t m = g.num_edges();
+	assert(static_cast<index_t>(colours.size()) == m + g.num_vertices());
+
+	// Vertex colours moved past every edge colour make the palettes disjoint.
+	const index_t offset = (m == 0) ? 0 : *std::max_element(colours.cbegin(), colours.cbegin() + m);
+	std::vector<index_t> shifted(colours);
+
+	for (auto it = shifted.begin() + m; it != shifted.end(); ++it)
+		*it += offset;
+
+	return find_total_violations(g, shifted, threads);
+}
+
+void print_violations(const std::vector<std::pair<index_t, index_t>>& violations, std::ostream& os)
+{
+	if (violations.empty())
+	{
+		os << "Every pair is rainbow connected\n";
+		return;
+	}
+
+	os << violations.size() << " pair(s) not rainbow connected:";
+
+	for (const auto& p : violations)
+		os << " " << p.first << "-" << p.second;
+
+	os << "\n";
+}
@@ -0,0 +1,51 @@
+// verifier.hpp
+#ifndef VERIFIER_HPP
+#define VERIFIER_HPP
+
+#include "common.hpp"
+#include "graph.hpp"
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Solver output is read into one colour per edge, indexed by edge_index ids.
+// Every reader returns one colouring per solution found in the stream and
+// throws std::runtime_error on values it cannot place.
+
+// Minion "Sol:" lines; the variables are in the order the Minion writer
+// declares them.
+std::vector<std::vector<index_t>> read_minion_solutions(const graph& g, std::istream& is);
+
+// Assignments "x<u>_<v> = <c>;" as printed by MiniZinc and FlatZinc solvers;
+// solutions are separated by "----------".
+std::vector<std::vector<index_t>> read_minizinc_solutions(const graph& g, std::istream& is);
+
+// A DIMACS "v" line model of the cnf_model_writer encoding with k colours.
+std::vector<std::vector<index_t>> read_dimacs_solutions(const graph& g, index_t k, std::istream& is);
+
+// Non-adjacent pairs (u < v) joined by no rainbow path, or no rainbow geodesic
+// if strong is set, under the colouring. Reachability is computed per source
+// over (vertex, colour set) states, one 64-bit vertex set per colour set, so
+// a source costs O(2^q * q * n) word operations for q distinct colours and
+// answers every target at once. Sources are split over threads (0 means
+// one per hardware thread).
+std::vector<std::pair<index_t, index_t>> find_violations(const graph& g, const std::vector<index_t>& colours, bool strong = false, index_t threads = 0);
+
+inline bool is_rainbow_colouring(const graph& g, const std::vector<index_t>& colours, bool strong = false)
+{
+	return find_violations(g, colours, strong).empty();
+}
+
+// The same for total rainbow connection, with one colour per element id of
+// make_total_checker (edge ids, then m + v for vertex v): a rainbow path has
+// distinct colours on its edges and internal vertices together.
+std::vector<std::pair<index_t, index_t>> find_total_violations(const graph& g, const std::vector<index_t>& colours, index_t threads = 0);
+
+// The same for rainbow vertex-edge connection, with the same layout but edge
+// and vertex colours from separate palettes: a rainbow path has distinct
+// colours on its edges and distinct colours on its internal vertices.
+std::vector<std::pair<index_t, index_t>> find_hybrid_violations(const graph& g, const std::vector<index_t>& colours, index_t threads = 0);
+
+void print_violations(const std::vector<std::pair<index_t, index_t>>& violations, std::ostream& os = std::cout);
+
+#endif
@@ -1,6 +1,11 @@
 // vertex_model_writer.cpp
 #include "vertex_model_writer.hpp"
 #include "model_writer.hpp"
+#include "block_cut_tree.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
 
 namespace
 {
@@ -16,6 +21,52 @@ namespace
 			os << VAR_DECL << i << ";\n";
 		}
 	}
+
+	void add_vertex_alldiff(std::uint64_t vertices, std::ostream& os)
+	{
+		os << "alldifferent([";
+
+		for (std::uint64_t x = vertices; x != 0; x &= x - 1)
+		{
+			os << VAR_PREFIX << ctz64(x);
+
+			if ((x & (x - 1)) != 0)
+				os << ",";
+		}
+
+		os << "]) ";
+	}
+}
+
+std::vector<std::uint64_t> get_internal_vertex_sets(const graph& g, index_t s, index_t t, index_t k)
+{
+	std::vector<std::uint64_t> sets;
+
+	auto add = [&sets](const vertex_path& p) { sets.emplace_back(p.get_internal_vertices()); };
+	visit_paths<vertex_path>(g, s, t, add, k + 1);
+
+	// Smallest first, so that a set is only compared with its possible subsets.
+	std::sort(sets.begin(), sets.end(), [](std::uint64_t a, std::uint64_t b)
+	{
+		return std::make_pair(popcount64(a), a) < std::make_pair(popcount64(b), b);
+	});
+
+	sets.erase(std::unique(sets.begin(), sets.end()), sets.end());
+
+	std::vector<std::uint64_t> minimal;
+
+	for (auto x : sets)
+	{
+		const bool implied = std::any_of(minimal.cbegin(), minimal.cend(), [x](std::uint64_t y)
+		{
+			return (y & ~x) == 0;
+		});
+
+		if (!implied)
+			minimal.emplace_back(x);
+	}
+
+	return minimal;
 }
 
 void vertex_model_writer::impl_preprocess()
@@ -26,39 +77,52 @@ void vertex_model_writer::impl_preprocess()
 
 void vertex_model_writer::impl_process_vertex_pair(index_t u, index_t v)
 {
-	get_output_stream() << get_comment() << " Vertex pair " << u << " " << v << "\n";
-	std::vector<vertex_path> paths;
-	list_paths(get_graph(), u, v, paths, get_solution_size());
+	auto& os = get_output_stream();
+	const auto sets = get_internal_vertex_sets(get_graph(), u, v, get_solution_size());
+
+	os << get_comment() << " Vertex pair " << u << " " << v << "\n";
+
+	// No path has few enough internal vertices.
+	if (sets.empty())
+	{
+		os << "constraint false;\n";
+		return;
+	}
 
-	get_output_stream() << "constraint ( ";
+	os << "constraint ( ";
 
-	for (index_t j = 0; j < paths.size(); ++j)
+	for (index_t j = 0; j < sets.size(); ++j)
 	{
-		add_alldiff(paths[j], get_output_stream());
+		add_vertex_alldiff(sets[j], os);
 
-		if (j != paths.size() - 1)
-			get_output_stream() << "\\/ ";
+		if (j != sets.size() - 1)
+			os << "\\/ ";
 	}
 
-	get_output_stream() << ");\n";
+	os << ");\n";
 }
 
 void vertex_model_writer::impl_process()
 {
 	index_t u = 0;
 	index_t v = 1;
-	const index_t n = get_graph().num_vertices();
+	const graph& g = get_graph();
+	const index_t n = g.num_vertices();
 	const index_t pairs = nchoosek(n, 2);
 
-	get_output_stream() << get_comment() << " Paths between vertex pairs\n";
+	std::vector<std::vector<index_t>> dist(n);
+	for (index_t i = 0; i < n; ++i)
+	{
+		dist[i].assign(n, 0);
+		bfs(g, dist[i], i);
+	}
+
+	add_comment("Paths between vertex pairs");
 
 	for (index_t i = 0; i < pairs; ++i)
 	{
-		std::vector<index_t> dist(get_graph().num_vertices());
-		bfs(get_graph(), dist, u);
-
-		// Skip vertices that are at a distance 1 or 2.
-		if (dist[v] >= 3)
+		// Pairs at distance 1 or 2 have a path with at most one internal vertex.
+		if (dist[u][v] >= 3)
 		{
 			impl_process_vertex_pair(u, v);
 		}
@@ -69,7 +133,36 @@ void vertex_model_writer::impl_process()
 
 void vertex_model_writer::impl_postprocess()
 {
-	get_output_stream() << "solve satisfy;\n";
+	auto& os = get_output_stream();
+
+	// For any two cut vertices there is a pair whose paths all pass through
+	// both, so cut vertices must receive distinct colors.
+	const std::uint64_t cuts = get_block_cut_tree(get_graph()).cut_vertices;
+
+	if (popcount64(cuts) >= 2)
+	{
+		os << get_comment() << " Cut vertices\n";
+		os << "constraint ( ";
+		add_vertex_alldiff(cuts, os);
+		os << ");\n";
+	}
+
+	std::vector<std::string> names;
+
+	for (index_t v = 0; v < get_graph().num_vertices(); ++v)
+		names.emplace_back(VAR_PREFIX + std::to_string(v));
+
+	add_value_symmetry(names);
+
+	os << "solve satisfy;\n";
+}
+
+std::vector<index_t> vertex_model_writer::impl_find_pinned() const
+{
+	std::vector<index_t> cuts;
+
+	for (std::uint64_t x = get_block_cut_tree(get_graph()).cut_vertices; x != 0; x &= x - 1)
+		cuts.emplace_back(ctz64(x));
 
-	// TODO: cut vertices must receive a distinct color
+	return cuts;
 }
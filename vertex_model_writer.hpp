@@ -3,7 +3,12 @@
 #define VERTEX_MODEL_WRITER_HPP
 
 #include "model_writer.hpp"
+#include <cstdint>
+#include <vector>
 
+// Writes a MiniZinc model of vertex rainbow connection: vertices get colours
+// 1..k and every pair at distance 3 or more needs a path whose internal
+// vertices have distinct colours. Cut vertices are pairwise distinct.
 class vertex_model_writer : public model_writer
 {
 public:
@@ -19,6 +24,16 @@ private:
 	virtual void impl_postprocess();
 
 	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual index_t impl_num_elements() const { return get_graph().num_vertices(); }
+
+	// The cut vertices.
+	virtual std::vector<index_t> impl_find_pinned() const;
 };
 
+// The internal-vertex sets of the s-t paths with at most k internal vertices,
+// reduced to the minimal ones: only the set of a path matters for vertex
+// rainbow connection, and a set implies all of its supersets.
+std::vector<std::uint64_t> get_internal_vertex_sets(const graph& g, index_t s, index_t t, index_t k);
+
 #endif
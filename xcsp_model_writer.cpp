@@ -0,0 +1,217 @@
+// xcsp_model_writer.cpp
+#include "xcsp_model_writer.hpp"
+
+#include "edge_index.hpp"
+#include "graph.hpp"
+#include "path.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const std::string VAR_PREFIX = "x";
+	const std::string INDENT = "  ";
+
+	void add_variable(index_t u, index_t v, std::ostream& os)
+	{
+		os << VAR_PREFIX << u << "_" << v;
+	}
+
+	// Writes ne(a,b) for a single pair of edges, and(ne(..),ne(..),...) otherwise.
+	void add_rainbow_expression(const std::vector<index_t>& edges, std::ostream& os)
+	{
+		const index_t len = edges.size() / 2;
+		const bool conjunction = (len > 2);
+
+		if (conjunction)
+			os << "and(";
+
+		bool first = true;
+		for (index_t i = 0; i < len; ++i)
+		{
+			for (index_t j = i + 1; j < len; ++j)
+			{
+				if (!first)
+					os << ",";
+
+				os << "ne(";
+				add_variable(edges[2 * i], edges[2 * i + 1], os);
+				os << ",";
+				add_variable(edges[2 * j], edges[2 * j + 1], os);
+				os << ")";
+
+				first = false;
+			}
+		}
+
+		if (conjunction)
+			os << ")";
+	}
+}
+
+void xcsp_model_writer::write_vertex_pair(index_t u, index_t v, const std::vector<edge_path>& paths)
+{
+	auto& os = get_output_stream();
+
+	add_comment("Vertex pair " + std::to_string(u) + " " + std::to_string(v));
+
+	// No path fits: post a constant constraint that can never hold, which
+	// needs no variable and so also works on a graph without edges.
+	if (paths.empty())
+	{
+		os << INDENT << INDENT << "<intension> eq(0,1) </intension>\n";
+		return;
+	}
+
+	os << INDENT << INDENT << "<intension> ";
+
+	if (paths.size() > 1)
+		os << "or(";
+
+	for (index_t j = 0; j < paths.size(); ++j)
+	{
+		add_rainbow_expression(to_edge_list(paths[j]), os);
+
+		if (j != paths.size() - 1)
+			os << ",";
+	}
+
+	if (paths.size() > 1)
+		os << ")";
+
+	os << " </intension>\n";
+}
+
+void xcsp_model_writer::impl_preprocess()
+{
+	auto& os = get_output_stream();
+	const graph& g = get_graph();
+	const index_t n = g.num_vertices();
+
+	os << "<instance format=\"XCSP3\" type=\"CSP\">\n";
+	os << INDENT << "<variables>\n";
+
+	for (index_t i = 0; i < n; ++i)
+	{
+		index_t adj = g.adj_[i];
+		for (index_t j = i; j < n; ++j)
+		{
+			if (adj & (1ULL << j))
+			{
+				os << INDENT << INDENT << "<var id=\"";
+				add_variable(i, j, os);
+				os << "\"> 1.." << get_solution_size() << " </var>\n";
+			}
+		}
+	}
+
+	os << INDENT << "</variables>\n";
+	os << INDENT << "<constraints>\n";
+}
+
+void xcsp_model_writer::impl_postprocess()
+{
+	auto& os = get_output_stream();
+
+	// Bridges must get distinct colors; with forced facts they are among the
+	// cliques, which also stand in for the pairs left out.
+	const edge_index edges(get_graph());
+	std::vector<std::vector<index_t>> distinct;
+
+	if (get_forced_distinct() != nullptr)
+	{
+		add_comment("Forced distinct edges");
+		distinct = get_forced_distinct()->get_cliques();
+	}
+	else if (get_bridge_ids().size() >= 2)
+	{
+		// At least 2 bridges.
+		add_comment("Bridges");
+		distinct.emplace_back(get_bridge_ids());
+	}
+
+	for (const auto& ids : distinct)
+	{
+		os << INDENT << INDENT << "<allDifferent>";
+
+		for (auto e : ids)
+		{
+			os << " ";
+			add_variable(edges.endpoints(e).first, edges.endpoints(e).second, os);
+		}
+
+		os << " </allDifferent>\n";
+	}
+
+	if (get_value_symmetry() != value_symmetry::none && get_graph().num_edges() != 0)
+	{
+		index_t pinned = 0;
+		const auto order = get_value_order(pinned);
+
+		add_comment("Value symmetry");
+
+		if (pinned != 0)
+		{
+			os << INDENT << INDENT << "<instantiation>\n";
+			os << INDENT << INDENT << INDENT << "<list>";
+
+			for (index_t i = 0; i < pinned; ++i)
+			{
+				os << " ";
+				add_variable(edges.endpoints(order[i]).first, edges.endpoints(order[i]).second, os);
+			}
+
+			os << " </list>\n";
+			os << INDENT << INDENT << INDENT << "<values>";
+
+			for (index_t i = 0; i < pinned; ++i)
+				os << " " << i + 1;
+
+			os << " </values>\n";
+			os << INDENT << INDENT << "</instantiation>\n";
+		}
+
+		os << INDENT << INDENT << "<precedence>\n";
+		os << INDENT << INDENT << INDENT << "<list>";
+
+		for (auto e : order)
+		{
+			os << " ";
+			add_variable(edges.endpoints(e).first, edges.endpoints(e).second, os);
+		}
+
+		os << " </list>\n";
+		os << INDENT << INDENT << INDENT << "<values>";
+
+		for (index_t c = 1; c <= get_solution_size(); ++c)
+			os << " " << c;
+
+		os << " </values>\n";
+		os << INDENT << INDENT << "</precedence>\n";
+	}
+
+	os << INDENT << "</constraints>\n";
+	os << "</instance>\n";
+}
+
+void xcsp_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_paths(u, v, paths, get_solution_size());
+
+	write_vertex_pair(u, v, paths);
+}
+
+void xcsp_model_writer::impl_add_comment(const std::string& text)
+{
+	get_output_stream() << INDENT << INDENT << get_comment() << " " << text << " -->\n";
+}
+
+void strong_xcsp_model_writer::impl_process_vertex_pair(index_t u, index_t v)
+{
+	std::vector<edge_path> paths;
+	list_pair_shortest_paths(u, v, paths);
+
+	write_vertex_pair(u, v, paths);
+}
@@ -0,0 +1,50 @@
+// xcsp_model_writer.hpp
+#ifndef XCSP_MODEL_WRITER_HPP
+#define XCSP_MODEL_WRITER_HPP
+
+#include "model_writer.hpp"
+#include <vector>
+#include <string>
+
+// Writes the model as an XCSP3 instance. Each vertex pair becomes one
+// intension constraint: a disjunction over its paths of the pairwise
+// disequalities that make the path rainbow.
+class xcsp_model_writer : public model_writer
+{
+public:
+	xcsp_model_writer(const graph& g, index_t k, std::ostream& os)
+		: model_writer(g, k, os, "<!--")
+	{
+
+	}
+
+	virtual ~xcsp_model_writer() { }
+
+protected:
+	void write_vertex_pair(index_t u, index_t v, const std::vector<edge_path>& paths);
+
+private:
+	virtual void impl_preprocess();
+	virtual void impl_postprocess();
+
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual void impl_add_comment(const std::string& text);
+};
+
+class strong_xcsp_model_writer : public xcsp_model_writer
+{
+public:
+	strong_xcsp_model_writer(const graph& g, index_t k, std::ostream& os)
+		: xcsp_model_writer(g, k, os)
+	{
+
+	}
+
+private:
+	virtual void impl_process_vertex_pair(index_t u, index_t v);
+
+	virtual bool impl_shortest_paths() const { return true; }
+};
+
+#endif